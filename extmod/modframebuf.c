@@ -44,11 +44,13 @@ typedef struct _mp_obj_framebuf_t {
 typedef void (*setpixel_t)(const mp_obj_framebuf_t*, int, int, uint32_t);
 typedef uint32_t (*getpixel_t)(const mp_obj_framebuf_t*, int, int);
 typedef void (*fill_rect_t)(const mp_obj_framebuf_t *, int, int, int, int, uint32_t);
+typedef void (*draw_glyph_t)(const mp_obj_framebuf_t *, const uint8_t *, int, int, uint32_t);
 
 typedef struct _mp_framebuf_p_t {
     setpixel_t setpixel;
     getpixel_t getpixel;
     fill_rect_t fill_rect;
+    draw_glyph_t draw_glyph;
 } mp_framebuf_p_t;
 
 // constants for formats
@@ -62,63 +64,101 @@ typedef struct _mp_framebuf_p_t {
 
 // Functions for MHLSB and MHMSB
 
-STATIC void mono_horiz_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
+static inline MP_ALWAYSINLINE void mono_horiz_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
     size_t index = (x + y * fb->stride) >> 3;
     int offset = fb->format == FRAMEBUF_MHMSB ? x & 0x07 : 7 - (x & 0x07);
     ((uint8_t*)fb->buf)[index] = (((uint8_t*)fb->buf)[index] & ~(0x01 << offset)) | ((col != 0) << offset);
 }
 
-STATIC uint32_t mono_horiz_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
+static inline MP_ALWAYSINLINE uint32_t mono_horiz_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
     size_t index = (x + y * fb->stride) >> 3;
     int offset = fb->format == FRAMEBUF_MHMSB ? x & 0x07 : 7 - (x & 0x07);
     return (((uint8_t*)fb->buf)[index] >> (offset)) & 0x01;
 }
 
+// The bits of a byte that hold pixels p0 to p1 - 1 of it
+static inline uint8_t mono_horiz_mask(const mp_obj_framebuf_t *fb, int p0, int p1) {
+    if (fb->format == FRAMEBUF_MHMSB) {
+        return (0xff << p0) & (0xff >> (8 - p1));
+    } else {
+        return (0xff >> p0) & (0xff << (8 - p1));
+    }
+}
+
 STATIC void mono_horiz_fill_rect(const mp_obj_framebuf_t *fb, int x, int y, int w, int h, uint32_t col) {
-    int reverse = fb->format == FRAMEBUF_MHMSB;
+    // each row is a run of whole bytes between partial bytes at either end
     int advance = fb->stride >> 3;
-    while (w--) {
-        uint8_t *b = &((uint8_t*)fb->buf)[(x >> 3) + y * advance];
-        int offset = reverse ?  x & 7 : 7 - (x & 7);
-        for (int hh = h; hh; --hh) {
-            *b = (*b & ~(0x01 << offset)) | ((col != 0) << offset);
-            b += advance;
+    uint8_t fill = col ? 0xff : 0x00;
+    int p0 = x & 7;
+    int p1 = (x + w) & 7;
+    uint8_t head = mono_horiz_mask(fb, p0, 8);
+    uint8_t tail = mono_horiz_mask(fb, 0, p1);
+    int n_bytes = ((x + w) >> 3) - ((x + 7) >> 3);
+    bool has_head = p0 != 0;
+    if (p0 + w < 8) {
+        // within one byte
+        head &= tail;
+        tail = 0;
+        has_head = true;
+    }
+    uint8_t *b = &((uint8_t*)fb->buf)[(x >> 3) + y * advance];
+    while (h--) {
+        uint8_t *p = b;
+        if (has_head) {
+            *p = (*p & ~head) | (fill & head);
+            ++p;
         }
-        ++x;
+        if (n_bytes > 0) {
+            memset(p, fill, n_bytes);
+            p += n_bytes;
+        }
+        if (tail != 0) {
+            *p = (*p & ~tail) | (fill & tail);
+        }
+        b += advance;
     }
 }
 
 // Functions for MVLSB format
 
-STATIC void mvlsb_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
+static inline MP_ALWAYSINLINE void mvlsb_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
     size_t index = (y >> 3) * fb->stride + x;
     uint8_t offset = y & 0x07;
     ((uint8_t*)fb->buf)[index] = (((uint8_t*)fb->buf)[index] & ~(0x01 << offset)) | ((col != 0) << offset);
 }
 
-STATIC uint32_t mvlsb_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
+static inline MP_ALWAYSINLINE uint32_t mvlsb_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
     return (((uint8_t*)fb->buf)[(y >> 3) * fb->stride + x] >> (y & 0x07)) & 0x01;
 }
 
 STATIC void mvlsb_fill_rect(const mp_obj_framebuf_t *fb, int x, int y, int w, int h, uint32_t col) {
-    while (h--) {
+    // fill up to 8 rows at a time, a byte per column
+    uint8_t fill = col ? 0xff : 0x00;
+    int yend = y + h;
+    while (y < yend) {
+        int p0 = y & 0x07;
+        int p1 = MIN(8, p0 + yend - y);
+        uint8_t mask = (0xff << p0) & (0xff >> (8 - p1));
         uint8_t *b = &((uint8_t*)fb->buf)[(y >> 3) * fb->stride + x];
-        uint8_t offset = y & 0x07;
-        for (int ww = w; ww; --ww) {
-            *b = (*b & ~(0x01 << offset)) | ((col != 0) << offset);
-            ++b;
+        if (mask == 0xff) {
+            memset(b, fill, w);
+        } else {
+            for (int ww = w; ww; --ww) {
+                *b = (*b & ~mask) | (fill & mask);
+                ++b;
+            }
         }
-        ++y;
+        y += p1 - p0;
     }
 }
 
 // Functions for RGB565 format
 
-STATIC void rgb565_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
+static inline MP_ALWAYSINLINE void rgb565_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
     ((uint16_t*)fb->buf)[x + y * fb->stride] = col;
 }
 
-STATIC uint32_t rgb565_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
+static inline MP_ALWAYSINLINE uint32_t rgb565_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
     return ((uint16_t*)fb->buf)[x + y * fb->stride];
 }
 
@@ -134,7 +174,7 @@ STATIC void rgb565_fill_rect(const mp_obj_framebuf_t *fb, int x, int y, int w, i
 
 // Functions for GS2_HMSB format
 
-STATIC void gs2_hmsb_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
+static inline MP_ALWAYSINLINE void gs2_hmsb_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
     uint8_t *pixel = &((uint8_t*)fb->buf)[(x + y * fb->stride) >> 2];
     uint8_t shift = (x & 0x3) << 1;
     uint8_t mask = 0x3 << shift;
@@ -142,23 +182,47 @@ STATIC void gs2_hmsb_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_
     *pixel = color | (*pixel & (~mask));
 }
 
-STATIC uint32_t gs2_hmsb_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
+static inline MP_ALWAYSINLINE uint32_t gs2_hmsb_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
     uint8_t pixel = ((uint8_t*)fb->buf)[(x + y * fb->stride) >> 2];
     uint8_t shift = (x & 0x3) << 1;
     return (pixel >> shift) & 0x3;
 }
 
 STATIC void gs2_hmsb_fill_rect(const mp_obj_framebuf_t *fb, int x, int y, int w, int h, uint32_t col) {
-    for (int xx=x; xx < x+w; xx++) {
-        for (int yy=y; yy < y+h; yy++) {
-            gs2_hmsb_setpixel(fb, xx, yy, col);
+    // as for GS4_HMSB, with up to 3 pixels in the partial bytes
+    uint8_t fill = (col & 0x3) * 0x55;
+    int p0 = x & 0x3;
+    int p1 = (x + w) & 0x3;
+    uint8_t head = 0xff << (p0 << 1);
+    uint8_t tail = ~(0xff << (p1 << 1));
+    int n_bytes = ((x + w) >> 2) - ((x + 3) >> 2);
+    bool has_head = p0 != 0;
+    if (p0 + w < 4) {
+        head &= tail;
+        tail = 0;
+        has_head = true;
+    }
+    uint8_t *b = &((uint8_t*)fb->buf)[(x + y * fb->stride) >> 2];
+    while (h--) {
+        uint8_t *p = b;
+        if (has_head) {
+            *p = (*p & ~head) | (fill & head);
+            ++p;
+        }
+        if (n_bytes > 0) {
+            memset(p, fill, n_bytes);
+            p += n_bytes;
+        }
+        if (tail != 0) {
+            *p = (*p & ~tail) | (fill & tail);
         }
+        b += fb->stride >> 2;
     }
 }
 
 // Functions for GS4_HMSB format
 
-STATIC void gs4_hmsb_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
+static inline MP_ALWAYSINLINE void gs4_hmsb_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
     uint8_t *pixel = &((uint8_t*)fb->buf)[(x + y * fb->stride) >> 1];
 
     if (x % 2) {
@@ -168,7 +232,7 @@ STATIC void gs4_hmsb_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_
     }
 }
 
-STATIC uint32_t gs4_hmsb_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
+static inline MP_ALWAYSINLINE uint32_t gs4_hmsb_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
     if (x % 2) {
         return ((uint8_t*)fb->buf)[(x + y * fb->stride) >> 1] & 0x0f;
     }
@@ -209,12 +273,12 @@ STATIC void gs4_hmsb_fill_rect(const mp_obj_framebuf_t *fb, int x, int y, int w,
 
 // Functions for GS8 format
 
-STATIC void gs8_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
+static inline MP_ALWAYSINLINE void gs8_setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
     uint8_t *pixel = &((uint8_t*)fb->buf)[(x + y * fb->stride)];
     *pixel = col & 0xff;
 }
 
-STATIC uint32_t gs8_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
+static inline MP_ALWAYSINLINE uint32_t gs8_getpixel(const mp_obj_framebuf_t *fb, int x, int y) {
     return ((uint8_t*)fb->buf)[(x + y * fb->stride)];
 }
 
@@ -226,14 +290,66 @@ STATIC void gs8_fill_rect(const mp_obj_framebuf_t *fb, int x, int y, int w, int
     }
 }
 
+// Functions to draw a glyph of the 8x8 font, which has a byte for each
+// column of 8 pixels with the LSB at the top.  The glyph may be clipped.
+
+#define FRAMEBUF_GLYPH(name, setpixel_fn) \
+    STATIC void name(const mp_obj_framebuf_t *fb, const uint8_t *chr_data, int x0, int y0, uint32_t col) { \
+        for (int j = 0; j < 8; j++, x0++) { \
+            if (0 <= x0 && x0 < fb->width) { /* clip x */ \
+                uint vline_data = chr_data[j]; \
+                for (int y = y0; vline_data; vline_data >>= 1, y++) { /* scan over vertical column */ \
+                    if ((vline_data & 1) && 0 <= y && y < fb->height) { /* only draw if pixel set, clip y */ \
+                        setpixel_fn(fb, x0, y, col); \
+                    } \
+                } \
+            } \
+        } \
+    }
+
+FRAMEBUF_GLYPH(mono_horiz_draw_glyph, mono_horiz_setpixel)
+FRAMEBUF_GLYPH(rgb565_draw_glyph, rgb565_setpixel)
+FRAMEBUF_GLYPH(gs2_hmsb_draw_glyph, gs2_hmsb_setpixel)
+FRAMEBUF_GLYPH(gs4_hmsb_draw_glyph, gs4_hmsb_setpixel)
+FRAMEBUF_GLYPH(gs8_draw_glyph, gs8_setpixel)
+
+// In MVLSB a column of the glyph covers at most two bytes.
+STATIC void mvlsb_draw_glyph(const mp_obj_framebuf_t *fb, const uint8_t *chr_data, int x0, int y0, uint32_t col) {
+    for (int page = y0 >> 3; page <= (y0 + 7) >> 3; ++page) {
+        int top = page << 3;
+        if (top < 0 || top >= fb->height) {
+            continue;
+        }
+        // the bits of this page's bytes that the glyph covers and that are
+        // inside the framebuffer
+        int shift = y0 - top;
+        uint8_t mask = shift >= 0 ? 0xff << shift : 0xff >> -shift;
+        if (top + 8 > fb->height) {
+            mask &= 0xff >> (top + 8 - fb->height);
+        }
+        uint8_t *b = &((uint8_t*)fb->buf)[page * fb->stride];
+        for (int j = 0; j < 8; ++j) {
+            int x = x0 + j;
+            if (0 <= x && x < fb->width) {
+                uint8_t bits = (shift >= 0 ? chr_data[j] << shift : chr_data[j] >> -shift) & mask;
+                if (col) {
+                    b[x] |= bits;
+                } else {
+                    b[x] &= ~bits;
+                }
+            }
+        }
+    }
+}
+
 STATIC mp_framebuf_p_t formats[] = {
-    [FRAMEBUF_MVLSB] = {mvlsb_setpixel, mvlsb_getpixel, mvlsb_fill_rect},
-    [FRAMEBUF_RGB565] = {rgb565_setpixel, rgb565_getpixel, rgb565_fill_rect},
-    [FRAMEBUF_GS2_HMSB] = {gs2_hmsb_setpixel, gs2_hmsb_getpixel, gs2_hmsb_fill_rect},
-    [FRAMEBUF_GS4_HMSB] = {gs4_hmsb_setpixel, gs4_hmsb_getpixel, gs4_hmsb_fill_rect},
-    [FRAMEBUF_GS8] = {gs8_setpixel, gs8_getpixel, gs8_fill_rect},
-    [FRAMEBUF_MHLSB] = {mono_horiz_setpixel, mono_horiz_getpixel, mono_horiz_fill_rect},
-    [FRAMEBUF_MHMSB] = {mono_horiz_setpixel, mono_horiz_getpixel, mono_horiz_fill_rect},
+    [FRAMEBUF_MVLSB] = {mvlsb_setpixel, mvlsb_getpixel, mvlsb_fill_rect, mvlsb_draw_glyph},
+    [FRAMEBUF_RGB565] = {rgb565_setpixel, rgb565_getpixel, rgb565_fill_rect, rgb565_draw_glyph},
+    [FRAMEBUF_GS2_HMSB] = {gs2_hmsb_setpixel, gs2_hmsb_getpixel, gs2_hmsb_fill_rect, gs2_hmsb_draw_glyph},
+    [FRAMEBUF_GS4_HMSB] = {gs4_hmsb_setpixel, gs4_hmsb_getpixel, gs4_hmsb_fill_rect, gs4_hmsb_draw_glyph},
+    [FRAMEBUF_GS8] = {gs8_setpixel, gs8_getpixel, gs8_fill_rect, gs8_draw_glyph},
+    [FRAMEBUF_MHLSB] = {mono_horiz_setpixel, mono_horiz_getpixel, mono_horiz_fill_rect, mono_horiz_draw_glyph},
+    [FRAMEBUF_MHMSB] = {mono_horiz_setpixel, mono_horiz_getpixel, mono_horiz_fill_rect, mono_horiz_draw_glyph},
 };
 
 static inline void setpixel(const mp_obj_framebuf_t *fb, int x, int y, uint32_t col) {
@@ -259,6 +375,261 @@ STATIC void fill_rect(const mp_obj_framebuf_t *fb, int x, int y, int w, int h, u
     formats[fb->format].fill_rect(fb, x, y, xend - x, yend - y, col);
 }
 
+// Blitting.  A blit between two formats is done by a kernel for that pair,
+// made by one of the macros below with the pixel functions of both formats
+// inlined into its loop.  Pairs without a kernel of their own go through
+// the per-format function pointers.
+
+typedef struct _blit_args_t {
+    const mp_obj_framebuf_t *src;
+    const mp_obj_framebuf_t *palette; // NULL for none
+    uint32_t key; // colour not to draw
+    int x0, y0; // top left in the destination
+    int x1, y1; // top left in the source
+    int w, h;
+} blit_args_t;
+
+typedef void (*blit_t)(const mp_obj_framebuf_t *fb, const blit_args_t *a);
+
+// The palette is a framebuffer of height 1 with the colour to draw for each
+// value of the source in turn.  Values past its end are drawn unchanged.
+static inline uint32_t palette_lookup(const mp_obj_framebuf_t *palette, uint32_t col) {
+    if (palette != NULL && col < palette->width) {
+        col = formats[palette->format].getpixel(palette, col, 0);
+    }
+    return col;
+}
+
+// Sources with up to 4 bits per pixel have the colour and transparency of
+// each value worked out once per blit.
+typedef struct _blit_lut_t {
+    uint32_t col[16];
+    uint16_t opaque; // bit n is set if value n is drawn
+} blit_lut_t;
+
+STATIC void blit_make_lut(blit_lut_t *lut, const blit_args_t *a, int n_values) {
+    lut->opaque = 0;
+    for (int v = 0; v < n_values; ++v) {
+        lut->col[v] = palette_lookup(a->palette, v);
+        if (lut->col[v] != a->key) {
+            lut->opaque |= 1 << v;
+        }
+    }
+}
+
+// The order to visit the pixels of a blit in: rows from j stepping by dj,
+// and within them pixels from i stepping by di.  A blit within the same
+// buffer goes from the bottom if it moves down, or from the right if it moves
+// right along the same rows, so that it reads each pixel before writing it.
+typedef struct _blit_order_t {
+    int i, di;
+    int j, dj;
+} blit_order_t;
+
+STATIC void blit_get_order(blit_order_t *o, const mp_obj_framebuf_t *fb, const blit_args_t *a) {
+    bool same = fb->buf == a->src->buf;
+    bool rev_y = same && a->y0 > a->y1;
+    bool rev_x = same && a->y0 == a->y1 && a->x0 > a->x1;
+    o->i = rev_x ? a->w - 1 : 0;
+    o->di = rev_x ? -1 : 1;
+    o->j = rev_y ? a->h - 1 : 0;
+    o->dj = rev_y ? -1 : 1;
+}
+
+#define FRAMEBUF_BLIT_LUT(name, n_values, getpixel_fn, setpixel_fn) \
+    STATIC void name(const mp_obj_framebuf_t *fb, const blit_args_t *a) { \
+        blit_lut_t lut; \
+        blit_make_lut(&lut, a, n_values); \
+        blit_order_t o; \
+        blit_get_order(&o, fb, a); \
+        for (int n = 0, j = o.j; n < a->h; ++n, j += o.dj) { \
+            int y0 = a->y0 + j; \
+            int y1 = a->y1 + j; \
+            for (int m = 0, i = o.i; m < a->w; ++m, i += o.di) { \
+                uint32_t v = getpixel_fn(a->src, a->x1 + i, y1); \
+                if (lut.opaque & (1 << v)) { \
+                    setpixel_fn(fb, a->x0 + i, y0, lut.col[v]); \
+                } \
+            } \
+        } \
+    }
+
+#define FRAMEBUF_BLIT_KEY(name, getpixel_fn, setpixel_fn) \
+    STATIC void name(const mp_obj_framebuf_t *fb, const blit_args_t *a) { \
+        blit_order_t o; \
+        blit_get_order(&o, fb, a); \
+        for (int n = 0, j = o.j; n < a->h; ++n, j += o.dj) { \
+            int y0 = a->y0 + j; \
+            int y1 = a->y1 + j; \
+            for (int m = 0, i = o.i; m < a->w; ++m, i += o.di) { \
+                uint32_t col = palette_lookup(a->palette, getpixel_fn(a->src, a->x1 + i, y1)); \
+                if (col != a->key) { \
+                    setpixel_fn(fb, a->x0 + i, y0, col); \
+                } \
+            } \
+        } \
+    }
+
+// text, icons and images drawn on colour displays
+FRAMEBUF_BLIT_LUT(blit_mono_horiz_rgb565, 2, mono_horiz_getpixel, rgb565_setpixel)
+FRAMEBUF_BLIT_LUT(blit_mvlsb_rgb565, 2, mvlsb_getpixel, rgb565_setpixel)
+FRAMEBUF_BLIT_LUT(blit_gs2_hmsb_rgb565, 4, gs2_hmsb_getpixel, rgb565_setpixel)
+FRAMEBUF_BLIT_LUT(blit_gs4_hmsb_rgb565, 16, gs4_hmsb_getpixel, rgb565_setpixel)
+FRAMEBUF_BLIT_KEY(blit_gs8_rgb565, gs8_getpixel, rgb565_setpixel)
+FRAMEBUF_BLIT_KEY(blit_rgb565_rgb565, rgb565_getpixel, rgb565_setpixel)
+
+// the same format with a key or a palette
+FRAMEBUF_BLIT_LUT(blit_mono_horiz_mono_horiz, 2, mono_horiz_getpixel, mono_horiz_setpixel)
+FRAMEBUF_BLIT_LUT(blit_mvlsb_mvlsb, 2, mvlsb_getpixel, mvlsb_setpixel)
+FRAMEBUF_BLIT_LUT(blit_gs2_hmsb_gs2_hmsb, 4, gs2_hmsb_getpixel, gs2_hmsb_setpixel)
+FRAMEBUF_BLIT_LUT(blit_gs4_hmsb_gs4_hmsb, 16, gs4_hmsb_getpixel, gs4_hmsb_setpixel)
+FRAMEBUF_BLIT_KEY(blit_gs8_gs8, gs8_getpixel, gs8_setpixel)
+
+// any other pair
+FRAMEBUF_BLIT_KEY(blit_generic, getpixel, setpixel)
+
+STATIC blit_t blit_kernel(int dst_format, int src_format) {
+    #define FORMAT_PAIR(dst, src) ((dst) << 4 | (src))
+    switch (FORMAT_PAIR(dst_format, src_format)) {
+        case FORMAT_PAIR(FRAMEBUF_RGB565, FRAMEBUF_MHLSB):
+        case FORMAT_PAIR(FRAMEBUF_RGB565, FRAMEBUF_MHMSB):
+            return blit_mono_horiz_rgb565;
+        case FORMAT_PAIR(FRAMEBUF_RGB565, FRAMEBUF_MVLSB):
+            return blit_mvlsb_rgb565;
+        case FORMAT_PAIR(FRAMEBUF_RGB565, FRAMEBUF_GS2_HMSB):
+            return blit_gs2_hmsb_rgb565;
+        case FORMAT_PAIR(FRAMEBUF_RGB565, FRAMEBUF_GS4_HMSB):
+            return blit_gs4_hmsb_rgb565;
+        case FORMAT_PAIR(FRAMEBUF_RGB565, FRAMEBUF_GS8):
+            return blit_gs8_rgb565;
+        case FORMAT_PAIR(FRAMEBUF_RGB565, FRAMEBUF_RGB565):
+            return blit_rgb565_rgb565;
+        case FORMAT_PAIR(FRAMEBUF_MHLSB, FRAMEBUF_MHLSB):
+        case FORMAT_PAIR(FRAMEBUF_MHLSB, FRAMEBUF_MHMSB):
+        case FORMAT_PAIR(FRAMEBUF_MHMSB, FRAMEBUF_MHLSB):
+        case FORMAT_PAIR(FRAMEBUF_MHMSB, FRAMEBUF_MHMSB):
+            return blit_mono_horiz_mono_horiz;
+        case FORMAT_PAIR(FRAMEBUF_MVLSB, FRAMEBUF_MVLSB):
+            return blit_mvlsb_mvlsb;
+        case FORMAT_PAIR(FRAMEBUF_GS2_HMSB, FRAMEBUF_GS2_HMSB):
+            return blit_gs2_hmsb_gs2_hmsb;
+        case FORMAT_PAIR(FRAMEBUF_GS4_HMSB, FRAMEBUF_GS4_HMSB):
+            return blit_gs4_hmsb_gs4_hmsb;
+        case FORMAT_PAIR(FRAMEBUF_GS8, FRAMEBUF_GS8):
+            return blit_gs8_gs8;
+        default:
+            return blit_generic;
+    }
+    #undef FORMAT_PAIR
+}
+
+// Copy pixels between framebuffers of the same format, a row of bytes at a
+// time where the pixels line up with the bytes.  The source and destination
+// may overlap, as they do for scroll().
+STATIC void copy_rect(const mp_obj_framebuf_t *fb, const blit_args_t *a) {
+    const mp_obj_framebuf_t *src = a->src;
+    uint8_t *dst_buf = fb->buf;
+    const uint8_t *src_buf = src->buf;
+
+    // Bytes per pixel, or log2 of the pixels per byte for the formats whose
+    // bytes run along the rows.
+    int pix_shift = 0;
+    int bytes_per_pixel = 1;
+    switch (fb->format) {
+        case FRAMEBUF_RGB565: bytes_per_pixel = 2; break;
+        case FRAMEBUF_GS8: break;
+        case FRAMEBUF_GS4_HMSB: pix_shift = 1; break;
+        case FRAMEBUF_GS2_HMSB: pix_shift = 2; break;
+        case FRAMEBUF_MHLSB: case FRAMEBUF_MHMSB: pix_shift = 3; break;
+        default: pix_shift = -1; break; // MVLSB
+    }
+    int pix_mask = pix_shift > 0 ? (1 << pix_shift) - 1 : 0;
+
+    if (fb->format == FRAMEBUF_MVLSB && (a->y0 & 7) == (a->y1 & 7)) {
+        // Rows of MVLSB bytes, copying the bits of partial rows at the top
+        // and bottom.  Go from the bottom if the source is below.
+        bool up = dst_buf + a->y0 / 8 * fb->stride > src_buf + a->y1 / 8 * src->stride;
+        int yend = a->y0 + a->h;
+        int y = up ? yend - 1 : a->y0;
+        while (up ? y >= a->y0 : y < yend) {
+            int p0 = up ? MAX(y & ~7, a->y0) - (y & ~7) : y & 7;
+            int p1 = up ? (y & 7) + 1 : MIN(8, p0 + yend - y);
+            uint8_t mask = (0xff << p0) & (0xff >> (8 - p1));
+            int sy = y - a->y0 + a->y1;
+            uint8_t *d = &dst_buf[(y >> 3) * fb->stride + a->x0];
+            const uint8_t *s = &src_buf[(sy >> 3) * src->stride + a->x1];
+            if (mask == 0xff) {
+                memmove(d, s, a->w);
+            } else if (d > s) {
+                for (int i = a->w - 1; i >= 0; --i) {
+                    d[i] = (d[i] & ~mask) | (s[i] & mask);
+                }
+            } else {
+                for (int i = 0; i < a->w; ++i) {
+                    d[i] = (d[i] & ~mask) | (s[i] & mask);
+                }
+            }
+            y = up ? (y & ~7) - 1 : (y | 7) + 1;
+        }
+        return;
+    }
+
+    if (pix_shift >= 0 && (a->x0 & pix_mask) == (a->x1 & pix_mask)) {
+        // Rows of bytes, with the pixels in partial bytes at each end done
+        // separately.  Those are read before the bytes are moved in case
+        // the rows overlap.  Go from the bottom if the source is below.
+        int head = MIN(a->w, (-a->x0) & pix_mask);
+        int n_bytes = ((a->w - head) >> pix_shift) * bytes_per_pixel;
+        int tail = (a->w - head) & pix_mask;
+        int xtail = a->w - tail;
+        bool up = dst_buf + ((a->x0 + a->y0 * fb->stride) >> pix_shift) * bytes_per_pixel
+            > src_buf + ((a->x1 + a->y1 * src->stride) >> pix_shift) * bytes_per_pixel;
+        uint32_t head_col[8], tail_col[8];
+        for (int j = 0; j < a->h; ++j) {
+            int y0 = up ? a->y0 + a->h - 1 - j : a->y0 + j;
+            int y1 = y0 - a->y0 + a->y1;
+            for (int i = 0; i < head; ++i) {
+                head_col[i] = getpixel(src, a->x1 + i, y1);
+            }
+            for (int i = 0; i < tail; ++i) {
+                tail_col[i] = getpixel(src, a->x1 + xtail + i, y1);
+            }
+            memmove(&dst_buf[((a->x0 + head + y0 * fb->stride) >> pix_shift) * bytes_per_pixel],
+                &src_buf[((a->x1 + head + y1 * src->stride) >> pix_shift) * bytes_per_pixel],
+                n_bytes);
+            for (int i = 0; i < head; ++i) {
+                setpixel(fb, a->x0 + i, y0, head_col[i]);
+            }
+            for (int i = 0; i < tail; ++i) {
+                setpixel(fb, a->x0 + xtail + i, y0, tail_col[i]);
+            }
+        }
+        return;
+    }
+
+    // Pixels that don't line up with the bytes are copied one at a time,
+    // in the order that reads each one before it is overwritten.
+    int dx = 1;
+    int dy = 1;
+    int i0 = 0;
+    int j0 = 0;
+    if (fb->buf == src->buf) {
+        if (a->x0 > a->x1) {
+            dx = -1;
+            i0 = a->w - 1;
+        }
+        if (a->y0 > a->y1) {
+            dy = -1;
+            j0 = a->h - 1;
+        }
+    }
+    for (int j = j0; 0 <= j && j < a->h; j += dy) {
+        for (int i = i0; 0 <= i && i < a->w; i += dx) {
+            setpixel(fb, a->x0 + i, a->y0 + j, getpixel(src, a->x1 + i, a->y1 + j));
+        }
+    }
+}
+
 STATIC mp_obj_t framebuf_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     mp_arg_check_num(n_args, n_kw, 4, 5, false);
 
@@ -411,6 +782,11 @@ STATIC mp_obj_t framebuf_line(size_t n_args, const mp_obj_t *args) {
     mp_int_t y2 = mp_obj_get_int(args[4]);
     mp_int_t col = mp_obj_get_int(args[5]);
 
+    if (x1 == x2 || y1 == y2) {
+        fill_rect(self, MIN(x1, x2), MIN(y1, y2), MAX(x1, x2) - MIN(x1, x2) + 1, MAX(y1, y2) - MIN(y1, y2) + 1, col);
+        return mp_const_none;
+    }
+
     mp_int_t dx = x2 - x1;
     mp_int_t sx;
     if (dx > 0) {
@@ -467,15 +843,33 @@ STATIC mp_obj_t framebuf_line(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(framebuf_line_obj, 6, 6, framebuf_line);
 
+STATIC const mp_obj_type_t mp_type_framebuf;
+
+// Get the FrameBuffer behind an argument, which may be an instance of a
+// Python subclass.
+STATIC mp_obj_framebuf_t *framebuf_get_arg(mp_obj_t arg) {
+    if (!MP_OBJ_IS_TYPE(arg, &mp_type_framebuf)) {
+        arg = mp_instance_cast_to_native_base(arg, MP_OBJ_FROM_PTR(&mp_type_framebuf));
+        if (arg == MP_OBJ_NULL || !MP_OBJ_IS_TYPE(arg, &mp_type_framebuf)) {
+            mp_raise_TypeError(translate("expected a FrameBuffer"));
+        }
+    }
+    return MP_OBJ_TO_PTR(arg);
+}
+
 STATIC mp_obj_t framebuf_blit(size_t n_args, const mp_obj_t *args) {
     mp_obj_framebuf_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_obj_framebuf_t *source = MP_OBJ_TO_PTR(args[1]);
+    mp_obj_framebuf_t *source = framebuf_get_arg(args[1]);
     mp_int_t x = mp_obj_get_int(args[2]);
     mp_int_t y = mp_obj_get_int(args[3]);
     mp_int_t key = -1;
     if (n_args > 4) {
         key = mp_obj_get_int(args[4]);
     }
+    mp_obj_framebuf_t *palette = NULL;
+    if (n_args > 5 && args[5] != mp_const_none) {
+        palette = framebuf_get_arg(args[5]);
+    }
 
     if (
         (x >= self->width) ||
@@ -495,49 +889,33 @@ STATIC mp_obj_t framebuf_blit(size_t n_args, const mp_obj_t *args) {
     int x0end = MIN(self->width, x + source->width);
     int y0end = MIN(self->height, y + source->height);
 
-    for (; y0 < y0end; ++y0) {
-        int cx1 = x1;
-        for (int cx0 = x0; cx0 < x0end; ++cx0) {
-            uint32_t col = getpixel(source, cx1, y1);
-            if (col != (uint32_t)key) {
-                setpixel(self, cx0, y0, col);
-            }
-            ++cx1;
-        }
-        ++y1;
+    blit_args_t a = {
+        .src = source, .palette = palette, .key = key,
+        .x0 = x0, .y0 = y0, .x1 = x1, .y1 = y1, .w = x0end - x0, .h = y0end - y0,
+    };
+    if (key == -1 && palette == NULL && self->format == source->format) {
+        copy_rect(self, &a);
+    } else {
+        blit_kernel(self->format, source->format)(self, &a);
     }
     return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(framebuf_blit_obj, 4, 5, framebuf_blit);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(framebuf_blit_obj, 4, 6, framebuf_blit);
 
 STATIC mp_obj_t framebuf_scroll(mp_obj_t self_in, mp_obj_t xstep_in, mp_obj_t ystep_in) {
     mp_obj_framebuf_t *self = MP_OBJ_TO_PTR(self_in);
     mp_int_t xstep = mp_obj_get_int(xstep_in);
     mp_int_t ystep = mp_obj_get_int(ystep_in);
-    int sx, y, xend, yend, dx, dy;
-    if (xstep < 0) {
-        sx = 0;
-        xend = self->width + xstep;
-        dx = 1;
-    } else {
-        sx = self->width - 1;
-        xend = xstep - 1;
-        dx = -1;
-    }
-    if (ystep < 0) {
-        y = 0;
-        yend = self->height + ystep;
-        dy = 1;
-    } else {
-        y = self->height - 1;
-        yend = ystep - 1;
-        dy = -1;
-    }
-    for (; y != yend; y += dy) {
-        for (int x = sx; x != xend; x += dx) {
-            setpixel(self, x, y, getpixel(self, x - xstep, y - ystep));
-        }
+    if (xstep <= -self->width || xstep >= self->width || ystep <= -self->height || ystep >= self->height) {
+        // nothing is left in view
+        return mp_const_none;
     }
+    blit_args_t a = {
+        .src = self, .palette = NULL, .key = -1,
+        .x0 = MAX(xstep, 0), .y0 = MAX(ystep, 0), .x1 = MAX(-xstep, 0), .y1 = MAX(-ystep, 0),
+        .w = self->width - MAX(xstep, -xstep), .h = self->height - MAX(ystep, -ystep),
+    };
+    copy_rect(self, &a);
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_3(framebuf_scroll_obj, framebuf_scroll);
@@ -560,21 +938,11 @@ STATIC mp_obj_t framebuf_text(size_t n_args, const mp_obj_t *args) {
         if (chr < 32 || chr > 127) {
             chr = 127;
         }
-        // get char data
-        const uint8_t *chr_data = &font_petme128_8x8[(chr - 32) * 8];
-        // loop over char data
-        for (int j = 0; j < 8; j++, x0++) {
-            if (0 <= x0 && x0 < self->width) { // clip x
-                uint vline_data = chr_data[j]; // each byte is a column of 8 pixels, LSB at top
-                for (int y = y0; vline_data; vline_data >>= 1, y++) { // scan over vertical column
-                    if (vline_data & 1) { // only draw if pixel set
-                        if (0 <= y && y < self->height) { // clip y
-                            setpixel(self, x0, y, col);
-                        }
-                    }
-                }
-            }
+        // draw char if any of it is in view
+        if (x0 > -8 && x0 < self->width && y0 > -8 && y0 < self->height) {
+            formats[self->format].draw_glyph(self, &font_petme128_8x8[(chr - 32) * 8], x0, y0, col);
         }
+        x0 += 8;
     }
     return mp_const_none;
 }
@@ -0,0 +1,547 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013, 2014 Damien P. George
+ * Copyright (c) 2014 Paul Sokolovsky
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+
+#include "py/runtime.h"
+#include "py/binary.h"
+
+#include "supervisor/shared/translate.h"
+
+#if MICROPY_PY_UARRAYOPS
+
+// Element-wise operations and reductions over buffers of numbers, such as
+// array.array, memoryview and bytearray, which work directly on their
+// storage without boxing each element.  Integer results saturate at the
+// limits of the typecode.  The destination of an element-wise operation may
+// be one of its sources, to work in place.
+
+// The integer typecodes of up to 32 bits, with their C type, limits and a
+// type that can hold the product of two elements.
+#if ULONG_MAX == 0xffffffff
+#define ARRAYOPS_LONG_TYPES(X) \
+    X('l', int32_t, INT32_MIN, INT32_MAX, int64_t) \
+    X('L', uint32_t, 0, UINT32_MAX, uint64_t)
+#else
+#define ARRAYOPS_LONG_TYPES(X)
+#endif
+#define ARRAYOPS_INT_TYPES(X) \
+    X('b', int8_t, INT8_MIN, INT8_MAX, int64_t) \
+    X('B', uint8_t, 0, UINT8_MAX, uint64_t) \
+    X('h', int16_t, INT16_MIN, INT16_MAX, int64_t) \
+    X('H', uint16_t, 0, UINT16_MAX, uint64_t) \
+    X('i', int32_t, INT32_MIN, INT32_MAX, int64_t) \
+    X('I', uint32_t, 0, UINT32_MAX, uint64_t) \
+    ARRAYOPS_LONG_TYPES(X)
+
+#if MICROPY_PY_BUILTINS_FLOAT
+#define ARRAYOPS_FLOAT_TYPES(X) \
+    X('f', float) \
+    X('d', double)
+#else
+#define ARRAYOPS_FLOAT_TYPES(X)
+#endif
+
+#define ARRAYOPS_CLAMP(x, lo, hi) ((x) <= (lo) ? (lo) : (x) >= (hi) ? (hi) : (x))
+
+// Integer scale factors that aren't whole numbers are applied in fixed
+// point, with this many fractional bits.
+#define ARRAYOPS_FRAC_BITS (16)
+
+typedef struct _arrayops_buf_t {
+    void *buf;
+    size_t len; // number of elements
+    char typecode;
+} arrayops_buf_t;
+
+STATIC bool arrayops_is_float(char typecode) {
+    return typecode == 'f' || typecode == 'd';
+}
+
+STATIC void arrayops_get_buf(mp_obj_t obj, arrayops_buf_t *b, mp_uint_t flags) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(obj, &bufinfo, flags);
+    char typecode = bufinfo.typecode == BYTEARRAY_TYPECODE ? 'B' : bufinfo.typecode;
+    switch (typecode) {
+        #define ARRAYOPS_CASE(tc, ...) case tc:
+        ARRAYOPS_INT_TYPES(ARRAYOPS_CASE)
+        ARRAYOPS_FLOAT_TYPES(ARRAYOPS_CASE)
+        #undef ARRAYOPS_CASE
+            break;
+        default:
+            mp_raise_TypeError(translate("unsupported typecode"));
+    }
+    b->buf = bufinfo.buf;
+    b->len = bufinfo.len / mp_binary_get_size('@', typecode, NULL);
+    b->typecode = typecode;
+}
+
+STATIC void arrayops_check_same(const arrayops_buf_t *a, const arrayops_buf_t *b) {
+    if (a->typecode != b->typecode || a->len != b->len) {
+        mp_raise_ValueError(translate("buffers must have the same typecode and length"));
+    }
+}
+
+STATIC bool arrayops_is_scalar(mp_obj_t obj) {
+    return mp_obj_is_integer(obj) || mp_obj_is_float(obj);
+}
+
+/******************************************************************************/
+// Element-wise kernels
+
+// dest = a * ka + b * kb + c, where b may be absent.  Integers are computed
+// as (a * ka + b * kb + c) >> shift, with the rounding included in c.
+typedef struct _arrayops_linear_t {
+    int64_t ka, kb, c;
+    unsigned int shift;
+    #if MICROPY_PY_BUILTINS_FLOAT
+    mp_float_t fa, fb, fc;
+    #endif
+} arrayops_linear_t;
+
+STATIC void arrayops_linear(const arrayops_buf_t *dest, const arrayops_buf_t *a, const arrayops_buf_t *b, const arrayops_linear_t *k) {
+    size_t n = dest->len;
+    switch (dest->typecode) {
+        #define ARRAYOPS_LINEAR_INT(tc, T, lo, hi, W) \
+        case tc: { \
+            T *d = dest->buf; \
+            const T *x = a->buf; \
+            if (b == NULL) { \
+                for (size_t i = 0; i < n; i++) { \
+                    int64_t v = (x[i] * k->ka + k->c) >> k->shift; \
+                    d[i] = ARRAYOPS_CLAMP(v, lo, hi); \
+                } \
+            } else { \
+                const T *y = b->buf; \
+                for (size_t i = 0; i < n; i++) { \
+                    int64_t v = (x[i] * k->ka + y[i] * k->kb + k->c) >> k->shift; \
+                    d[i] = ARRAYOPS_CLAMP(v, lo, hi); \
+                } \
+            } \
+            break; \
+        }
+        ARRAYOPS_INT_TYPES(ARRAYOPS_LINEAR_INT)
+        #undef ARRAYOPS_LINEAR_INT
+        #define ARRAYOPS_LINEAR_FLOAT(tc, T) \
+        case tc: { \
+            T *d = dest->buf; \
+            const T *x = a->buf; \
+            T fa = (T)k->fa, fb = (T)k->fb, fc = (T)k->fc; \
+            if (b == NULL) { \
+                for (size_t i = 0; i < n; i++) { \
+                    d[i] = x[i] * fa + fc; \
+                } \
+            } else { \
+                const T *y = b->buf; \
+                for (size_t i = 0; i < n; i++) { \
+                    d[i] = x[i] * fa + y[i] * fb + fc; \
+                } \
+            } \
+            break; \
+        }
+        ARRAYOPS_FLOAT_TYPES(ARRAYOPS_LINEAR_FLOAT)
+        #undef ARRAYOPS_LINEAR_FLOAT
+    }
+}
+
+// Set up k to compute a * factor + offset.
+STATIC void arrayops_linear_scale(arrayops_linear_t *k, char typecode, mp_obj_t factor, mp_obj_t offset) {
+    k->kb = 0;
+    if (arrayops_is_float(typecode)) {
+        #if MICROPY_PY_BUILTINS_FLOAT
+        k->fa = mp_obj_get_float(factor);
+        k->fb = 0;
+        k->fc = mp_obj_get_float(offset);
+        #endif
+        return;
+    }
+    #if MICROPY_PY_BUILTINS_FLOAT
+    if (mp_obj_is_float(factor) || mp_obj_is_float(offset)) {
+        mp_float_t f = mp_obj_get_float(factor);
+        mp_float_t o = mp_obj_get_float(offset);
+        const mp_float_t one = (mp_float_t)(1 << ARRAYOPS_FRAC_BITS);
+        // keep a * ka within 63 bits for 32-bit elements
+        if (!(f > -32768 && f < 32768) || !(o > -(mp_float_t)INT32_MAX && o < (mp_float_t)INT32_MAX)) {
+            mp_raise_ValueError(translate("scale out of range"));
+        }
+        k->ka = (int64_t)MICROPY_FLOAT_C_FUN(nearbyint)(f * one);
+        k->c = (int64_t)MICROPY_FLOAT_C_FUN(nearbyint)(o * one) + (1 << (ARRAYOPS_FRAC_BITS - 1));
+        k->shift = ARRAYOPS_FRAC_BITS;
+        return;
+    }
+    #endif
+    mp_int_t f = mp_obj_get_int(factor);
+    mp_int_t o = mp_obj_get_int(offset);
+    if (f < -INT32_MAX || f > INT32_MAX || o < -INT32_MAX || o > INT32_MAX) {
+        mp_raise_ValueError(translate("scale out of range"));
+    }
+    k->ka = f;
+    k->c = o;
+    k->shift = 0;
+}
+
+// dest = a * b, element-wise
+STATIC void arrayops_mul_kernel(const arrayops_buf_t *dest, const arrayops_buf_t *a, const arrayops_buf_t *b) {
+    size_t n = dest->len;
+    switch (dest->typecode) {
+        #define ARRAYOPS_MUL_INT(tc, T, lo, hi, W) \
+        case tc: { \
+            T *d = dest->buf; \
+            const T *x = a->buf, *y = b->buf; \
+            for (size_t i = 0; i < n; i++) { \
+                W v = (W)x[i] * (W)y[i]; \
+                d[i] = ARRAYOPS_CLAMP(v, (W)lo, (W)hi); \
+            } \
+            break; \
+        }
+        ARRAYOPS_INT_TYPES(ARRAYOPS_MUL_INT)
+        #undef ARRAYOPS_MUL_INT
+        #define ARRAYOPS_MUL_FLOAT(tc, T) \
+        case tc: { \
+            T *d = dest->buf; \
+            const T *x = a->buf, *y = b->buf; \
+            for (size_t i = 0; i < n; i++) { \
+                d[i] = x[i] * y[i]; \
+            } \
+            break; \
+        }
+        ARRAYOPS_FLOAT_TYPES(ARRAYOPS_MUL_FLOAT)
+        #undef ARRAYOPS_MUL_FLOAT
+    }
+}
+
+// Parse dest and a, and b if it's a buffer rather than a number.
+STATIC bool arrayops_get_args(mp_obj_t dest_in, mp_obj_t a_in, mp_obj_t b_in,
+    arrayops_buf_t *dest, arrayops_buf_t *a, arrayops_buf_t *b) {
+    arrayops_get_buf(dest_in, dest, MP_BUFFER_WRITE);
+    arrayops_get_buf(a_in, a, MP_BUFFER_READ);
+    arrayops_check_same(dest, a);
+    if (b_in == MP_OBJ_NULL || arrayops_is_scalar(b_in)) {
+        return false;
+    }
+    arrayops_get_buf(b_in, b, MP_BUFFER_READ);
+    arrayops_check_same(dest, b);
+    return true;
+}
+
+STATIC mp_obj_t arrayops_add_sub(mp_obj_t dest_in, mp_obj_t a_in, mp_obj_t b_in, int sign) {
+    arrayops_buf_t dest, a, b;
+    arrayops_linear_t k;
+    if (arrayops_get_args(dest_in, a_in, b_in, &dest, &a, &b)) {
+        k.ka = 1;
+        k.kb = sign;
+        k.c = 0;
+        k.shift = 0;
+        #if MICROPY_PY_BUILTINS_FLOAT
+        k.fa = 1;
+        k.fb = sign;
+        k.fc = 0;
+        #endif
+        arrayops_linear(&dest, &a, &b, &k);
+    } else {
+        if (sign < 0) {
+            b_in = mp_unary_op(MP_UNARY_OP_NEGATIVE, b_in);
+        }
+        arrayops_linear_scale(&k, dest.typecode, MP_OBJ_NEW_SMALL_INT(1), b_in);
+        arrayops_linear(&dest, &a, NULL, &k);
+    }
+    return mp_const_none;
+}
+
+STATIC mp_obj_t arrayops_add(mp_obj_t dest_in, mp_obj_t a_in, mp_obj_t b_in) {
+    return arrayops_add_sub(dest_in, a_in, b_in, 1);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(arrayops_add_obj, arrayops_add);
+
+STATIC mp_obj_t arrayops_sub(mp_obj_t dest_in, mp_obj_t a_in, mp_obj_t b_in) {
+    return arrayops_add_sub(dest_in, a_in, b_in, -1);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(arrayops_sub_obj, arrayops_sub);
+
+STATIC mp_obj_t arrayops_mul(mp_obj_t dest_in, mp_obj_t a_in, mp_obj_t b_in) {
+    arrayops_buf_t dest, a, b;
+    if (arrayops_get_args(dest_in, a_in, b_in, &dest, &a, &b)) {
+        arrayops_mul_kernel(&dest, &a, &b);
+    } else {
+        arrayops_linear_t k;
+        arrayops_linear_scale(&k, dest.typecode, b_in, MP_OBJ_NEW_SMALL_INT(0));
+        arrayops_linear(&dest, &a, NULL, &k);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(arrayops_mul_obj, arrayops_mul);
+
+STATIC mp_obj_t arrayops_scale(size_t n_args, const mp_obj_t *args) {
+    arrayops_buf_t dest, a;
+    arrayops_get_args(args[0], args[1], MP_OBJ_NULL, &dest, &a, NULL);
+    arrayops_linear_t k;
+    arrayops_linear_scale(&k, dest.typecode, args[2], n_args > 3 ? args[3] : MP_OBJ_NEW_SMALL_INT(0));
+    arrayops_linear(&dest, &a, NULL, &k);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(arrayops_scale_obj, 3, 4, arrayops_scale);
+
+// Get an int argument limited to the range [lo, hi] of an integer typecode.
+// That range may not fit an mp_int_t (for 'I' on 32-bit targets), so big
+// ints are compared as objects.
+STATIC long long arrayops_get_int_clamped(mp_obj_t arg, long long lo, long long hi) {
+    if (!MP_OBJ_IS_TYPE(arg, &mp_type_int)) {
+        long long v = mp_obj_get_int(arg);
+        return ARRAYOPS_CLAMP(v, lo, hi);
+    }
+    if (mp_obj_is_true(mp_binary_op(MP_BINARY_OP_LESS_EQUAL, arg, mp_obj_new_int_from_ll(lo)))) {
+        return lo;
+    }
+    if (mp_obj_is_true(mp_binary_op(MP_BINARY_OP_MORE_EQUAL, arg, mp_obj_new_int_from_ll(hi)))) {
+        return hi;
+    }
+    // in range, so the value fits a machine word, unsigned if lo is 0
+    mp_int_t v = mp_obj_get_int_truncated(arg);
+    return lo == 0 ? (long long)(mp_uint_t)v : (long long)v;
+}
+
+STATIC mp_obj_t arrayops_clip(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    arrayops_buf_t dest, a;
+    arrayops_get_args(args[0], args[1], MP_OBJ_NULL, &dest, &a, NULL);
+    size_t n = dest.len;
+    if (arrayops_is_float(dest.typecode)) {
+        #if MICROPY_PY_BUILTINS_FLOAT
+        mp_float_t lo = mp_obj_get_float(args[2]);
+        mp_float_t hi = mp_obj_get_float(args[3]);
+        switch (dest.typecode) {
+            #define ARRAYOPS_CLIP_FLOAT(tc, T) \
+            case tc: { \
+                T *d = dest.buf; \
+                const T *x = a.buf; \
+                for (size_t i = 0; i < n; i++) { \
+                    d[i] = x[i] < (T)lo ? (T)lo : x[i] > (T)hi ? (T)hi : x[i]; \
+                } \
+                break; \
+            }
+            ARRAYOPS_FLOAT_TYPES(ARRAYOPS_CLIP_FLOAT)
+            #undef ARRAYOPS_CLIP_FLOAT
+        }
+        #endif
+    } else {
+        switch (dest.typecode) {
+            #define ARRAYOPS_CLIP_INT(tc, T, tlo, thi, W) \
+            case tc: { \
+                T *d = dest.buf; \
+                const T *x = a.buf; \
+                T l = arrayops_get_int_clamped(args[2], tlo, thi); \
+                T h = arrayops_get_int_clamped(args[3], tlo, thi); \
+                for (size_t i = 0; i < n; i++) { \
+                    d[i] = x[i] < l ? l : x[i] > h ? h : x[i]; \
+                } \
+                break; \
+            }
+            ARRAYOPS_INT_TYPES(ARRAYOPS_CLIP_INT)
+            #undef ARRAYOPS_CLIP_INT
+        }
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(arrayops_clip_obj, 4, 4, arrayops_clip);
+
+/******************************************************************************/
+// Reductions
+
+// Integer sums are accumulated in 128 bits, as a signed high word and an
+// unsigned low word.  Sums of 2**31 elements of up to 16 bits, or their
+// products, can't overflow 64 bits, so those are summed in 64-bit chunks.
+#define ARRAYOPS_SUM_CHUNK ((size_t)1 << 31)
+
+static inline void arrayops_sum_add(int64_t *hi, uint64_t *lo, int64_t v) {
+    *lo += (uint64_t)v;
+    *hi += (v < 0 ? -1 : 0) + (*lo < (uint64_t)v);
+}
+
+STATIC mp_obj_t arrayops_new_int_128(int64_t hi, uint64_t lo) {
+    if (hi == 0) {
+        return mp_obj_new_int_from_ull(lo);
+    }
+    if (hi == -1 && lo >= (uint64_t)1 << 63) {
+        return mp_obj_new_int_from_ll((int64_t)lo);
+    }
+    mp_obj_t h = mp_binary_op(MP_BINARY_OP_LSHIFT, mp_obj_new_int_from_ll(hi), MP_OBJ_NEW_SMALL_INT(64));
+    return mp_binary_op(MP_BINARY_OP_ADD, h, mp_obj_new_int_from_ull(lo));
+}
+
+// The sum of a, or of the products of a and b if b isn't NULL, as an int or
+// a float depending on the typecode.
+STATIC mp_obj_t arrayops_sum_helper(const arrayops_buf_t *a, const arrayops_buf_t *b) {
+    size_t n = a->len;
+    switch (a->typecode) {
+        #define ARRAYOPS_SUM_INT(tc, T, tlo, thi, W) \
+        case tc: { \
+            const T *x = a->buf; \
+            const T *y = b == NULL ? NULL : b->buf; \
+            int64_t hi = 0; \
+            uint64_t lo = 0; \
+            if (y == NULL || sizeof(T) < 4) { \
+                for (size_t i = 0; i < n;) { \
+                    size_t end = n - i > ARRAYOPS_SUM_CHUNK ? i + ARRAYOPS_SUM_CHUNK : n; \
+                    int64_t part = 0; \
+                    if (y == NULL) { \
+                        for (; i < end; i++) { \
+                            part += x[i]; \
+                        } \
+                    } else { \
+                        for (; i < end; i++) { \
+                            part += (int64_t)x[i] * y[i]; \
+                        } \
+                    } \
+                    arrayops_sum_add(&hi, &lo, part); \
+                } \
+            } else if (tlo == 0) { \
+                for (size_t i = 0; i < n; i++) { \
+                    uint64_t p = (uint64_t)x[i] * (uint64_t)y[i]; \
+                    lo += p; \
+                    hi += lo < p; \
+                } \
+            } else { \
+                for (size_t i = 0; i < n; i++) { \
+                    arrayops_sum_add(&hi, &lo, (int64_t)x[i] * (int64_t)y[i]); \
+                } \
+            } \
+            return arrayops_new_int_128(hi, lo); \
+        }
+        ARRAYOPS_INT_TYPES(ARRAYOPS_SUM_INT)
+        #undef ARRAYOPS_SUM_INT
+        #define ARRAYOPS_SUM_FLOAT(tc, T) \
+        case tc: { \
+            const T *x = a->buf; \
+            T s = 0; \
+            if (b == NULL) { \
+                for (size_t i = 0; i < n; i++) { \
+                    s += x[i]; \
+                } \
+            } else { \
+                const T *y = b->buf; \
+                for (size_t i = 0; i < n; i++) { \
+                    s += x[i] * y[i]; \
+                } \
+            } \
+            return mp_obj_new_float((mp_float_t)s); \
+        }
+        ARRAYOPS_FLOAT_TYPES(ARRAYOPS_SUM_FLOAT)
+        #undef ARRAYOPS_SUM_FLOAT
+    }
+    return mp_const_none;
+}
+
+STATIC mp_obj_t arrayops_sum(mp_obj_t a_in) {
+    arrayops_buf_t a;
+    arrayops_get_buf(a_in, &a, MP_BUFFER_READ);
+    return arrayops_sum_helper(&a, NULL);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(arrayops_sum_obj, arrayops_sum);
+
+STATIC mp_obj_t arrayops_mean(mp_obj_t a_in) {
+    arrayops_buf_t a;
+    arrayops_get_buf(a_in, &a, MP_BUFFER_READ);
+    if (a.len == 0) {
+        mp_raise_ValueError(translate("arg is an empty sequence"));
+    }
+    mp_obj_t sum = arrayops_sum_helper(&a, NULL);
+    #if MICROPY_PY_BUILTINS_FLOAT
+    return mp_binary_op(MP_BINARY_OP_TRUE_DIVIDE, sum, mp_obj_new_int_from_uint(a.len));
+    #else
+    return mp_binary_op(MP_BINARY_OP_FLOOR_DIVIDE, sum, mp_obj_new_int_from_uint(a.len));
+    #endif
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(arrayops_mean_obj, arrayops_mean);
+
+STATIC mp_obj_t arrayops_dot(mp_obj_t a_in, mp_obj_t b_in) {
+    arrayops_buf_t a, b;
+    arrayops_get_buf(a_in, &a, MP_BUFFER_READ);
+    arrayops_get_buf(b_in, &b, MP_BUFFER_READ);
+    arrayops_check_same(&a, &b);
+    return arrayops_sum_helper(&a, &b);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(arrayops_dot_obj, arrayops_dot);
+
+STATIC mp_obj_t arrayops_min_max(mp_obj_t a_in, bool is_max) {
+    arrayops_buf_t a;
+    arrayops_get_buf(a_in, &a, MP_BUFFER_READ);
+    if (a.len == 0) {
+        mp_raise_ValueError(translate("arg is an empty sequence"));
+    }
+    size_t best = 0;
+    switch (a.typecode) {
+        #define ARRAYOPS_MIN_MAX(tc, T, ...) \
+        case tc: { \
+            const T *x = a.buf; \
+            for (size_t i = 1; i < a.len; i++) { \
+                if (is_max ? x[i] > x[best] : x[i] < x[best]) { \
+                    best = i; \
+                } \
+            } \
+            break; \
+        }
+        ARRAYOPS_INT_TYPES(ARRAYOPS_MIN_MAX)
+        ARRAYOPS_FLOAT_TYPES(ARRAYOPS_MIN_MAX)
+        #undef ARRAYOPS_MIN_MAX
+    }
+    return mp_binary_get_val_array(a.typecode, a.buf, best);
+}
+
+STATIC mp_obj_t arrayops_min(mp_obj_t a_in) {
+    return arrayops_min_max(a_in, false);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(arrayops_min_obj, arrayops_min);
+
+STATIC mp_obj_t arrayops_max(mp_obj_t a_in) {
+    return arrayops_min_max(a_in, true);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(arrayops_max_obj, arrayops_max);
+
+STATIC const mp_rom_map_elem_t mp_module_uarrayops_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uarrayops) },
+    { MP_ROM_QSTR(MP_QSTR_add), MP_ROM_PTR(&arrayops_add_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sub), MP_ROM_PTR(&arrayops_sub_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mul), MP_ROM_PTR(&arrayops_mul_obj) },
+    { MP_ROM_QSTR(MP_QSTR_scale), MP_ROM_PTR(&arrayops_scale_obj) },
+    { MP_ROM_QSTR(MP_QSTR_clip), MP_ROM_PTR(&arrayops_clip_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sum), MP_ROM_PTR(&arrayops_sum_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mean), MP_ROM_PTR(&arrayops_mean_obj) },
+    { MP_ROM_QSTR(MP_QSTR_dot), MP_ROM_PTR(&arrayops_dot_obj) },
+    { MP_ROM_QSTR(MP_QSTR_min), MP_ROM_PTR(&arrayops_min_obj) },
+    { MP_ROM_QSTR(MP_QSTR_max), MP_ROM_PTR(&arrayops_max_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_uarrayops_globals, mp_module_uarrayops_globals_table);
+
+const mp_obj_module_t mp_module_uarrayops = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&mp_module_uarrayops_globals,
+};
+
+#endif // MICROPY_PY_UARRAYOPS
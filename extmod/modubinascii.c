@@ -40,6 +40,42 @@ static void check_not_unicode(const mp_obj_t arg) {
 #endif
 }
 
+static const char hex_digits[16] = "0123456789abcdef";
+
+static const char base64_alphabet[64] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Value of each ASCII hex digit, 0xff for any other ASCII char.
+static const byte hex_value[128] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+// Sextet value of each ASCII char of the base64 alphabet, 0xff for any other
+// ASCII char (including the pad char).
+static const byte base64_value[128] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+// Look up ch in one of the 128-entry tables above; any non-ASCII char maps to
+// a value with the top bit set, same as an invalid ASCII char.
+static inline byte ascii_lookup(const byte *table, byte ch) {
+    return table[ch & 0x7f] | (ch & 0x80);
+}
+
 mp_obj_t mod_binascii_hexlify(size_t n_args, const mp_obj_t *args) {
     // Second argument is for an extension to allow a separator to be used
     // between values.
@@ -63,18 +99,25 @@ mp_obj_t mod_binascii_hexlify(size_t n_args, const mp_obj_t *args) {
     }
     vstr_init_len(&vstr, out_len);
     byte *in = bufinfo.buf, *out = (byte*)vstr.buf;
-    for (mp_uint_t i = bufinfo.len; i--;) {
-        byte d = (*in >> 4);
-        if (d > 9) {
-            d += 'a' - '9' - 1;
+    size_t len = bufinfo.len;
+    if (sep == NULL) {
+        // Without a separator do 4 input bytes per iteration, with no branches
+        // in the loop body.
+        for (; len >= 4; len -= 4, in += 4, out += 8) {
+            out[0] = hex_digits[in[0] >> 4];
+            out[1] = hex_digits[in[0] & 0xf];
+            out[2] = hex_digits[in[1] >> 4];
+            out[3] = hex_digits[in[1] & 0xf];
+            out[4] = hex_digits[in[2] >> 4];
+            out[5] = hex_digits[in[2] & 0xf];
+            out[6] = hex_digits[in[3] >> 4];
+            out[7] = hex_digits[in[3] & 0xf];
         }
-        *out++ = d + '0';
-        d = (*in++ & 0xf);
-        if (d > 9) {
-            d += 'a' - '9' - 1;
-        }
-        *out++ = d + '0';
-        if (sep != NULL && i != 0) {
+    }
+    while (len--) {
+        *out++ = hex_digits[*in >> 4];
+        *out++ = hex_digits[*in++ & 0xf];
+        if (sep != NULL && len != 0) {
             *out++ = *sep;
         }
     }
@@ -92,44 +135,22 @@ mp_obj_t mod_binascii_unhexlify(mp_obj_t data) {
     vstr_t vstr;
     vstr_init_len(&vstr, bufinfo.len / 2);
     byte *in = bufinfo.buf, *out = (byte*)vstr.buf;
-    byte hex_byte = 0;
-    for (mp_uint_t i = bufinfo.len; i--;) {
-        byte hex_ch = *in++;
-        if (unichar_isxdigit(hex_ch)) {
-            hex_byte += unichar_xdigit_value(hex_ch);
-        } else {
-            mp_raise_ValueError(translate("non-hex digit found"));
-        }
-        if (i & 1) {
-            hex_byte <<= 4;
-        } else {
-            *out++ = hex_byte;
-            hex_byte = 0;
-        }
+    // Invalid digits have the top bit set in their table value; accumulate
+    // those bits and check them once at the end instead of per char.
+    byte bad = 0;
+    for (size_t i = bufinfo.len / 2; i--; in += 2) {
+        byte hi = ascii_lookup(hex_value, in[0]);
+        byte lo = ascii_lookup(hex_value, in[1]);
+        bad |= hi | lo;
+        *out++ = hi << 4 | lo;
+    }
+    if (bad & 0x80) {
+        mp_raise_ValueError(translate("non-hex digit found"));
     }
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_unhexlify_obj, mod_binascii_unhexlify);
 
-// If ch is a character in the base64 alphabet, and is not a pad character, then
-// the corresponding integer between 0 and 63, inclusively, is returned.
-// Otherwise, -1 is returned.
-static int mod_binascii_sextet(byte ch) {
-    if (ch >= 'A' && ch <= 'Z') {
-        return ch - 'A';
-    } else if (ch >= 'a' && ch <= 'z') {
-        return ch - 'a' + 26;
-    } else if (ch >= '0' && ch <= '9') {
-        return ch - '0' + 52;
-    } else if (ch == '+') {
-        return 62;
-    } else if (ch == '/') {
-        return 63;
-    } else {
-        return -1;
-    }
-}
-
 mp_obj_t mod_binascii_a2b_base64(mp_obj_t data) {
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
@@ -139,10 +160,29 @@ mp_obj_t mod_binascii_a2b_base64(mp_obj_t data) {
     vstr_init(&vstr, (bufinfo.len / 4) * 3 + 1); // Potentially over-allocate
     byte *out = (byte *)vstr.buf;
 
+    // Fast path: decode whole groups of 4 alphabet chars straight to 3 bytes.
+    // The first group containing a pad or a char to be ignored ends it and the
+    // rest of the input goes through the general loop below.
+    size_t i = 0;
+    for (; i + 4 <= bufinfo.len; i += 4) {
+        byte a = ascii_lookup(base64_value, in[i]);
+        byte b = ascii_lookup(base64_value, in[i + 1]);
+        byte c = ascii_lookup(base64_value, in[i + 2]);
+        byte d = ascii_lookup(base64_value, in[i + 3]);
+        if ((a | b | c | d) & 0x80) {
+            break;
+        }
+        uint32_t group = (uint32_t)a << 18 | (uint32_t)b << 12 | c << 6 | d;
+        out[vstr.len] = group >> 16;
+        out[vstr.len + 1] = group >> 8;
+        out[vstr.len + 2] = group;
+        vstr.len += 3;
+    }
+
     uint shift = 0;
     int nbits = 0; // Number of meaningful bits in shift
     bool hadpad = false; // Had a pad character since last valid character
-    for (size_t i = 0; i < bufinfo.len; i++) {
+    for (; i < bufinfo.len; i++) {
         if (in[i] == '=') {
             if ((nbits == 2) || ((nbits == 4) && hadpad)) {
                 nbits = 0;
@@ -151,8 +191,8 @@ mp_obj_t mod_binascii_a2b_base64(mp_obj_t data) {
             hadpad = true;
         }
 
-        int sextet = mod_binascii_sextet(in[i]);
-        if (sextet == -1) {
+        byte sextet = ascii_lookup(base64_value, in[i]);
+        if (sextet & 0x80) {
             continue;
         }
         hadpad = false;
@@ -173,59 +213,60 @@ mp_obj_t mod_binascii_a2b_base64(mp_obj_t data) {
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_a2b_base64_obj, mod_binascii_a2b_base64);
 
+// Length of the base64 encoding of n bytes, including padding.
+#define BASE64_ENCODED_LEN(n) (((n) + 2) / 3 * 4)
+
+// Encode len bytes from in as padded base64 into out, which must have room
+// for BASE64_ENCODED_LEN(len) bytes.  Each 3-byte group is gathered into one
+// word and split into 4 sextets.
+static void base64_encode(const byte *in, size_t len, byte *out) {
+    for (; len >= 3; len -= 3, in += 3, out += 4) {
+        uint32_t group = (uint32_t)in[0] << 16 | in[1] << 8 | in[2];
+        out[0] = base64_alphabet[group >> 18];
+        out[1] = base64_alphabet[(group >> 12) & 0x3f];
+        out[2] = base64_alphabet[(group >> 6) & 0x3f];
+        out[3] = base64_alphabet[group & 0x3f];
+    }
+    if (len != 0) {
+        uint32_t group = (uint32_t)in[0] << 16;
+        if (len == 2) {
+            group |= in[1] << 8;
+        }
+        out[0] = base64_alphabet[group >> 18];
+        out[1] = base64_alphabet[(group >> 12) & 0x3f];
+        out[2] = (len == 2) ? base64_alphabet[(group >> 6) & 0x3f] : '=';
+        out[3] = '=';
+    }
+}
+
 mp_obj_t mod_binascii_b2a_base64(mp_obj_t data) {
     check_not_unicode(data);
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
 
     vstr_t vstr;
-    vstr_init_len(&vstr, ((bufinfo.len != 0) ? (((bufinfo.len - 1) / 3) + 1) * 4 : 0) + 1);
+    vstr_init_len(&vstr, BASE64_ENCODED_LEN(bufinfo.len) + 1);
+    base64_encode(bufinfo.buf, bufinfo.len, (byte*)vstr.buf);
+    vstr.buf[vstr.len - 1] = '\n';
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_b2a_base64_obj, mod_binascii_b2a_base64);
 
-    // First pass, we convert input buffer to numeric base 64 values
-    byte *in = bufinfo.buf, *out = (byte*)vstr.buf;
-    mp_uint_t i;
-    for (i = bufinfo.len; i >= 3; i -= 3) {
-        *out++ = (in[0] & 0xFC) >> 2;
-        *out++ = (in[0] & 0x03) << 4 | (in[1] & 0xF0) >> 4;
-        *out++ = (in[1] & 0x0F) << 2 | (in[2] & 0xC0) >> 6;
-        *out++ = in[2] & 0x3F;
-        in += 3;
-    }
-    if (i != 0) {
-        *out++ = (in[0] & 0xFC) >> 2;
-        if (i == 2) {
-            *out++ = (in[0] & 0x03) << 4 | (in[1] & 0xF0) >> 4;
-            *out++ = (in[1] & 0x0F) << 2;
-        }
-        else {
-            *out++ = (in[0] & 0x03) << 4;
-            *out++ = 64;
-        }
-        *out = 64;
-    }
+mp_obj_t mod_binascii_b2a_base64_into(mp_obj_t dest, mp_obj_t data) {
+    check_not_unicode(data);
+    mp_buffer_info_t destinfo;
+    mp_get_buffer_raise(dest, &destinfo, MP_BUFFER_WRITE);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
 
-    // Second pass, we convert number base 64 values to actual base64 ascii encoding
-    out = (byte*)vstr.buf;
-    for (mp_uint_t j = vstr.len - 1; j--;) {
-        if (*out < 26) {
-            *out += 'A';
-        } else if (*out < 52) {
-            *out += 'a' - 26;
-        } else if (*out < 62) {
-            *out += '0' - 52;
-        } else if (*out == 62) {
-            *out ='+';
-        } else if (*out == 63) {
-            *out = '/';
-        } else {
-            *out = '=';
-        }
-        out++;
+    size_t out_len = BASE64_ENCODED_LEN(bufinfo.len);
+    if (destinfo.len < out_len) {
+        mp_raise_ValueError(translate("buffer too small"));
     }
-    *out = '\n';
-    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+    base64_encode(bufinfo.buf, bufinfo.len, destinfo.buf);
+    return MP_OBJ_NEW_SMALL_INT(out_len);
 }
-MP_DEFINE_CONST_FUN_OBJ_1(mod_binascii_b2a_base64_obj, mod_binascii_b2a_base64);
+MP_DEFINE_CONST_FUN_OBJ_2(mod_binascii_b2a_base64_into_obj, mod_binascii_b2a_base64_into);
 
 #if MICROPY_PY_UBINASCII_CRC32
 #include "../../lib/uzlib/src/tinf.h"
@@ -249,6 +290,7 @@ STATIC const mp_rom_map_elem_t mp_module_binascii_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_unhexlify), MP_ROM_PTR(&mod_binascii_unhexlify_obj) },
     { MP_ROM_QSTR(MP_QSTR_a2b_base64), MP_ROM_PTR(&mod_binascii_a2b_base64_obj) },
     { MP_ROM_QSTR(MP_QSTR_b2a_base64), MP_ROM_PTR(&mod_binascii_b2a_base64_obj) },
+    { MP_ROM_QSTR(MP_QSTR_b2a_base64_into), MP_ROM_PTR(&mod_binascii_b2a_base64_into_obj) },
     #if MICROPY_PY_UBINASCII_CRC32
     { MP_ROM_QSTR(MP_QSTR_crc32), MP_ROM_PTR(&mod_binascii_crc32_obj) },
     #endif
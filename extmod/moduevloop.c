@@ -0,0 +1,515 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Damien P. George
+ * Copyright (c) 2016-2017 Paul Sokolovsky
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "py/runtime.h"
+#include "py/builtin.h"
+#include "py/objgenerator.h"
+#include "py/stream.h"
+#include "py/mphal.h"
+
+#include "supervisor/shared/translate.h"
+
+#if MICROPY_PY_UEVLOOP
+
+// An event loop for cooperative tasks written as generators.  Each time a task
+// yields, the value it yields says when it should next run:
+//
+//  - None: as soon as the other ready tasks have had a turn
+//  - an int: after that many milliseconds
+//  - a generator: start that generator as a new task, and continue as for None
+//  - the loop itself: not until something calls create_task() on it again,
+//    for example after wait_read() or wait_write() registered it for I/O
+//
+// Ready tasks are kept in a ring buffer and sleeping tasks in a binary heap
+// ordered by wake-up time, so a task switch costs a resume of the generator
+// and no allocation.  When there is nothing to run the loop blocks in the
+// poll object of the uselect module until the next deadline, or in
+// mp_hal_delay_ms() if it isn't waiting for any I/O.
+
+#define UEVLOOP_READY_INIT (8)
+
+typedef struct _uevloop_timer_t {
+    mp_uint_t time;
+    mp_uint_t id;
+    mp_obj_t task;
+} uevloop_timer_t;
+
+#if MICROPY_PY_UEVLOOP_POLL
+typedef struct _uevloop_io_t {
+    mp_obj_t obj;
+    mp_obj_t task[2]; // tasks waiting to read and to write
+    mp_uint_t revents;
+} uevloop_io_t;
+#endif
+
+typedef struct _mp_obj_uevloop_t {
+    mp_obj_base_t base;
+    bool stop;
+    // ring buffer of tasks ready to run, ready_alloc is a power of 2
+    size_t ready_alloc;
+    size_t ready_head;
+    size_t ready_len;
+    mp_obj_t *ready;
+    // heap of sleeping tasks
+    size_t timers_alloc;
+    size_t timers_len;
+    mp_uint_t timer_id;
+    uevloop_timer_t *timers;
+    #if MICROPY_PY_UEVLOOP_POLL
+    size_t io_alloc;
+    size_t io_len;
+    uevloop_io_t *io;
+    mp_obj_t poller;
+    #endif
+    mp_obj_t cur_task;
+    mp_obj_t main_task;
+    mp_obj_t main_ret;
+} mp_obj_uevloop_t;
+
+STATIC mp_obj_t uevloop_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    (void)args;
+    mp_arg_check_num(n_args, n_kw, 0, 0, false);
+    mp_obj_uevloop_t *self = m_new0(mp_obj_uevloop_t, 1);
+    self->base.type = type;
+    self->ready_alloc = UEVLOOP_READY_INIT;
+    self->ready = m_new0(mp_obj_t, UEVLOOP_READY_INIT);
+    self->cur_task = MP_OBJ_NULL;
+    self->main_task = MP_OBJ_NULL;
+    self->main_ret = mp_const_none;
+    #if MICROPY_PY_UEVLOOP_POLL
+    self->poller = MP_OBJ_NULL;
+    #endif
+    return MP_OBJ_FROM_PTR(self);
+}
+
+/******************************************************************************/
+// ready queue
+
+STATIC void uevloop_push_ready(mp_obj_uevloop_t *self, mp_obj_t task) {
+    if (self->ready_len == self->ready_alloc) {
+        // grow the ring, copying it so that it starts at index 0
+        size_t alloc = self->ready_alloc * 2;
+        mp_obj_t *ready = m_new0(mp_obj_t, alloc);
+        for (size_t i = 0; i < self->ready_len; ++i) {
+            ready[i] = self->ready[(self->ready_head + i) & (self->ready_alloc - 1)];
+        }
+        m_del(mp_obj_t, self->ready, self->ready_alloc);
+        self->ready = ready;
+        self->ready_alloc = alloc;
+        self->ready_head = 0;
+    }
+    self->ready[(self->ready_head + self->ready_len++) & (self->ready_alloc - 1)] = task;
+}
+
+STATIC mp_obj_t uevloop_pop_ready(mp_obj_uevloop_t *self) {
+    mp_obj_t task = self->ready[self->ready_head];
+    self->ready[self->ready_head] = MP_OBJ_NULL; // so we don't retain a pointer
+    self->ready_head = (self->ready_head + 1) & (self->ready_alloc - 1);
+    self->ready_len -= 1;
+    return task;
+}
+
+/******************************************************************************/
+// timer heap, the algorithm is the same as for utimeq
+
+STATIC bool timer_less_than(const uevloop_timer_t *item, const uevloop_timer_t *parent) {
+    mp_int_t diff = item->time - parent->time;
+    if (diff == 0) {
+        return item->id < parent->id;
+    }
+    return diff < 0;
+}
+
+STATIC void timer_siftdown(mp_obj_uevloop_t *self, size_t start_pos, size_t pos) {
+    uevloop_timer_t item = self->timers[pos];
+    while (pos > start_pos) {
+        size_t parent_pos = (pos - 1) >> 1;
+        uevloop_timer_t *parent = &self->timers[parent_pos];
+        if (!timer_less_than(&item, parent)) {
+            break;
+        }
+        self->timers[pos] = *parent;
+        pos = parent_pos;
+    }
+    self->timers[pos] = item;
+}
+
+STATIC void timer_siftup(mp_obj_uevloop_t *self, size_t pos) {
+    size_t start_pos = pos;
+    size_t end_pos = self->timers_len;
+    uevloop_timer_t item = self->timers[pos];
+    for (size_t child_pos = 2 * pos + 1; child_pos < end_pos; child_pos = 2 * pos + 1) {
+        // choose right child if it's <= left child
+        if (child_pos + 1 < end_pos
+            && !timer_less_than(&self->timers[child_pos], &self->timers[child_pos + 1])) {
+            child_pos += 1;
+        }
+        // bubble up the smaller child
+        self->timers[pos] = self->timers[child_pos];
+        pos = child_pos;
+    }
+    self->timers[pos] = item;
+    timer_siftdown(self, start_pos, pos);
+}
+
+STATIC void uevloop_push_timer(mp_obj_uevloop_t *self, mp_int_t delay, mp_obj_t task) {
+    if (self->timers_len == self->timers_alloc) {
+        size_t alloc = self->timers_alloc * 2 + 4;
+        self->timers = m_renew(uevloop_timer_t, self->timers, self->timers_alloc, alloc);
+        self->timers_alloc = alloc;
+    }
+    uevloop_timer_t *t = &self->timers[self->timers_len];
+    t->time = mp_hal_ticks_ms() + delay;
+    t->id = self->timer_id++;
+    t->task = task;
+    timer_siftdown(self, 0, self->timers_len++);
+}
+
+STATIC mp_obj_t uevloop_pop_timer(mp_obj_uevloop_t *self) {
+    mp_obj_t task = self->timers[0].task;
+    self->timers_len -= 1;
+    self->timers[0] = self->timers[self->timers_len];
+    self->timers[self->timers_len].task = MP_OBJ_NULL; // so we don't retain a pointer
+    if (self->timers_len) {
+        timer_siftup(self, 0);
+    }
+    return task;
+}
+
+/******************************************************************************/
+// waiting for I/O
+
+#if MICROPY_PY_UEVLOOP_POLL
+
+STATIC mp_uint_t uevloop_io_flags(uevloop_io_t *io) {
+    return (io->task[0] != MP_OBJ_NULL ? MP_STREAM_POLL_RD : 0)
+        | (io->task[1] != MP_OBJ_NULL ? MP_STREAM_POLL_WR : 0);
+}
+
+STATIC void uevloop_poller_call(mp_obj_uevloop_t *self, qstr meth, mp_obj_t obj, mp_uint_t flags) {
+    mp_obj_t dest[4];
+    mp_load_method(self->poller, meth, dest);
+    dest[2] = obj;
+    dest[3] = MP_OBJ_NEW_SMALL_INT(flags);
+    mp_call_method_n_kw(meth == MP_QSTR_unregister ? 1 : 2, 0, dest);
+}
+
+STATIC mp_obj_t uevloop_wait_io(mp_obj_t self_in, mp_obj_t obj, size_t idx) {
+    mp_obj_uevloop_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->cur_task == MP_OBJ_NULL) {
+        mp_raise_RuntimeError(translate("no running task"));
+    }
+    uevloop_io_t *io = NULL;
+    for (size_t i = 0; i < self->io_len; ++i) {
+        if (self->io[i].obj == obj) {
+            io = &self->io[i];
+            break;
+        }
+    }
+    if (io == NULL) {
+        if (self->poller == MP_OBJ_NULL) {
+            mp_obj_t poll_fun = mp_load_attr(MP_OBJ_FROM_PTR(&mp_module_uselect), MP_QSTR_poll);
+            self->poller = mp_call_function_0(poll_fun);
+        }
+        if (self->io_len == self->io_alloc) {
+            size_t alloc = self->io_alloc + 4;
+            self->io = m_renew(uevloop_io_t, self->io, self->io_alloc, alloc);
+            self->io_alloc = alloc;
+        }
+        io = &self->io[self->io_len];
+        io->obj = obj;
+        io->task[0] = MP_OBJ_NULL;
+        io->task[1] = MP_OBJ_NULL;
+        io->task[idx] = self->cur_task;
+        io->revents = 0;
+        uevloop_poller_call(self, MP_QSTR_register, obj, uevloop_io_flags(io));
+        // only count the entry once the poller accepted the object
+        self->io_len += 1;
+    } else {
+        if (io->task[idx] != MP_OBJ_NULL && io->task[idx] != self->cur_task) {
+            mp_raise_RuntimeError(translate("another task is waiting"));
+        }
+        io->task[idx] = self->cur_task;
+        uevloop_poller_call(self, MP_QSTR_modify, obj, uevloop_io_flags(io));
+    }
+    // the task yields the loop to suspend itself until the I/O is ready
+    return self_in;
+}
+
+STATIC void uevloop_io_ready(mp_obj_uevloop_t *self) {
+    for (size_t i = 0; i < self->io_len;) {
+        uevloop_io_t *io = &self->io[i];
+        mp_uint_t revents = io->revents;
+        if (revents == 0) {
+            ++i;
+            continue;
+        }
+        io->revents = 0;
+        // errors and hang-ups wake both readers and writers
+        if (io->task[0] != MP_OBJ_NULL && (revents & ~MP_STREAM_POLL_WR)) {
+            uevloop_push_ready(self, io->task[0]);
+            io->task[0] = MP_OBJ_NULL;
+        }
+        if (io->task[1] != MP_OBJ_NULL && (revents & ~MP_STREAM_POLL_RD)) {
+            uevloop_push_ready(self, io->task[1]);
+            io->task[1] = MP_OBJ_NULL;
+        }
+        mp_uint_t flags = uevloop_io_flags(io);
+        if (flags != 0) {
+            uevloop_poller_call(self, MP_QSTR_modify, io->obj, flags);
+            ++i;
+        } else {
+            // nobody is waiting on this object any more so forget it
+            mp_obj_t obj = io->obj;
+            *io = self->io[--self->io_len];
+            self->io[self->io_len].obj = MP_OBJ_NULL;
+            uevloop_poller_call(self, MP_QSTR_unregister, obj, 0);
+        }
+    }
+}
+
+#endif // MICROPY_PY_UEVLOOP_POLL
+
+// Wait for up to timeout ms (forever if timeout is negative) for I/O to
+// become ready, and make ready the tasks waiting for it.
+STATIC void uevloop_wait(mp_obj_uevloop_t *self, mp_int_t timeout) {
+    #if MICROPY_PY_UEVLOOP_POLL
+    if (self->io_len != 0) {
+        mp_obj_t dest[3];
+        mp_load_method(self->poller, MP_QSTR_ipoll, dest);
+        dest[2] = MP_OBJ_NEW_SMALL_INT(timeout);
+        mp_obj_t iter = mp_call_method_n_kw(1, 0, dest);
+        mp_obj_t item;
+        // just record the events here because the poller can't be changed
+        // while it is being iterated
+        while ((item = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+            mp_obj_t *ev;
+            mp_obj_get_array_fixed_n(item, 2, &ev);
+            for (size_t i = 0; i < self->io_len; ++i) {
+                if (self->io[i].obj == ev[0]) {
+                    self->io[i].revents |= MP_OBJ_SMALL_INT_VALUE(ev[1]);
+                    break;
+                }
+            }
+        }
+        uevloop_io_ready(self);
+        return;
+    }
+    #endif
+    if (timeout > 0) {
+        mp_hal_delay_ms(timeout);
+    }
+}
+
+/******************************************************************************/
+// running tasks
+
+STATIC void uevloop_run_task(mp_obj_uevloop_t *self, mp_obj_t task) {
+    mp_obj_t ret;
+    self->cur_task = task;
+    mp_vm_return_kind_t kind = mp_resume(task, mp_const_none, MP_OBJ_NULL, &ret);
+    self->cur_task = MP_OBJ_NULL;
+
+    if (kind == MP_VM_RETURN_YIELD) {
+        if (ret == mp_const_none) {
+            uevloop_push_ready(self, task);
+        } else if (MP_OBJ_IS_SMALL_INT(ret)) {
+            mp_int_t delay = MP_OBJ_SMALL_INT_VALUE(ret);
+            if (delay > 0) {
+                uevloop_push_timer(self, delay, task);
+            } else {
+                uevloop_push_ready(self, task);
+            }
+        } else if (ret == MP_OBJ_FROM_PTR(self)) {
+            // task is suspended until someone makes it ready again
+        } else if (MP_OBJ_IS_TYPE(ret, &mp_type_gen_instance)) {
+            uevloop_push_ready(self, ret);
+            uevloop_push_ready(self, task);
+        } else {
+            mp_raise_TypeError(translate("unsupported yield value"));
+        }
+    } else if (kind == MP_VM_RETURN_NORMAL) {
+        if (task == self->main_task) {
+            self->main_ret = ret == MP_OBJ_STOP_ITERATION ? mp_const_none : ret;
+            self->stop = true;
+        }
+    } else {
+        // the exception propagates out of run_forever/run_until_complete
+        nlr_raise(ret);
+    }
+}
+
+STATIC void uevloop_run(mp_obj_uevloop_t *self) {
+    self->stop = false;
+    while (!self->stop) {
+        // wake tasks whose sleep has expired
+        mp_uint_t now = mp_hal_ticks_ms();
+        while (self->timers_len != 0 && (mp_int_t)(now - self->timers[0].time) >= 0) {
+            uevloop_push_ready(self, uevloop_pop_timer(self));
+        }
+
+        if (self->ready_len == 0) {
+            // nothing to run, so sleep until the next deadline or I/O
+            mp_int_t timeout = -1;
+            if (self->timers_len != 0) {
+                timeout = self->timers[0].time - now;
+            }
+            #if MICROPY_PY_UEVLOOP_POLL
+            if (timeout < 0 && self->io_len == 0) {
+                break;
+            }
+            #else
+            if (timeout < 0) {
+                break;
+            }
+            #endif
+            uevloop_wait(self, timeout);
+            continue;
+        }
+
+        #if MICROPY_PY_UEVLOOP_POLL
+        if (self->io_len != 0) {
+            uevloop_wait(self, 0);
+        }
+        #endif
+
+        // run the tasks that are ready now; any that they make ready run in the
+        // next pass, after timers and I/O have been checked again
+        for (size_t n = self->ready_len; n > 0 && !self->stop; --n) {
+            uevloop_run_task(self, uevloop_pop_ready(self));
+        }
+    }
+}
+
+/******************************************************************************/
+// Python methods
+
+STATIC mp_obj_t uevloop_create_task(mp_obj_t self_in, mp_obj_t task) {
+    mp_obj_uevloop_t *self = MP_OBJ_TO_PTR(self_in);
+    uevloop_push_ready(self, task);
+    return task;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(uevloop_create_task_obj, uevloop_create_task);
+
+STATIC mp_obj_t uevloop_call_later_ms(mp_obj_t self_in, mp_obj_t delay_in, mp_obj_t task) {
+    mp_obj_uevloop_t *self = MP_OBJ_TO_PTR(self_in);
+    uevloop_push_timer(self, mp_obj_get_int(delay_in), task);
+    return task;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(uevloop_call_later_ms_obj, uevloop_call_later_ms);
+
+STATIC mp_obj_t uevloop_run_forever(mp_obj_t self_in) {
+    uevloop_run(MP_OBJ_TO_PTR(self_in));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(uevloop_run_forever_obj, uevloop_run_forever);
+
+STATIC mp_obj_t uevloop_run_until_complete(mp_obj_t self_in, mp_obj_t task) {
+    mp_obj_uevloop_t *self = MP_OBJ_TO_PTR(self_in);
+    uevloop_push_ready(self, task);
+    self->main_task = task;
+    self->main_ret = mp_const_none;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        uevloop_run(self);
+        nlr_pop();
+    } else {
+        self->main_task = MP_OBJ_NULL;
+        nlr_jump(nlr.ret_val);
+    }
+    self->main_task = MP_OBJ_NULL;
+    mp_obj_t ret = self->main_ret;
+    self->main_ret = mp_const_none;
+    return ret;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(uevloop_run_until_complete_obj, uevloop_run_until_complete);
+
+STATIC mp_obj_t uevloop_stop(mp_obj_t self_in) {
+    mp_obj_uevloop_t *self = MP_OBJ_TO_PTR(self_in);
+    self->stop = true;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(uevloop_stop_obj, uevloop_stop);
+
+#if MICROPY_PY_UEVLOOP_POLL
+STATIC mp_obj_t uevloop_wait_read(mp_obj_t self_in, mp_obj_t obj) {
+    return uevloop_wait_io(self_in, obj, 0);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(uevloop_wait_read_obj, uevloop_wait_read);
+
+STATIC mp_obj_t uevloop_wait_write(mp_obj_t self_in, mp_obj_t obj) {
+    return uevloop_wait_io(self_in, obj, 1);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(uevloop_wait_write_obj, uevloop_wait_write);
+#endif
+
+STATIC mp_obj_t uevloop_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
+    mp_obj_uevloop_t *self = MP_OBJ_TO_PTR(self_in);
+    // the number of tasks that are ready or sleeping
+    size_t len = self->ready_len + self->timers_len;
+    switch (op) {
+        case MP_UNARY_OP_BOOL: return mp_obj_new_bool(len != 0);
+        case MP_UNARY_OP_LEN: return MP_OBJ_NEW_SMALL_INT(len);
+        default: return MP_OBJ_NULL; // op not supported
+    }
+}
+
+STATIC const mp_rom_map_elem_t uevloop_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_create_task), MP_ROM_PTR(&uevloop_create_task_obj) },
+    { MP_ROM_QSTR(MP_QSTR_call_later_ms), MP_ROM_PTR(&uevloop_call_later_ms_obj) },
+    { MP_ROM_QSTR(MP_QSTR_run_forever), MP_ROM_PTR(&uevloop_run_forever_obj) },
+    { MP_ROM_QSTR(MP_QSTR_run_until_complete), MP_ROM_PTR(&uevloop_run_until_complete_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stop), MP_ROM_PTR(&uevloop_stop_obj) },
+    #if MICROPY_PY_UEVLOOP_POLL
+    { MP_ROM_QSTR(MP_QSTR_wait_read), MP_ROM_PTR(&uevloop_wait_read_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait_write), MP_ROM_PTR(&uevloop_wait_write_obj) },
+    #endif
+};
+
+STATIC MP_DEFINE_CONST_DICT(uevloop_locals_dict, uevloop_locals_dict_table);
+
+STATIC const mp_obj_type_t uevloop_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Loop,
+    .make_new = uevloop_make_new,
+    .unary_op = uevloop_unary_op,
+    .locals_dict = (void*)&uevloop_locals_dict,
+};
+
+STATIC const mp_rom_map_elem_t mp_module_uevloop_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uevloop) },
+    { MP_ROM_QSTR(MP_QSTR_Loop), MP_ROM_PTR(&uevloop_type) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_uevloop_globals, mp_module_uevloop_globals_table);
+
+const mp_obj_module_t mp_module_uevloop = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&mp_module_uevloop_globals,
+};
+
+#endif // MICROPY_PY_UEVLOOP
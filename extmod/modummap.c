@@ -0,0 +1,340 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013-2018 Damien P. George
+ * Copyright (c) 2014 Paul Sokolovsky
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/binary.h"
+#include "py/stream.h"
+#include "py/mperrno.h"
+
+#include "supervisor/shared/translate.h"
+
+#if MICROPY_PY_UMMAP
+
+#if MICROPY_PY_UMMAP_POSIX
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Memory-mapped files.  A file object maps itself through the MP_STREAM_MMAP
+// ioctl if it can, which a filesystem on a memory-mapped block device (such
+// as internal flash) supports by handing out the address of the file's data.
+// Otherwise, on POSIX, a file descriptor or an object with a fileno() method
+// is mapped with mmap(2).  The mapped region is exposed through the buffer
+// protocol, so memoryview, ustruct.unpack_from() and the like use it in
+// place without copying it to the heap.  Such a view doesn't keep the mmap
+// object alive, so the region isn't unmapped when the object is collected,
+// only by close(): a mapping that is never closed stays until exit.
+
+#define ACCESS_DEFAULT (0)
+#define ACCESS_READ (1)
+#define ACCESS_WRITE (2)
+#define ACCESS_COPY (3)
+
+typedef struct _mp_obj_mmap_t {
+    mp_obj_base_t base;
+    byte *buf; // NULL once closed
+    size_t len;
+    bool writable;
+    #if MICROPY_PY_UMMAP_POSIX
+    // the whole pages mapped by mmap(2), or NULL for a region from a stream
+    void *map_addr;
+    size_t map_len;
+    #endif
+} mp_obj_mmap_t;
+
+// Check the region against the size of the file, returning its length.
+STATIC size_t mmap_check_region(mp_off_t size, size_t len, mp_off_t offset) {
+    if (len == 0) {
+        if (size == 0) {
+            mp_raise_ValueError(translate("cannot mmap an empty file"));
+        }
+        if (offset >= size) {
+            mp_raise_ValueError(translate("mmap offset is greater than file size"));
+        }
+        len = size - offset;
+    } else if (offset > size || len > (size_t)(size - offset)) {
+        mp_raise_ValueError(translate("mmap length is greater than file size"));
+    }
+    return len;
+}
+
+STATIC mp_obj_mmap_t *mmap_get_open(mp_obj_t self_in) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->buf == NULL) {
+        mp_raise_ValueError(translate("mmap closed or invalid"));
+    }
+    return self;
+}
+
+#if MICROPY_PY_UMMAP_POSIX
+STATIC void mmap_map_fd(mp_obj_mmap_t *self, int fd, size_t len, mp_off_t offset, mp_int_t access) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        mp_raise_OSError(errno);
+    }
+    if (S_ISREG(st.st_mode)) {
+        len = mmap_check_region(st.st_size, len, offset);
+    }
+
+    // mmap(2) maps whole pages, so start at the page holding offset
+    mp_off_t page_offset = offset % sysconf(_SC_PAGESIZE);
+    int prot = access == ACCESS_READ ? PROT_READ : PROT_READ | PROT_WRITE;
+    int flags = access == ACCESS_COPY ? MAP_PRIVATE : MAP_SHARED;
+    void *addr = mmap(NULL, len + page_offset, prot, flags, fd, offset - page_offset);
+    if (addr == MAP_FAILED) {
+        mp_raise_OSError(errno);
+    }
+    self->map_addr = addr;
+    self->map_len = len + page_offset;
+    self->buf = (byte*)addr + page_offset;
+    self->len = len;
+}
+#endif
+
+/// \class mmap - memory-mapped file
+/// \constructor mmap(fileno, length, *, access=ACCESS_DEFAULT, offset=0)
+STATIC mp_obj_t mmap_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    enum { ARG_fileno, ARG_length, ARG_access, ARG_offset };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_fileno, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_length, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_access, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = ACCESS_DEFAULT} },
+        { MP_QSTR_offset, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+
+    mp_obj_t src = vals[ARG_fileno].u_obj;
+    mp_int_t len = vals[ARG_length].u_int;
+    mp_int_t access = vals[ARG_access].u_int;
+    mp_int_t offset = vals[ARG_offset].u_int;
+    if (len < 0 || offset < 0) {
+        mp_raise_ValueError(translate("negative length or offset"));
+    }
+    if (access < ACCESS_DEFAULT || access > ACCESS_COPY) {
+        mp_raise_ValueError(translate("invalid access value"));
+    }
+
+    mp_obj_mmap_t *self = m_new_obj(mp_obj_mmap_t);
+    self->base.type = type;
+    self->buf = NULL;
+    self->len = 0;
+    self->writable = access != ACCESS_READ;
+    #if MICROPY_PY_UMMAP_POSIX
+    self->map_addr = NULL;
+
+    if (MP_OBJ_IS_SMALL_INT(src)) {
+        mmap_map_fd(self, MP_OBJ_SMALL_INT_VALUE(src), len, offset, access);
+        return MP_OBJ_FROM_PTR(self);
+    }
+    #endif
+
+    // let a file that is already in memory hand out its data
+    int errcode = MP_ENODEV;
+    const mp_stream_p_t *stream_p = mp_get_stream(src);
+    if (stream_p != NULL && stream_p->ioctl != NULL) {
+        // find the size of the file, leaving its position as it was
+        struct mp_stream_seek_t seek = { .offset = 0, .whence = MP_SEEK_CUR };
+        if (stream_p->ioctl(src, MP_STREAM_SEEK, (uintptr_t)&seek, &errcode) != MP_STREAM_ERROR) {
+            mp_off_t pos = seek.offset;
+            seek.whence = MP_SEEK_END;
+            stream_p->ioctl(src, MP_STREAM_SEEK, (uintptr_t)&seek, &errcode);
+            len = mmap_check_region(seek.offset, len, offset);
+            seek.offset = pos;
+            seek.whence = MP_SEEK_SET;
+            stream_p->ioctl(src, MP_STREAM_SEEK, (uintptr_t)&seek, &errcode);
+        }
+
+        struct mp_stream_mmap_t map;
+        map.offset = offset;
+        map.len = len;
+        map.write = self->writable;
+        if (stream_p->ioctl(src, MP_STREAM_MMAP, (uintptr_t)&map, &errcode) != MP_STREAM_ERROR) {
+            self->buf = map.addr;
+            self->len = map.len;
+            return MP_OBJ_FROM_PTR(self);
+        }
+    }
+
+    #if MICROPY_PY_UMMAP_POSIX
+    // otherwise map the file behind it
+    if (errcode == MP_EINVAL || errcode == MP_ENODEV) {
+        mp_obj_t dest[2];
+        mp_load_method_maybe(src, MP_QSTR_fileno, dest);
+        if (dest[0] != MP_OBJ_NULL) {
+            int fd = mp_obj_get_int(mp_call_method_n_kw(0, 0, dest));
+            mmap_map_fd(self, fd, len, offset, access);
+            return MP_OBJ_FROM_PTR(self);
+        }
+    }
+    #endif
+
+    if (errcode == MP_EINVAL) {
+        // the stream doesn't know about MP_STREAM_MMAP
+        errcode = MP_ENODEV;
+    }
+    mp_raise_OSError(errcode);
+}
+
+/// \method close()
+/// Unmap the region.  Objects that refer to its data, such as memoryviews,
+/// must no longer be used.
+STATIC mp_obj_t mmap_close(mp_obj_t self_in) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    #if MICROPY_PY_UMMAP_POSIX
+    if (self->map_addr != NULL) {
+        munmap(self->map_addr, self->map_len);
+        self->map_addr = NULL;
+    }
+    #endif
+    self->buf = NULL;
+    self->len = 0;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mmap_close_obj, mmap_close);
+
+STATIC mp_obj_t mmap___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    return mmap_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mmap___exit___obj, 4, 4, mmap___exit__);
+
+/// \method flush()
+/// Write changes made through the mapping back to the file.
+STATIC mp_obj_t mmap_flush(mp_obj_t self_in) {
+    mp_obj_mmap_t *self = mmap_get_open(self_in);
+    #if MICROPY_PY_UMMAP_POSIX
+    if (self->map_addr != NULL && msync(self->map_addr, self->map_len, MS_SYNC) != 0) {
+        mp_raise_OSError(errno);
+    }
+    #else
+    (void)self;
+    #endif
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mmap_flush_obj, mmap_flush);
+
+STATIC mp_obj_t mmap_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    switch (op) {
+        case MP_UNARY_OP_BOOL: return mp_obj_new_bool(self->len != 0);
+        case MP_UNARY_OP_LEN: return MP_OBJ_NEW_SMALL_INT(self->len);
+        default: return MP_OBJ_NULL; // op not supported
+    }
+}
+
+STATIC mp_obj_t mmap_subscr(mp_obj_t self_in, mp_obj_t index_in, mp_obj_t value) {
+    if (value == MP_OBJ_NULL) {
+        // delete item
+        return MP_OBJ_NULL; // op not supported
+    }
+    mp_obj_mmap_t *self = mmap_get_open(self_in);
+    if (value != MP_OBJ_SENTINEL && !self->writable) {
+        mp_raise_TypeError(translate("mmap can't be written to"));
+    }
+
+    #if MICROPY_PY_BUILTINS_SLICE
+    if (MP_OBJ_IS_TYPE(index_in, &mp_type_slice)) {
+        mp_bound_slice_t slice;
+        if (!mp_seq_get_fast_slice_indexes(self->len, index_in, &slice)) {
+            mp_raise_NotImplementedError(translate("only slices with step=1 (aka None) are supported"));
+        }
+        if (value == MP_OBJ_SENTINEL) {
+            // load
+            return mp_obj_new_bytes(self->buf + slice.start, slice.stop - slice.start);
+        }
+        // store, which can't change the size of the mapping
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(value, &bufinfo, MP_BUFFER_READ);
+        if (bufinfo.len != slice.stop - slice.start) {
+            mp_raise_IndexError(translate("mmap slice assignment is wrong size"));
+        }
+        memmove(self->buf + slice.start, bufinfo.buf, bufinfo.len);
+        return mp_const_none;
+    }
+    #endif
+
+    size_t index = mp_get_index(self->base.type, self->len, index_in, false);
+    if (value == MP_OBJ_SENTINEL) {
+        // load
+        return MP_OBJ_NEW_SMALL_INT(self->buf[index]);
+    }
+    // store
+    self->buf[index] = mp_obj_get_int(value);
+    return mp_const_none;
+}
+
+STATIC mp_int_t mmap_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->buf == NULL || ((flags & MP_BUFFER_WRITE) && !self->writable)) {
+        return 1;
+    }
+    bufinfo->buf = self->buf;
+    bufinfo->len = self->len;
+    bufinfo->typecode = BYTEARRAY_TYPECODE;
+    return 0;
+}
+
+STATIC const mp_rom_map_elem_t mmap_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mmap_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&mmap_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&mmap___exit___obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(mmap_locals_dict, mmap_locals_dict_table);
+
+STATIC const mp_obj_type_t mmap_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_mmap,
+    .make_new = mmap_make_new,
+    .unary_op = mmap_unary_op,
+    .subscr = mmap_subscr,
+    .buffer_p = { .get_buffer = mmap_get_buffer },
+    .locals_dict = (mp_obj_dict_t*)&mmap_locals_dict,
+};
+
+STATIC const mp_rom_map_elem_t mp_module_ummap_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ummap) },
+    { MP_ROM_QSTR(MP_QSTR_mmap), MP_ROM_PTR(&mmap_type) },
+    { MP_ROM_QSTR(MP_QSTR_ACCESS_DEFAULT), MP_ROM_INT(ACCESS_DEFAULT) },
+    { MP_ROM_QSTR(MP_QSTR_ACCESS_READ), MP_ROM_INT(ACCESS_READ) },
+    { MP_ROM_QSTR(MP_QSTR_ACCESS_WRITE), MP_ROM_INT(ACCESS_WRITE) },
+    { MP_ROM_QSTR(MP_QSTR_ACCESS_COPY), MP_ROM_INT(ACCESS_COPY) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_ummap_globals, mp_module_ummap_globals_table);
+
+const mp_obj_module_t mp_module_ummap = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&mp_module_ummap_globals,
+};
+
+#endif // MICROPY_PY_UMMAP
@@ -36,11 +36,20 @@
 #if MICROPY_PY_URE
 
 #define re1_5_stack_chk() MP_STACK_CHECK()
+#define re1_5_alloc(n) m_new(char, n)
+#define re1_5_free(p, n) m_del(char, p, n)
 
 #include "re1.5/re1.5.h"
 
 #define FLAG_DEBUG 0x1000
 
+#if MICROPY_PY_URE_PIKEVM
+// linear time in the subject, no recursion per subject char
+#define re1_5_exec re1_5_pikevm
+#else
+#define re1_5_exec re1_5_recursiveloopprog
+#endif
+
 typedef struct _mp_obj_re_t {
     mp_obj_base_t base;
     ByteProg re;
@@ -107,7 +116,7 @@ STATIC mp_obj_t ure_exec(bool is_anchored, uint n_args, const mp_obj_t *args) {
     mp_obj_match_t *match = m_new_obj_var(mp_obj_match_t, char*, caps_num);
     // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
     memset((char*)match->caps, 0, caps_num * sizeof(char*));
-    int res = re1_5_recursiveloopprog(&self->re, &subj, match->caps, caps_num, is_anchored);
+    int res = re1_5_exec(&self->re, &subj, match->caps, caps_num, is_anchored);
     if (res == 0) {
         m_del_var(mp_obj_match_t, char*, caps_num, match);
         return mp_const_none;
@@ -148,7 +157,7 @@ STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
     while (true) {
         // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
         memset((char**)caps, 0, caps_num * sizeof(char*));
-        int res = re1_5_recursiveloopprog(&self->re, &subj, caps, caps_num, false);
+        int res = re1_5_exec(&self->re, &subj, caps, caps_num, false);
 
         // if we didn't have a match, or had an empty match, it's time to stop
         if (!res || caps[0] == caps[1]) {
@@ -213,9 +222,39 @@ error:
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_re_compile_obj, 1, 2, mod_re_compile);
 
+#if MICROPY_PY_URE_CACHE_SIZE
+// Compiled regexes used by the module-level functions, most recently used
+// first, stored as (pattern, compiled) pairs.
+STATIC mp_obj_t ure_compile_cached(mp_obj_t pattern) {
+    mp_obj_t *cache = MP_STATE_VM(ure_cache);
+    mp_obj_t re = MP_OBJ_NULL;
+    size_t i = 0;
+    for (; i < MICROPY_PY_URE_CACHE_SIZE && cache[2 * i] != MP_OBJ_NULL; i++) {
+        if (cache[2 * i] == pattern
+            || (mp_obj_get_type(cache[2 * i]) == mp_obj_get_type(pattern) && mp_obj_equal(cache[2 * i], pattern))) {
+            re = cache[2 * i + 1];
+            break;
+        }
+    }
+    if (re == MP_OBJ_NULL) {
+        re = mod_re_compile(1, &pattern);
+        if (i == MICROPY_PY_URE_CACHE_SIZE) {
+            // full, so drop the least recently used entry
+            i--;
+        }
+    }
+    memmove(&cache[2], &cache[0], 2 * i * sizeof(mp_obj_t));
+    cache[0] = pattern;
+    cache[1] = re;
+    return re;
+}
+#else
+#define ure_compile_cached(pattern) mod_re_compile(1, &(pattern))
+#endif
+
 STATIC mp_obj_t mod_re_exec(bool is_anchored, uint n_args, const mp_obj_t *args) {
     (void)n_args;
-    mp_obj_t self = mod_re_compile(1, args);
+    mp_obj_t self = ure_compile_cached(args[0]);
 
     const mp_obj_t args2[] = {self, args[1]};
     mp_obj_t match = ure_exec(is_anchored, 2, args2);
@@ -253,7 +292,11 @@ const mp_obj_module_t mp_module_ure = {
 #define re1_5_fatal(x) assert(!x)
 #include "re1.5/compilecode.c"
 #include "re1.5/dumpcode.c"
+#if MICROPY_PY_URE_PIKEVM
+#include "re1.5/pike.c"
+#else
 #include "re1.5/recursiveloop.c"
+#endif
 #include "re1.5/charclass.c"
 
 #endif //MICROPY_PY_URE
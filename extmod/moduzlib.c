@@ -203,10 +203,392 @@ error:
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_decompress_obj, 1, 3, mod_uzlib_decompress);
 
+#if MICROPY_PY_UZLIB_COMPRESS
+
+// Streaming DEFLATE compressor.  Input is kept in a ring buffer of 2 << wbits
+// bytes: the last 1 << wbits bytes already encoded (the LZ77 window) plus up
+// to 1 << wbits bytes of lookahead.  Matches are found greedily through a
+// single-entry hash table of the positions of previous 3-byte sequences, and
+// are encoded with the fixed Huffman codes (BTYPE=01), so there are no code
+// tables to build or store.
+
+#define DEFL_MIN_MATCH (3)
+#define DEFL_MAX_MATCH (258)
+#define DEFL_DEFAULT_WBITS (10)
+
+enum {
+    DEFL_FORMAT_RAW,
+    DEFL_FORMAT_ZLIB,
+    DEFL_FORMAT_GZIP,
+};
+
+typedef struct _defl_t {
+    vstr_t out; // compressed output not yet handed to the caller
+    byte *ring;
+    uint16_t *head;
+    uint32_t pos; // stream position of the next byte to encode
+    uint32_t end; // stream position just after the last byte of input
+    uint32_t check; // adler32 or crc32 of the input
+    uint32_t bitbuf;
+    uint8_t bitcount;
+    uint8_t wbits;
+    uint8_t format;
+    bool in_block;
+} defl_t;
+
+STATIC const uint16_t defl_len_base[] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+STATIC const uint8_t defl_len_extra[] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+STATIC const uint16_t defl_dist_base[] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+
+STATIC void defl_put_bits(defl_t *d, uint32_t value, uint nbits) {
+    d->bitbuf |= value << d->bitcount;
+    d->bitcount += nbits;
+    while (d->bitcount >= 8) {
+        vstr_add_byte(&d->out, d->bitbuf);
+        d->bitbuf >>= 8;
+        d->bitcount -= 8;
+    }
+}
+
+// Huffman codes are packed starting from their most significant bit
+STATIC void defl_put_code(defl_t *d, uint32_t code, uint nbits) {
+    uint32_t rev = 0;
+    for (uint i = 0; i < nbits; i++) {
+        rev = (rev << 1) | (code & 1);
+        code >>= 1;
+    }
+    defl_put_bits(d, rev, nbits);
+}
+
+STATIC void defl_put_symbol(defl_t *d, uint sym) {
+    if (sym < 144) {
+        defl_put_code(d, 0x30 + sym, 8);
+    } else if (sym < 256) {
+        defl_put_code(d, 0x190 + sym - 144, 9);
+    } else if (sym < 280) {
+        defl_put_code(d, sym - 256, 7);
+    } else {
+        defl_put_code(d, 0xc0 + sym - 280, 8);
+    }
+}
+
+STATIC void defl_put_match(defl_t *d, uint len, uint dist) {
+    uint i = MP_ARRAY_SIZE(defl_len_base) - 1;
+    while (defl_len_base[i] > len) {
+        i--;
+    }
+    defl_put_symbol(d, 257 + i);
+    defl_put_bits(d, len - defl_len_base[i], defl_len_extra[i]);
+    i = MP_ARRAY_SIZE(defl_dist_base) - 1;
+    while (defl_dist_base[i] > dist) {
+        i--;
+    }
+    defl_put_code(d, i, 5);
+    // distance codes 0-3 have no extra bits, then 1 more every 2 codes
+    defl_put_bits(d, dist - defl_dist_base[i], i < 4 ? 0 : (i - 2) >> 1);
+}
+
+STATIC void defl_align(defl_t *d) {
+    defl_put_bits(d, 0, (8 - d->bitcount) & 7);
+}
+
+static inline uint defl_hash(defl_t *d, uint32_t p) {
+    uint32_t mask = (2 << d->wbits) - 1;
+    uint32_t v = d->ring[p & mask] << 16 | d->ring[(p + 1) & mask] << 8 | d->ring[(p + 2) & mask];
+    return (v * 2654435761u) >> (32 - (d->wbits - 1));
+}
+
+// Encode buffered input, keeping DEFL_MAX_MATCH bytes of lookahead unless
+// this is the end of the input (or a flush point).
+STATIC void defl_process(defl_t *d, bool all) {
+    uint32_t mask = (2 << d->wbits) - 1;
+    uint32_t window = 1 << d->wbits;
+    while (d->end - d->pos >= (all ? 1 : DEFL_MAX_MATCH)) {
+        if (!d->in_block) {
+            // BFINAL=0, BTYPE=01
+            defl_put_bits(d, 1 << 1, 3);
+            d->in_block = true;
+        }
+        uint32_t avail = d->end - d->pos;
+        uint len = 0;
+        uint dist = 0;
+        if (avail >= DEFL_MIN_MATCH) {
+            uint h = defl_hash(d, d->pos);
+            dist = (uint16_t)(d->pos - d->head[h]);
+            d->head[h] = d->pos;
+            if (dist > 0 && dist <= window && dist <= d->pos) {
+                uint max_len = MIN(avail, DEFL_MAX_MATCH);
+                const byte *ring = d->ring;
+                while (len < max_len && ring[(d->pos - dist + len) & mask] == ring[(d->pos + len) & mask]) {
+                    len++;
+                }
+            }
+        }
+        if (len >= DEFL_MIN_MATCH) {
+            defl_put_match(d, len, dist);
+            // index the positions inside the match so later data can refer to them
+            for (uint32_t p = d->pos + 1; p < d->pos + len && p + DEFL_MIN_MATCH <= d->end; p++) {
+                d->head[defl_hash(d, p)] = p;
+            }
+            d->pos += len;
+        } else {
+            defl_put_symbol(d, d->ring[d->pos & mask]);
+            d->pos += 1;
+        }
+    }
+}
+
+STATIC void defl_init(defl_t *d, int wbits, size_t size_hint) {
+    memset(d, 0, sizeof(*d));
+    if (wbits == 0) {
+        wbits = DEFL_DEFAULT_WBITS;
+    }
+    if (wbits >= 16) {
+        d->format = DEFL_FORMAT_GZIP;
+        wbits -= 16;
+    } else if (wbits > 0) {
+        d->format = DEFL_FORMAT_ZLIB;
+    } else {
+        d->format = DEFL_FORMAT_RAW;
+        wbits = -wbits;
+    }
+    if (wbits < 9 || wbits > 15) {
+        mp_raise_ValueError(translate("invalid wbits"));
+    }
+    // a window larger than the whole input is never used, so don't allocate it
+    while (wbits > 9 && ((size_t)1 << (wbits - 1)) >= size_hint) {
+        wbits--;
+    }
+    d->wbits = wbits;
+    d->ring = m_new(byte, 2 << wbits);
+    d->head = m_new0(uint16_t, 1 << (wbits - 1));
+    vstr_init(&d->out, 64);
+
+    if (d->format == DEFL_FORMAT_ZLIB) {
+        uint cmf = (wbits - 8) << 4 | 8;
+        vstr_add_byte(&d->out, cmf);
+        vstr_add_byte(&d->out, (31 - (cmf << 8) % 31) % 31);
+        d->check = 1;
+    } else if (d->format == DEFL_FORMAT_GZIP) {
+        // magic, CM=deflate, no flags, no mtime, XFL=0, OS=unknown
+        vstr_add_strn(&d->out, "\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+        d->check = 0xffffffff;
+    }
+}
+
+STATIC void defl_write(defl_t *d, const byte *buf, size_t len) {
+    uint32_t mask = (2 << d->wbits) - 1;
+    uint32_t lookahead_max = 1 << d->wbits;
+    while (len > 0) {
+        size_t n = MIN(len, lookahead_max - (d->end - d->pos));
+        if (d->format == DEFL_FORMAT_ZLIB) {
+            d->check = uzlib_adler32(buf, n, d->check);
+        } else if (d->format == DEFL_FORMAT_GZIP) {
+            d->check = uzlib_crc32(buf, n, d->check);
+        }
+        for (size_t i = 0; i < n; i++) {
+            d->ring[(d->end + i) & mask] = buf[i];
+        }
+        d->end += n;
+        buf += n;
+        len -= n;
+        if (d->end - d->pos == lookahead_max) {
+            defl_process(d, false);
+        }
+    }
+}
+
+// Encode all pending input and byte-align the output with an empty stored
+// block, so everything written so far can be decompressed (zlib's Z_SYNC_FLUSH)
+STATIC void defl_flush(defl_t *d) {
+    defl_process(d, true);
+    if (d->in_block) {
+        defl_put_symbol(d, 256);
+        d->in_block = false;
+    }
+    // BFINAL=0, BTYPE=00, then LEN=0 and NLEN=0xffff
+    defl_put_bits(d, 0, 3);
+    defl_align(d);
+    defl_put_bits(d, 0, 16);
+    defl_put_bits(d, 0xffff, 16);
+}
+
+STATIC void defl_finish(defl_t *d) {
+    defl_process(d, true);
+    if (d->in_block) {
+        defl_put_symbol(d, 256);
+        d->in_block = false;
+    }
+    // an empty final block: BFINAL=1, BTYPE=01, end-of-block
+    defl_put_bits(d, 1 | 1 << 1, 3);
+    defl_put_symbol(d, 256);
+    defl_align(d);
+    if (d->format == DEFL_FORMAT_ZLIB) {
+        for (int i = 24; i >= 0; i -= 8) {
+            vstr_add_byte(&d->out, d->check >> i);
+        }
+    } else if (d->format == DEFL_FORMAT_GZIP) {
+        uint32_t crc = d->check ^ 0xffffffff;
+        for (int i = 0; i < 32; i += 8) {
+            vstr_add_byte(&d->out, crc >> i);
+        }
+        for (int i = 0; i < 32; i += 8) {
+            vstr_add_byte(&d->out, d->end >> i);
+        }
+    }
+}
+
+STATIC void defl_deinit(defl_t *d) {
+    m_del(byte, d->ring, 2 << d->wbits);
+    m_del(uint16_t, d->head, 1 << (d->wbits - 1));
+    d->ring = NULL;
+    d->head = NULL;
+}
+
+typedef struct _mp_obj_compio_t {
+    mp_obj_base_t base;
+    mp_obj_t dest_stream;
+    defl_t comp;
+} mp_obj_compio_t;
+
+STATIC mp_obj_t compio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+    mp_get_stream_raise(args[0], MP_STREAM_OP_WRITE);
+    mp_obj_compio_t *o = m_new_obj(mp_obj_compio_t);
+    o->base.type = type;
+    o->dest_stream = args[0];
+    mp_int_t wbits = 0;
+    if (n_args > 1) {
+        wbits = mp_obj_get_int(args[1]);
+    }
+    defl_init(&o->comp, wbits, (size_t)-1);
+    return MP_OBJ_FROM_PTR(o);
+}
+
+// Pass the compressed data produced so far on to the destination stream.
+// After a short write the unwritten tail is kept for the next drain; if all
+// the data was needed this is reported as EAGAIN.
+STATIC mp_uint_t compio_drain(mp_obj_compio_t *o, bool all, int *errcode) {
+    vstr_t *out = &o->comp.out;
+    mp_uint_t n = mp_stream_write_exactly(o->dest_stream, out->buf, out->len, errcode);
+    memmove(out->buf, out->buf + n, out->len - n);
+    out->len -= n;
+    if (*errcode == 0 && all && out->len != 0) {
+        *errcode = MP_EAGAIN;
+    }
+    if (*errcode != 0) {
+        return MP_STREAM_ERROR;
+    }
+    return 0;
+}
+
+STATIC mp_uint_t compio_write(mp_obj_t o_in, const void *buf, mp_uint_t size, int *errcode) {
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(o_in);
+    if (o->comp.ring == NULL) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    defl_write(&o->comp, buf, size);
+    if (compio_drain(o, false, errcode) == MP_STREAM_ERROR) {
+        return MP_STREAM_ERROR;
+    }
+    return size;
+}
+
+STATIC mp_uint_t compio_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    (void)arg;
+    mp_obj_compio_t *o = MP_OBJ_TO_PTR(o_in);
+    switch (request) {
+        case MP_STREAM_FLUSH:
+            if (o->comp.ring != NULL) {
+                defl_flush(&o->comp);
+                return compio_drain(o, true, errcode);
+            }
+            return 0;
+        case MP_STREAM_CLOSE:
+            // finishes the compressed stream, but leaves the destination open;
+            // if it can't all be written yet, close can be retried
+            if (o->comp.ring != NULL) {
+                defl_finish(&o->comp);
+                defl_deinit(&o->comp);
+            }
+            if (o->comp.out.buf != NULL) {
+                if (compio_drain(o, true, errcode) == MP_STREAM_ERROR) {
+                    return MP_STREAM_ERROR;
+                }
+                vstr_clear(&o->comp.out);
+            }
+            return 0;
+        default:
+            *errcode = MP_EINVAL;
+            return MP_STREAM_ERROR;
+    }
+}
+
+STATIC mp_obj_t compio___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    return mp_stream_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(compio___exit___obj, 4, 4, compio___exit__);
+
+STATIC const mp_rom_map_elem_t compio_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&mp_stream_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mp_stream_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&compio___exit___obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(compio_locals_dict, compio_locals_dict_table);
+
+STATIC const mp_stream_p_t compio_stream_p = {
+    .write = compio_write,
+    .ioctl = compio_ioctl,
+};
+
+STATIC const mp_obj_type_t compio_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_CompIO,
+    .make_new = compio_make_new,
+    .protocol = &compio_stream_p,
+    .locals_dict = (void*)&compio_locals_dict,
+};
+
+STATIC mp_obj_t mod_uzlib_compress(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    mp_int_t wbits = 0;
+    if (n_args > 1) {
+        wbits = mp_obj_get_int(args[1]);
+    }
+    defl_t comp;
+    defl_init(&comp, wbits, bufinfo.len);
+    defl_write(&comp, bufinfo.buf, bufinfo.len);
+    defl_finish(&comp);
+    defl_deinit(&comp);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &comp.out);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_compress_obj, 1, 2, mod_uzlib_compress);
+
+#endif // MICROPY_PY_UZLIB_COMPRESS
+
 STATIC const mp_rom_map_elem_t mp_module_uzlib_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uzlib) },
     { MP_ROM_QSTR(MP_QSTR_decompress), MP_ROM_PTR(&mod_uzlib_decompress_obj) },
     { MP_ROM_QSTR(MP_QSTR_DecompIO), MP_ROM_PTR(&decompio_type) },
+    #if MICROPY_PY_UZLIB_COMPRESS
+    { MP_ROM_QSTR(MP_QSTR_compress), MP_ROM_PTR(&mod_uzlib_compress_obj) },
+    { MP_ROM_QSTR(MP_QSTR_CompIO), MP_ROM_PTR(&compio_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_uzlib_globals, mp_module_uzlib_globals_table);
@@ -0,0 +1,178 @@
+// Pike VM for ByteProg code: simulates all threads of the NFA in lock step,
+// so matching takes time linear in the length of the subject (for a given
+// regex) and C stack proportional only to the length of the regex.
+// Based on the Pike VM described by Russ Cox.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re1.5.h"
+
+#ifndef re1_5_alloc
+#define re1_5_alloc(n) malloc(n)
+#define re1_5_free(p, n) free(p)
+#endif
+
+// Threads in priority order, as a sparse set keyed by instruction offset so
+// each instruction is visited at most once per input position.
+typedef struct ThreadList ThreadList;
+struct ThreadList
+{
+	int n;
+	unsigned short *pcs;
+	const char **subs;	// nsubp capture pointers per thread
+};
+
+typedef struct PikeVM PikeVM;
+struct PikeVM
+{
+	ByteProg *prog;
+	Subject *input;
+	unsigned short *sparse;
+	int nsubp;
+};
+
+static void
+addthread(PikeVM *vm, ThreadList *l, int pc, const char *sp, const char **sub)
+{
+	const char *insts = vm->prog->insts;
+	const char *old;
+	unsigned idx = vm->sparse[pc];
+	int off;
+
+	re1_5_stack_chk();
+
+	if(idx < (unsigned)l->n && l->pcs[idx] == pc)
+		return;
+	idx = l->n++;
+	vm->sparse[pc] = idx;
+	l->pcs[idx] = pc;
+
+	switch(insts[pc]) {
+	case Jmp:
+		off = (signed char)insts[pc + 1];
+		addthread(vm, l, pc + 2 + off, sp, sub);
+		break;
+	case Split:
+		off = (signed char)insts[pc + 1];
+		addthread(vm, l, pc + 2, sp, sub);
+		addthread(vm, l, pc + 2 + off, sp, sub);
+		break;
+	case RSplit:
+		off = (signed char)insts[pc + 1];
+		addthread(vm, l, pc + 2 + off, sp, sub);
+		addthread(vm, l, pc + 2, sp, sub);
+		break;
+	case Save:
+		off = (unsigned char)insts[pc + 1];
+		if(off >= vm->nsubp) {
+			addthread(vm, l, pc + 2, sp, sub);
+			break;
+		}
+		old = sub[off];
+		sub[off] = sp;
+		addthread(vm, l, pc + 2, sp, sub);
+		sub[off] = old;
+		break;
+	case Bol:
+		if(sp == vm->input->begin)
+			addthread(vm, l, pc + 1, sp, sub);
+		break;
+	case Eol:
+		if(sp == vm->input->end)
+			addthread(vm, l, pc + 1, sp, sub);
+		break;
+	default:
+		// consumer or Match: the thread waits here for the next step
+		memcpy((char*)(l->subs + idx * vm->nsubp), sub, vm->nsubp * sizeof(*sub));
+		break;
+	}
+}
+
+int
+re1_5_pikevm(ByteProg *prog, Subject *input, const char **subp, int nsubp, int is_anchored)
+{
+	int cap = prog->len;
+	size_t subs_sz = (2 * cap + 1) * nsubp * sizeof(*subp);
+	size_t sz = subs_sz + (2 * cap + prog->bytelen) * sizeof(unsigned short);
+	char *mem = re1_5_alloc(sz);
+	ThreadList lists[2], *clist = &lists[0], *nlist = &lists[1], *t;
+	PikeVM vm = { prog, input, (unsigned short*)(mem + subs_sz) + 2 * cap, nsubp };
+	const char **sub = (const char**)mem;
+	const char *insts = prog->insts;
+	int start = HANDLE_ANCHORED(prog->insts, 1) - prog->insts;
+	const char *sp = input->begin;
+	char prefix[8];
+	int prefix_len = 0;
+	int matched = 0;
+	int i, pc;
+
+	lists[0].subs = sub + nsubp;
+	lists[1].subs = sub + (cap + 1) * nsubp;
+	lists[0].pcs = (unsigned short*)(mem + subs_sz);
+	lists[1].pcs = lists[0].pcs + cap;
+	lists[0].n = 0;
+	memset((char*)sub, 0, nsubp * sizeof(*sub));
+
+	// Literal chars at the start of the regex (after "Save 0") must begin
+	// every match, so a search can skip ahead to where they occur.
+	for(pc = start + 2; insts[pc] == Char && prefix_len < (int)sizeof(prefix); pc += 2)
+		prefix[prefix_len++] = insts[pc + 1];
+
+	for(;;) {
+		if(!matched && (!is_anchored || sp == input->begin)) {
+			if(clist->n == 0 && prefix_len > 0 && !is_anchored) {
+				// No thread is alive, so the next possible match start is
+				// the next occurrence of the prefix.
+				while(sp + prefix_len <= input->end
+					&& (sp = memchr(sp, prefix[0], input->end - sp)) != nil
+					&& sp + prefix_len <= input->end
+					&& memcmp(sp + 1, prefix + 1, prefix_len - 1) != 0)
+					sp++;
+				if(sp == nil || sp + prefix_len > input->end)
+					break;
+			}
+			addthread(&vm, clist, start, sp, sub);
+		}
+		if(clist->n == 0)
+			break;
+		nlist->n = 0;
+		for(i = 0; i < clist->n; i++) {
+			const char **tsub = clist->subs + i * nsubp;
+			pc = clist->pcs[i];
+			switch(insts[pc]) {
+			case Char:
+				if(sp < input->end && *sp == insts[pc + 1])
+					addthread(&vm, nlist, pc + 2, sp + 1, tsub);
+				break;
+			case Any:
+				if(sp < input->end)
+					addthread(&vm, nlist, pc + 1, sp + 1, tsub);
+				break;
+			case Class:
+			case ClassNot:
+				if(sp < input->end && _re1_5_classmatch(insts + pc + 1, sp))
+					addthread(&vm, nlist, pc + 2 + (unsigned char)insts[pc + 1] * 2, sp + 1, tsub);
+				break;
+			case NamedClass:
+				if(sp < input->end && _re1_5_namedclassmatch(insts + pc + 1, sp))
+					addthread(&vm, nlist, pc + 2, sp + 1, tsub);
+				break;
+			case Match:
+				// Threads after this one have lower priority: cut them off
+				matched = 1;
+				memcpy((char*)subp, tsub, nsubp * sizeof(*subp));
+				i = clist->n;
+				break;
+			}
+		}
+		t = clist;
+		clist = nlist;
+		nlist = t;
+		if(sp >= input->end)
+			break;
+		sp++;
+	}
+
+	re1_5_free(mem, sz);
+	return matched;
+}
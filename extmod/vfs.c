@@ -118,6 +118,156 @@ STATIC mp_obj_t mp_vfs_proxy_call(mp_vfs_mount_t *vfs, qstr meth_name, size_t n_
     return mp_call_method_n_kw(n_args, 0, meth);
 }
 
+#if MICROPY_VFS_IMPORT_CACHE
+
+// Import stats a directory, a .py and a .mpy candidate in every entry of
+// sys.path for every module, and on FAT each stat is a directory scan.  So
+// each directory searched is listed once and later stats in it are answered
+// from that listing.  The cache is dropped when a file is created or removed,
+// or the mount table or current directory changes.  It holds the listings of
+// the most recently searched directories, and a directory with a very long
+// listing, or one that can't be listed, is remembered as such and its paths
+// are stat'ed directly.
+#define IMPORT_CACHE_MAX_DIRS (8)
+#define IMPORT_CACHE_MAX_DIR_BYTES (1024)
+
+typedef struct _mp_vfs_import_dir_t {
+    struct _mp_vfs_import_dir_t *next;
+    mp_vfs_mount_t *vfs;
+    bool listed;
+    bool exists;
+    uint16_t path_len;
+    size_t entries_len;
+    // path of the directory within vfs, then per entry: type byte ('d' for a
+    // dir, 'f' for a file, '?' if unknown), length byte, name
+    char data[];
+} mp_vfs_import_dir_t;
+
+void mp_vfs_import_cache_invalidate(void) {
+    MP_STATE_VM(vfs_import_cache) = NULL;
+}
+
+STATIC mp_vfs_import_dir_t *import_cache_list_dir(mp_vfs_mount_t *vfs, const char *dir, size_t dir_len) {
+    vstr_t entries;
+    vstr_init(&entries, 64);
+    bool listed = true;
+    bool exists = true;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        // list the current dir of the vfs as "." since "" isn't portable
+        mp_obj_t dir_o = dir_len == 0 ? MP_OBJ_NEW_QSTR(MP_QSTR__dot_) : mp_obj_new_str(dir, dir_len);
+        mp_obj_t iter = mp_vfs_proxy_call(vfs, MP_QSTR_ilistdir, 1, &dir_o);
+        mp_obj_t next;
+        while ((next = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION) {
+            // entries are (name, type, inode) and may have more items after
+            size_t n_items;
+            mp_obj_t *items;
+            mp_obj_get_array(next, &n_items, &items);
+            if (n_items < 3 || entries.len > IMPORT_CACHE_MAX_DIR_BYTES) {
+                listed = false;
+                break;
+            }
+            size_t len;
+            const char *name = mp_obj_str_get_data(items[0], &len);
+            if (len > 255) {
+                continue;
+            }
+            mp_int_t mode = mp_obj_get_int(items[1]);
+            vstr_add_byte(&entries, mode == MP_S_IFDIR ? 'd' : mode == MP_S_IFREG ? 'f' : '?');
+            vstr_add_byte(&entries, len);
+            vstr_add_strn(&entries, name, len);
+        }
+        nlr_pop();
+    } else {
+        // Only a missing dir has a listing; on any other error stat directly
+        mp_obj_t exc = MP_OBJ_FROM_PTR(nlr.ret_val);
+        if (!mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(mp_obj_get_type(exc)), MP_OBJ_FROM_PTR(&mp_type_OSError))
+            || mp_obj_exception_get_value(exc) != MP_OBJ_NEW_SMALL_INT(MP_ENOENT)) {
+            listed = false;
+        }
+        exists = false;
+    }
+    if (!listed || !exists) {
+        entries.len = 0;
+    }
+
+    // drop the least recently listed directory if the cache is full
+    mp_vfs_import_dir_t **tail = &MP_STATE_VM(vfs_import_cache);
+    for (size_t n = 1; *tail != NULL; n++) {
+        if (n == IMPORT_CACHE_MAX_DIRS) {
+            *tail = NULL;
+            break;
+        }
+        tail = &(*tail)->next;
+    }
+
+    mp_vfs_import_dir_t *d = m_new_obj_var(mp_vfs_import_dir_t, char, dir_len + entries.len);
+    d->vfs = vfs;
+    d->listed = listed;
+    d->exists = exists;
+    d->path_len = dir_len;
+    d->entries_len = entries.len;
+    memcpy(d->data, dir, dir_len);
+    memcpy(d->data + dir_len, entries.buf, entries.len);
+    vstr_clear(&entries);
+    d->next = MP_STATE_VM(vfs_import_cache);
+    MP_STATE_VM(vfs_import_cache) = d;
+    return d;
+}
+
+// Returns -1 if the listing can't tell and the path must be stat'ed directly.
+STATIC int import_cache_stat(mp_vfs_mount_t *vfs, const char *path) {
+    const char *name = strrchr(path, '/');
+    size_t dir_len;
+    if (name == NULL) {
+        name = path;
+        dir_len = 0;
+    } else {
+        dir_len = name == path ? 1 : name - path;
+        name += 1;
+    }
+    size_t name_len = strlen(name);
+    if (name_len == 0 || name_len > 255 || dir_len > 0xffff) {
+        return -1;
+    }
+
+    mp_vfs_import_dir_t *d = MP_STATE_VM(vfs_import_cache);
+    while (d != NULL && !(d->vfs == vfs && d->path_len == dir_len && memcmp(d->data, path, dir_len) == 0)) {
+        d = d->next;
+    }
+    if (d == NULL) {
+        d = import_cache_list_dir(vfs, path, dir_len);
+    }
+    if (!d->listed) {
+        return -1;
+    }
+    if (!d->exists) {
+        return MP_IMPORT_STAT_NO_EXIST;
+    }
+
+    int st = MP_IMPORT_STAT_NO_EXIST;
+    for (const byte *e = (const byte*)d->data + dir_len, *top = e + d->entries_len; e < top; e += 2 + e[1]) {
+        if (e[1] != name_len) {
+            continue;
+        }
+        if (memcmp(e + 2, name, name_len) == 0) {
+            return e[0] == 'd' ? MP_IMPORT_STAT_DIR : e[0] == 'f' ? MP_IMPORT_STAT_FILE : -1;
+        }
+        // The filesystem may match names without regard to case (FAT does),
+        // so leave it to the filesystem to decide.
+        size_t i = 0;
+        while (i < name_len && unichar_tolower(e[2 + i]) == unichar_tolower((byte)name[i])) {
+            ++i;
+        }
+        if (i == name_len) {
+            st = -1;
+        }
+    }
+    return st;
+}
+
+#endif // MICROPY_VFS_IMPORT_CACHE
+
 mp_import_stat_t mp_vfs_import_stat(const char *path) {
     const char *path_out;
     mp_vfs_mount_t *vfs = mp_vfs_lookup_path(path, &path_out);
@@ -128,6 +278,16 @@ mp_import_stat_t mp_vfs_import_stat(const char *path) {
     // If the mounted object has the VFS protocol, call its import_stat helper
     const mp_vfs_proto_t *proto = mp_obj_get_type(vfs->obj)->protocol;
     if (proto != NULL) {
+        #if MICROPY_VFS_IMPORT_CACHE
+        // path_out is "/" if path is the mount point itself, which can't be
+        // found in a listing of its parent
+        if (!(path_out[0] == '/' && path_out[1] == '\0')) {
+            int st = import_cache_stat(vfs, path_out);
+            if (st >= 0) {
+                return st;
+            }
+        }
+        #endif
         return proto->import_stat(MP_OBJ_TO_PTR(vfs->obj), path_out);
     }
 
@@ -203,6 +363,7 @@ mp_obj_t mp_vfs_mount(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args
     }
 
     // insert the vfs into the mount table
+    mp_vfs_import_cache_invalidate();
     mp_vfs_mount_t **vfsp = &MP_STATE_VM(vfs_mount_table);
     while (*vfsp != NULL) {
         if ((*vfsp)->len == 1) {
@@ -237,6 +398,7 @@ mp_obj_t mp_vfs_umount(mp_obj_t mnt_in) {
     if (vfs == NULL) {
         mp_raise_OSError(MP_EINVAL);
     }
+    mp_vfs_import_cache_invalidate();
 
     // if we unmounted the current device then set current to root
     if (MP_STATE_VM(vfs_cur) == vfs) {
@@ -265,6 +427,12 @@ mp_obj_t mp_vfs_open(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args)
     mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
     mp_vfs_mount_t *vfs = lookup_path(args[ARG_file].u_obj, &args[ARG_file].u_obj);
+    #if MICROPY_VFS_IMPORT_CACHE
+    // any mode other than reading may create a file
+    if (strpbrk(mp_obj_str_get_str(args[ARG_mode].u_obj), "wax+") != NULL) {
+        mp_vfs_import_cache_invalidate();
+    }
+    #endif
     return mp_vfs_proxy_call(vfs, MP_QSTR_open, 2, (mp_obj_t*)&args);
 }
 MP_DEFINE_CONST_FUN_OBJ_KW(mp_vfs_open_obj, 0, mp_vfs_open);
@@ -272,6 +440,7 @@ MP_DEFINE_CONST_FUN_OBJ_KW(mp_vfs_open_obj, 0, mp_vfs_open);
 mp_obj_t mp_vfs_chdir(mp_obj_t path_in) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_path(path_in, &path_out);
+    mp_vfs_import_cache_invalidate();
     MP_STATE_VM(vfs_cur) = vfs;
     if (vfs == MP_VFS_ROOT) {
         // If we change to the root dir and a VFS is mounted at the root then
@@ -385,6 +554,7 @@ mp_obj_t mp_vfs_mkdir(mp_obj_t path_in) {
     if (vfs == MP_VFS_ROOT || (vfs != MP_VFS_NONE && !strcmp(mp_obj_str_get_str(path_out), "/"))) {
         mp_raise_OSError(MP_EEXIST);
     }
+    mp_vfs_import_cache_invalidate();
     return mp_vfs_proxy_call(vfs, MP_QSTR_mkdir, 1, &path_out);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mp_vfs_mkdir_obj, mp_vfs_mkdir);
@@ -392,6 +562,7 @@ MP_DEFINE_CONST_FUN_OBJ_1(mp_vfs_mkdir_obj, mp_vfs_mkdir);
 mp_obj_t mp_vfs_remove(mp_obj_t path_in) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_path(path_in, &path_out);
+    mp_vfs_import_cache_invalidate();
     return mp_vfs_proxy_call(vfs, MP_QSTR_remove, 1, &path_out);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mp_vfs_remove_obj, mp_vfs_remove);
@@ -404,6 +575,7 @@ mp_obj_t mp_vfs_rename(mp_obj_t old_path_in, mp_obj_t new_path_in) {
         // can't rename across filesystems
         mp_raise_OSError(MP_EPERM);
     }
+    mp_vfs_import_cache_invalidate();
     return mp_vfs_proxy_call(old_vfs, MP_QSTR_rename, 2, args);
 }
 MP_DEFINE_CONST_FUN_OBJ_2(mp_vfs_rename_obj, mp_vfs_rename);
@@ -411,6 +583,7 @@ MP_DEFINE_CONST_FUN_OBJ_2(mp_vfs_rename_obj, mp_vfs_rename);
 mp_obj_t mp_vfs_rmdir(mp_obj_t path_in) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_path(path_in, &path_out);
+    mp_vfs_import_cache_invalidate();
     return mp_vfs_proxy_call(vfs, MP_QSTR_rmdir, 1, &path_out);
 }
 MP_DEFINE_CONST_FUN_OBJ_1(mp_vfs_rmdir_obj, mp_vfs_rmdir);
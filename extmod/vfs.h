@@ -44,6 +44,7 @@
 #define BP_IOCTL_SYNC           (3)
 #define BP_IOCTL_SEC_COUNT      (4)
 #define BP_IOCTL_SEC_SIZE       (5)
+#define BP_IOCTL_MMAP_ADDR      (6) // address of block 0 if memory-mapped
 
 // At the moment the VFS protocol just has import_stat, but could be extended to other methods
 typedef struct _mp_vfs_proto_t {
@@ -72,6 +73,11 @@ mp_obj_t mp_vfs_ilistdir_it_iternext(mp_obj_t self_in);
 
 mp_vfs_mount_t *mp_vfs_lookup_path(const char *path, const char **path_out);
 mp_import_stat_t mp_vfs_import_stat(const char *path);
+#if MICROPY_VFS_IMPORT_CACHE
+void mp_vfs_import_cache_invalidate(void);
+#else
+#define mp_vfs_import_cache_invalidate()
+#endif
 mp_obj_t mp_vfs_mount(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
 mp_obj_t mp_vfs_umount(mp_obj_t mnt_in);
 mp_obj_t mp_vfs_open(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args);
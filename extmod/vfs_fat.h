@@ -58,6 +58,9 @@ typedef struct _fs_user_mount_t {
 typedef struct _pyb_file_obj_t {
     mp_obj_base_t base;
     FIL fp;
+    #if _USE_FASTSEEK
+    bool linkmap_tried;
+    #endif
 } pyb_file_obj_t;
 
 extern const byte fresult_to_errno_table[20];
@@ -67,6 +70,12 @@ extern const mp_obj_type_t mp_type_vfs_fat_textio;
 
 mp_import_stat_t fat_vfs_import_stat(void *vfs, const char *path);
 
+#if _USE_FASTSEEK
+void fat_file_create_linkmap(pyb_file_obj_t *self);
+#else
+#define fat_file_create_linkmap(self)
+#endif
+
 MP_DECLARE_CONST_FUN_OBJ_3(fat_vfs_open_obj);
 
 mp_obj_t fat_vfs_ilistdir2(struct _fs_user_mount_t *vfs, const char *path, bool is_str_type);
@@ -32,6 +32,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "py/mphal.h"
 
@@ -53,6 +54,82 @@ STATIC fs_user_mount_t *disk_get_device(void *bdev) {
     return (fs_user_mount_t*)bdev;
 }
 
+#if MICROPY_FATFS_CACHE_SECTORS
+
+// FatFs is built with _FS_TINY, so the FAT, directories and the data of all
+// open files share one sector window, and moving between them re-reads the
+// same sectors.  This keeps the most recently used sectors of native block
+// devices, and is written through so the device is always up to date.
+typedef struct _sector_cache_entry_t {
+    fs_user_mount_t *vfs; // NULL if the entry is unused
+    DWORD sector;
+    uint32_t last_use;
+    BYTE buf[_MAX_SS];
+} sector_cache_entry_t;
+
+STATIC sector_cache_entry_t sector_cache[MICROPY_FATFS_CACHE_SECTORS];
+STATIC uint32_t sector_cache_clock;
+
+// Return the entry holding sector, or if there is none the least recently
+// used entry, which the caller may refill.
+STATIC sector_cache_entry_t *sector_cache_lookup(fs_user_mount_t *vfs, DWORD sector) {
+    sector_cache_entry_t *lru = &sector_cache[0];
+    for (size_t i = 0; i < MICROPY_FATFS_CACHE_SECTORS; ++i) {
+        sector_cache_entry_t *e = &sector_cache[i];
+        if (e->vfs == vfs && e->sector == sector) {
+            return e;
+        }
+        if (e->vfs == NULL || (lru->vfs != NULL && e->last_use < lru->last_use)) {
+            lru = e;
+        }
+    }
+    return lru;
+}
+
+STATIC bool sector_cache_read(fs_user_mount_t *vfs, BYTE *buff, DWORD sector) {
+    sector_cache_entry_t *e = sector_cache_lookup(vfs, sector);
+    if (e->vfs != vfs || e->sector != sector) {
+        return false;
+    }
+    memcpy(buff, e->buf, SECSIZE(&vfs->fatfs));
+    e->last_use = ++sector_cache_clock;
+    return true;
+}
+
+STATIC void sector_cache_fill(fs_user_mount_t *vfs, const BYTE *buff, DWORD sector) {
+    sector_cache_entry_t *e = sector_cache_lookup(vfs, sector);
+    memcpy(e->buf, buff, SECSIZE(&vfs->fatfs));
+    e->vfs = vfs;
+    e->sector = sector;
+    e->last_use = ++sector_cache_clock;
+}
+
+// Update any cached copies of the count sectors just written from buff, or
+// if buff is NULL forget them.
+STATIC void sector_cache_write(fs_user_mount_t *vfs, const BYTE *buff, DWORD sector, UINT count) {
+    for (size_t i = 0; i < MICROPY_FATFS_CACHE_SECTORS; ++i) {
+        sector_cache_entry_t *e = &sector_cache[i];
+        if (e->vfs == vfs && e->sector - sector < count) {
+            if (buff == NULL) {
+                e->vfs = NULL;
+            } else {
+                memcpy(e->buf, buff + (e->sector - sector) * SECSIZE(&vfs->fatfs), SECSIZE(&vfs->fatfs));
+                e->last_use = ++sector_cache_clock;
+            }
+        }
+    }
+}
+
+STATIC void sector_cache_invalidate(fs_user_mount_t *vfs) {
+    for (size_t i = 0; i < MICROPY_FATFS_CACHE_SECTORS; ++i) {
+        if (sector_cache[i].vfs == vfs) {
+            sector_cache[i].vfs = NULL;
+        }
+    }
+}
+
+#endif
+
 /*-----------------------------------------------------------------------*/
 /* Read Sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
@@ -70,10 +147,22 @@ DRESULT disk_read (
     }
 
     if (vfs->flags & FSUSER_NATIVE) {
+        #if MICROPY_FATFS_CACHE_SECTORS
+        if (count == 1 && sector_cache_read(vfs, buff, sector)) {
+            return RES_OK;
+        }
+        #endif
         mp_uint_t (*f)(uint8_t*, uint32_t, uint32_t) = (void*)(uintptr_t)vfs->readblocks[2];
         if (f(buff, sector, count) != 0) {
             return RES_ERROR;
         }
+        #if MICROPY_FATFS_CACHE_SECTORS
+        // Multi-sector reads are file data going straight to the caller's
+        // buffer, which would only push useful sectors out of the cache.
+        if (count == 1) {
+            sector_cache_fill(vfs, buff, sector);
+        }
+        #endif
     } else {
         mp_obj_array_t ar = {{&mp_type_bytearray}, BYTEARRAY_TYPECODE, 0, count * SECSIZE(&vfs->fatfs), buff};
         vfs->readblocks[2] = MP_OBJ_NEW_SMALL_INT(sector);
@@ -118,8 +207,20 @@ DRESULT disk_write (
     if (vfs->flags & FSUSER_NATIVE) {
         mp_uint_t (*f)(const uint8_t*, uint32_t, uint32_t) = (void*)(uintptr_t)vfs->writeblocks[2];
         if (f(buff, sector, count) != 0) {
+            #if MICROPY_FATFS_CACHE_SECTORS
+            // the device may hold the old data, the new data or neither
+            sector_cache_write(vfs, NULL, sector, count);
+            #endif
             return RES_ERROR;
         }
+        #if MICROPY_FATFS_CACHE_SECTORS
+        if (count == 1) {
+            // mostly FAT and directory sectors, which are likely read again
+            sector_cache_fill(vfs, buff, sector);
+        } else {
+            sector_cache_write(vfs, buff, sector, count);
+        }
+        #endif
     } else {
         mp_obj_array_t ar = {{&mp_type_bytearray}, BYTEARRAY_TYPECODE, 0, count * SECSIZE(&vfs->fatfs), (void*)buff};
         vfs->writeblocks[2] = MP_OBJ_NEW_SMALL_INT(sector);
@@ -165,6 +266,7 @@ DRESULT disk_ioctl (
             [GET_SECTOR_COUNT] = BP_IOCTL_SEC_COUNT,
             [GET_SECTOR_SIZE] = BP_IOCTL_SEC_SIZE,
             [IOCTL_INIT] = BP_IOCTL_INIT,
+            [IOCTL_MMAP_ADDR] = BP_IOCTL_MMAP_ADDR,
         };
         uint8_t bp_op = op_map[cmd & 7];
         if (bp_op != 0) {
@@ -192,6 +294,10 @@ DRESULT disk_ioctl (
             case IOCTL_INIT:
                 // old protocol doesn't have init
                 break;
+
+            case IOCTL_MMAP_ADDR:
+                // old protocol doesn't map the device into memory
+                break;
         }
     }
 
@@ -225,6 +331,12 @@ DRESULT disk_ioctl (
 
         case IOCTL_INIT:
         case IOCTL_STATUS: {
+            #if MICROPY_FATFS_CACHE_SECTORS
+            // A newly mounted device may reuse the address of an old one.
+            if (cmd == IOCTL_INIT) {
+                sector_cache_invalidate(vfs);
+            }
+            #endif
             DSTATUS stat;
             if (ret != mp_const_none && MP_OBJ_SMALL_INT_VALUE(ret) != 0) {
                 // error initialising
@@ -238,6 +350,14 @@ DRESULT disk_ioctl (
             return RES_OK;
         }
 
+        case IOCTL_MMAP_ADDR:
+            if (ret == mp_const_none) {
+                *((BYTE**)buff) = NULL;
+            } else {
+                *((BYTE**)buff) = (BYTE*)(uintptr_t)mp_obj_int_get_truncated(ret);
+            }
+            return RES_OK;
+
         default:
             return RES_PARERR;
     }
@@ -33,8 +33,50 @@
 #include "py/stream.h"
 #include "py/mperrno.h"
 #include "lib/oofatfs/ff.h"
+#include "lib/oofatfs/diskio.h"
 #include "extmod/vfs_fat.h"
 
+#if _USE_FASTSEEK
+
+// Files with more fragments than this seek by following the FAT chain.
+#define LINKMAP_MAX_FRAGMENTS (32)
+
+// The first time a file that is only read seeks, try to build its cluster
+// link map.  From then on seeking and reading across clusters find the
+// cluster in the map instead of walking the chain through the FAT.
+void fat_file_create_linkmap(pyb_file_obj_t *self) {
+    if (self->linkmap_tried || (self->fp.flag & FA_WRITE) || self->fp.obj.sclust == 0) {
+        return;
+    }
+    self->linkmap_tried = true;
+
+    // The map is its size, a (length, first cluster) pair per fragment and a
+    // terminating 0.  Most files are in one or two fragments; if there are
+    // more, FatFs reports the size needed.
+    size_t len = 2 * 2 + 2;
+    for (int i = 0; i < 2; ++i) {
+        DWORD *tbl = m_new_maybe(DWORD, len);
+        if (tbl == NULL) {
+            return;
+        }
+        tbl[0] = len;
+        self->fp.cltbl = tbl;
+        FRESULT res = f_lseek(&self->fp, CREATE_LINKMAP);
+        if (res == FR_OK) {
+            return;
+        }
+        size_t needed = tbl[0];
+        self->fp.cltbl = NULL;
+        m_del(DWORD, tbl, len);
+        if (res != FR_NOT_ENOUGH_CORE || needed > 2 * LINKMAP_MAX_FRAGMENTS + 2) {
+            return;
+        }
+        len = needed;
+    }
+}
+
+#endif
+
 // this table converts from FRESULT to POSIX errno
 const byte fresult_to_errno_table[20] = {
     [FR_OK] = 0,
@@ -98,12 +140,87 @@ STATIC mp_obj_t file_obj___exit__(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(file_obj___exit___obj, 4, 4, file_obj___exit__);
 
+// A file can be used in place if its block device is mapped into memory and
+// the requested part of it is in consecutive clusters.  Returns 0 or an errno.
+STATIC int file_obj_mmap(pyb_file_obj_t *self, struct mp_stream_mmap_t *map) {
+    FIL *fp = &self->fp;
+    FATFS *fs = fp->obj.fs;
+    if (fs == NULL) {
+        return MP_EBADF;
+    }
+    if (map->write) {
+        // writes must go through FatFs to keep the filesystem consistent
+        return MP_EACCES;
+    }
+    BYTE *base;
+    if (disk_ioctl(fs->drv, IOCTL_MMAP_ADDR, &base) != RES_OK || base == NULL) {
+        return MP_ENODEV;
+    }
+    FSIZE_t size = f_size(fp);
+    FSIZE_t offset = map->offset;
+    if (offset >= size) {
+        return MP_EINVAL;
+    }
+    if (map->len == 0) {
+        map->len = size - offset;
+    } else if (map->len > size - offset) {
+        return MP_EINVAL;
+    }
+    if (fp->flag & FA_WRITE) {
+        // put any data held by the file on the device (the sector cache is
+        // written through, so it holds nothing that isn't there already)
+        FRESULT res = f_sync(fp);
+        if (res != FR_OK) {
+            return fresult_to_errno_table[res];
+        }
+    }
+
+    #if _MAX_SS == _MIN_SS
+    FSIZE_t ss = _MAX_SS;
+    #else
+    FSIZE_t ss = fs->ssize;
+    #endif
+    FSIZE_t bcs = fs->csize * ss;
+    FSIZE_t start = offset / bcs * bcs;
+    FSIZE_t end = offset + map->len;
+
+    // Seeking to ofs leaves fp->clust at the cluster holding byte ofs - 1,
+    // so follow the chain and check that each cluster comes straight after
+    // the one before.
+    FSIZE_t fptr = f_tell(fp);
+    FRESULT res = f_lseek(fp, offset + 1);
+    DWORD clst = fp->clust;
+    int ret = 0;
+    for (FSIZE_t ofs = start + bcs; res == FR_OK && ofs < end; ofs += bcs) {
+        res = f_lseek(fp, ofs + 1);
+        if (fp->clust != clst + (ofs - start) / bcs) {
+            ret = MP_ENODEV;
+            break;
+        }
+    }
+    if (res != FR_OK) {
+        ret = fresult_to_errno_table[res];
+    }
+    f_lseek(fp, fptr);
+    if (ret != 0) {
+        return ret;
+    }
+
+    map->addr = base + (fs->database + (clst - 2) * fs->csize) * ss + (offset - start);
+    return 0;
+}
+
 STATIC mp_uint_t file_obj_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg, int *errcode) {
     pyb_file_obj_t *self = MP_OBJ_TO_PTR(o_in);
 
     if (request == MP_STREAM_SEEK) {
         struct mp_stream_seek_t *s = (struct mp_stream_seek_t*)(uintptr_t)arg;
 
+        // tell() is a seek by 0, which needs no link map
+        if (s->offset != 0 || s->whence != 1) {
+            fat_file_create_linkmap(self);
+        }
+
         switch (s->whence) {
             case 0: // SEEK_SET
                 f_lseek(&self->fp, s->offset);
@@ -140,6 +257,14 @@ STATIC mp_uint_t file_obj_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg,
         }
         return 0;
 
+    } else if (request == MP_STREAM_MMAP) {
+        int err = file_obj_mmap(self, (struct mp_stream_mmap_t*)(uintptr_t)arg);
+        if (err != 0) {
+            *errcode = err;
+            return MP_STREAM_ERROR;
+        }
+        return 0;
+
     } else {
         *errcode = MP_EINVAL;
         return MP_STREAM_ERROR;
@@ -189,6 +314,9 @@ STATIC mp_obj_t file_open(fs_user_mount_t *vfs, const mp_obj_type_t *type, mp_ar
 
     pyb_file_obj_t *o = m_new_obj_with_finaliser(pyb_file_obj_t);
     o->base.type = type;
+    #if _USE_FASTSEEK
+    o->linkmap_tried = false;
+    #endif
 
     const char *fname = mp_obj_str_get_str(args[0].u_obj);
     assert(vfs != NULL);
@@ -54,6 +54,7 @@ DRESULT disk_ioctl (void *drv, BYTE cmd, void* buff);
 #define CTRL_TRIM           4   /* Inform device that the data on the block of sectors is no longer used (needed at _USE_TRIM == 1) */
 #define IOCTL_INIT          5
 #define IOCTL_STATUS        6
+#define IOCTL_MMAP_ADDR     7
 
 /* Generic command (Not used by FatFs) */
 #define CTRL_POWER          5   /* Get/Set power status */
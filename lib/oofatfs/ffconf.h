@@ -74,7 +74,11 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
+#ifdef MICROPY_FATFS_USE_FASTSEEK
+#define _USE_FASTSEEK   (MICROPY_FATFS_USE_FASTSEEK)
+#else
 #define _USE_FASTSEEK   0
+#endif
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
@@ -163,6 +163,7 @@ typedef long mp_off_t;
 #define MICROPY_PY_IO                               (0)
 #define MICROPY_PY_REVERSE_SPECIAL_METHODS          (0)
 #define MICROPY_PY_SYS_EXC_INFO                     (0)
+#define MICROPY_COMP_INCREMENTAL                    (1)
 #define MICROPY_PY_UERRNO_LIST \
     X(EPERM) \
     X(ENOENT) \
@@ -191,6 +192,17 @@ typedef long mp_off_t;
 #define MICROPY_PY_IO                               (1)
 #define MICROPY_PY_REVERSE_SPECIAL_METHODS          (1)
 #define MICROPY_PY_SYS_EXC_INFO                     (1)
+#define MICROPY_OPT_FAST_STR_SEARCH                 (1)
+#define MICROPY_PY_URE_PIKEVM                       (1)
+#define MICROPY_PY_URE_CACHE_SIZE                   (4)
+#define MICROPY_VFS_IMPORT_CACHE                    (1)
+#define MICROPY_FATFS_CACHE_SECTORS                 (4)
+#define MICROPY_FATFS_USE_FASTSEEK                  (1)
+#define CIRCUITPY_USB_MSC_QUEUE_BLOCKS              (8)
+#define MICROPY_PERSISTENT_CODE_SAVE                (1)
+#define MICROPY_PERSISTENT_CODE_CACHE               (1)
+#define MICROPY_PY_UARRAYOPS                        (1)
+#define MICROPY_PY_UEVLOOP                          (1)
 //      MICROPY_PY_UERRNO_LIST - Use the default
 #endif
 
@@ -61,7 +61,11 @@ void mp_hal_delay_ms(mp_uint_t delay) {
             break;
         }
         duration = (ticks_ms - start_tick);
-        // TODO(tannewt): Go to sleep for a little while while we wait.
+        if (duration < delay) {
+            // Sleep until the next tick, or until USB or another interrupt
+            // needs the background tasks to run.
+            __WFI();
+        }
     }
 }
 
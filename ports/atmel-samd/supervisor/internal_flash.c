@@ -73,6 +73,10 @@ uint32_t supervisor_flash_get_block_count(void) {
     return INTERNAL_FLASH_PART1_NUM_BLOCKS;
 }
 
+const uint8_t *supervisor_flash_get_mmap_base(void) {
+    return (const uint8_t*)INTERNAL_FLASH_MEM_SEG1_START_ADDR;
+}
+
 void supervisor_flash_flush(void) {
 }
 
@@ -28,6 +28,7 @@
 
 #include "peripheral_clk_config.h"
 
+#include "py/profile.h"
 #include "supervisor/shared/autoreload.h"
 #include "shared-module/gamepad/__init__.h"
 #include "shared-bindings/microcontroller/__init__.h"
@@ -54,6 +55,9 @@ void SysTick_Handler(void) {
         gamepad_tick();
     }
     #endif
+    #if MICROPY_PY_MICROPYTHON_PROFILE
+    mp_prof_tick();
+    #endif
 }
 
 void tick_init() {
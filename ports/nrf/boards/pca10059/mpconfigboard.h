@@ -29,4 +29,7 @@
 #define MICROPY_PY_SYS_PLATFORM     "nRF52840-DK"
 
 #define PORT_HEAP_SIZE              (128 * 1024)
+
+// The filesystem is in internal flash, so files can be mapped in place.
+#define MICROPY_PY_UMMAP            (1)
 #define CIRCUITPY_AUTORELOAD_DELAY_MS 500
@@ -70,6 +70,10 @@ uint32_t supervisor_flash_get_block_count(void) {
     return ((uint32_t) __fatfs_flash_length) / FILESYSTEM_BLOCK_SIZE ;
 }
 
+const uint8_t *supervisor_flash_get_mmap_base(void) {
+    return (const uint8_t*)lba2addr(0);
+}
+
 // TODO support flashing with SD enabled
 void supervisor_flash_flush(void) {
     if (_flash_page_addr == NO_CACHE) return;
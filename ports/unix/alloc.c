@@ -33,12 +33,29 @@
 #include "py/mpstate.h"
 #include "py/gc.h"
 
-#if MICROPY_EMIT_NATIVE || (MICROPY_PY_FFI && MICROPY_FORCE_PLAT_ALLOC_EXEC)
-
 #if defined(__OpenBSD__) || defined(__MACH__)
 #define MAP_ANONYMOUS MAP_ANON
 #endif
 
+#if MICROPY_GC_STACK_GROW
+// The GC stack may need to grow while a thread scans its own stack in a
+// signal handler, so it is taken straight from the system rather than with
+// malloc, which isn't safe to call there.
+void *mp_unix_alloc_gc_stack(size_t n_bytes) {
+    void *ptr = mmap(NULL, n_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+    return ptr;
+}
+
+void mp_unix_free_gc_stack(void *ptr, size_t n_bytes) {
+    munmap(ptr, n_bytes);
+}
+#endif
+
+#if MICROPY_EMIT_NATIVE || (MICROPY_PY_FFI && MICROPY_FORCE_PLAT_ALLOC_EXEC)
+
 // The memory allocated here is not on the GC heap (and it may contain pointers
 // that need to be GC'd) so we must somehow trace this memory.  We do it by
 // keeping a linked list of all mmap'd regions, and tracing them explicitly.
@@ -13,6 +13,7 @@
 #include "py/stream.h"
 #include "py/binary.h"
 #include "py/bc.h"
+#include "extmod/vfs_fat.h"
 
 #if defined(MICROPY_UNIX_COVERAGE)
 
@@ -138,6 +139,45 @@ STATIC const mp_obj_type_t mp_type_stest_textio2 = {
 STATIC const mp_obj_str_t str_no_hash_obj = {{&mp_type_str}, 0, 10, (const byte*)"0123456789"};
 STATIC const mp_obj_str_t bytes_no_hash_obj = {{&mp_type_bytes}, 0, 10, (const byte*)"0123456789"};
 
+#if MICROPY_VFS_FAT && MICROPY_FATFS_CACHE_SECTORS
+// A RAM disk that the FAT driver calls natively, as it does flash, so that
+// the sector cache is used.  It counts the blocks read and written.
+STATIC uint8_t *native_ramdisk_data;
+STATIC mp_uint_t native_ramdisk_reads;
+STATIC mp_uint_t native_ramdisk_writes;
+
+STATIC mp_uint_t native_ramdisk_read_blocks(uint8_t *dest, uint32_t block_num, uint32_t num_blocks) {
+    memcpy(dest, native_ramdisk_data + block_num * 512, num_blocks * 512);
+    native_ramdisk_reads += num_blocks;
+    return 0;
+}
+
+STATIC mp_uint_t native_ramdisk_write_blocks(const uint8_t *src, uint32_t block_num, uint32_t num_blocks) {
+    memcpy(native_ramdisk_data + block_num * 512, src, num_blocks * 512);
+    native_ramdisk_writes += num_blocks;
+    return 0;
+}
+
+// native_ramdisk([vfs, buf]): make vfs reach its blocks in buf natively, then
+// return the number of blocks read and written since.
+STATIC mp_obj_t native_ramdisk(size_t n_args, const mp_obj_t *args) {
+    if (n_args == 2) {
+        fs_user_mount_t *vfs = MP_OBJ_TO_PTR(args[0]);
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_RW);
+        native_ramdisk_data = bufinfo.buf;
+        native_ramdisk_reads = 0;
+        native_ramdisk_writes = 0;
+        vfs->flags |= FSUSER_NATIVE;
+        vfs->readblocks[2] = (mp_obj_t)native_ramdisk_read_blocks;
+        vfs->writeblocks[2] = (mp_obj_t)native_ramdisk_write_blocks;
+    }
+    mp_obj_t items[] = {MP_OBJ_NEW_SMALL_INT(native_ramdisk_reads), MP_OBJ_NEW_SMALL_INT(native_ramdisk_writes)};
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(items), items);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(native_ramdisk_obj, 0, 2, native_ramdisk);
+#endif
+
 // function to run extra tests for things that can't be checked by scripts
 STATIC mp_obj_t extra_coverage(void) {
     // mp_printf (used by ports that don't have a native printf)
@@ -377,11 +417,21 @@ STATIC mp_obj_t extra_coverage(void) {
         mp_printf(&mp_plat_print, "# VM\n");
 
         // call mp_execute_bytecode with invalide bytecode (should raise NotImplementedError)
-        mp_obj_fun_bc_t fun_bc;
-        fun_bc.bytecode = (const byte*)"\x01"; // just needed for n_state
+        // the prelude is valid so that the traceback and allocation site can find a line
+        static const byte bytecode[] = {
+            0x01, 0x00, 0x00, 0x00, 0x00, 0x00, // n_state, n_exc_stack, scope and arg counts
+            #if MICROPY_PERSISTENT_CODE
+            0x06, 0x00, 0x00, 0x00, 0x00, 0x00, // code info size, block name, source file, end of line info
+            #else
+            0x04, 0x00, 0x00, 0x00,
+            #endif
+            0x00, // just needed for an invalid opcode
+        };
+        mp_obj_fun_bc_t fun_bc = { 0 };
+        fun_bc.bytecode = bytecode;
         mp_code_state_t *code_state = m_new_obj_var(mp_code_state_t, mp_obj_t, 1);
         code_state->fun_bc = &fun_bc;
-        code_state->ip = (const byte*)"\x00"; // just needed for an invalid opcode
+        code_state->ip = &bytecode[sizeof(bytecode) - 1];
         code_state->sp = &code_state->state[0];
         code_state->exc_sp = NULL;
         code_state->old_globals = NULL;
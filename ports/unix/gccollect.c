@@ -170,6 +170,11 @@ void gc_collect(void) {
     #if MICROPY_EMIT_NATIVE
     mp_unix_mark_exec();
     #endif
+    #if MICROPY_PY_THREAD
+    // let the other threads go before the sweep runs any finalisers
+    gc_collect_mark_end();
+    mp_thread_gc_others_resume();
+    #endif
     gc_collect_end();
 
     //printf("-----\n");
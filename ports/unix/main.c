@@ -36,6 +36,7 @@
 #include <sys/types.h>
 #include <errno.h>
 #include <signal.h>
+#include <fcntl.h>
 
 #include "py/compile.h"
 #include "py/frozenmod.h"
@@ -46,6 +47,7 @@
 #include "py/stackctrl.h"
 #include "py/mphal.h"
 #include "py/mpthread.h"
+#include "py/persistentcode.h"
 #include "extmod/misc.h"
 #include "extmod/vfs.h"
 #include "extmod/vfs_posix.h"
@@ -520,6 +522,10 @@ MP_NOINLINE int main_(int argc, char **argv) {
     {
         MP_DECLARE_CONST_FUN_OBJ_0(extra_coverage_obj);
         mp_store_global(QSTR_FROM_STR_STATIC("extra_coverage"), MP_OBJ_FROM_PTR(&extra_coverage_obj));
+        #if MICROPY_VFS_FAT && MICROPY_FATFS_CACHE_SECTORS
+        MP_DECLARE_CONST_FUN_OBJ_VAR_BETWEEN(native_ramdisk_obj);
+        mp_store_global(QSTR_FROM_STR_STATIC("native_ramdisk"), MP_OBJ_FROM_PTR(&native_ramdisk_obj));
+        #endif
     }
     #endif
 
@@ -685,6 +691,67 @@ uint mp_import_stat(const char *path) {
 }
 #endif
 
+#if MICROPY_PERSISTENT_CODE_XIP
+#include <sys/mman.h>
+
+// .mpy files are mapped read-only and their bytecode executes in place.  The
+// mapping belongs to a small heap object which every function loaded from
+// the file keeps alive, and whose finaliser unmaps it.  As with a shared
+// library, the file must not be truncated or rewritten in place while it is
+// in use: install a new version by renaming it over the old one.
+typedef struct _mpy_mapping_obj_t {
+    mp_obj_base_t base;
+    void *addr;
+    size_t len;
+} mpy_mapping_obj_t;
+
+STATIC mp_obj_t mpy_mapping_del(mp_obj_t self_in) {
+    mpy_mapping_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->len != 0) {
+        munmap(self->addr, self->len);
+        self->len = 0;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mpy_mapping_del_obj, mpy_mapping_del);
+
+STATIC const mp_rom_map_elem_t mpy_mapping_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&mpy_mapping_del_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(mpy_mapping_locals_dict, mpy_mapping_locals_dict_table);
+
+STATIC const mp_obj_type_t mpy_mapping_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_mpy_mapping,
+    .locals_dict = (mp_obj_dict_t*)&mpy_mapping_locals_dict,
+};
+
+const byte *mp_raw_code_map_file(const char *filename, size_t *len, void **owner) {
+    // the owner is allocated first, so a MemoryError can't leak the mapping
+    mpy_mapping_obj_t *o = m_new_obj_with_finaliser(mpy_mapping_obj_t);
+    o->base.type = &mpy_mapping_type;
+    o->len = 0;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    void *buf = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (buf == MAP_FAILED) {
+        return NULL;
+    }
+    o->addr = buf;
+    o->len = st.st_size;
+    *len = st.st_size;
+    *owner = o;
+    return buf;
+}
+#endif
+
 void nlr_jump_fail(void *val) {
     printf("FATAL: uncaught NLR %p\n", val);
     exit(1);
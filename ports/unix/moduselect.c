@@ -32,11 +32,17 @@
 #include <stdio.h>
 #include <errno.h>
 #include <poll.h>
+#if MICROPY_PY_USELECT_EPOLL
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
 
 #include "py/runtime.h"
 #include "py/obj.h"
 #include "py/objlist.h"
 #include "py/objtuple.h"
+#include "py/mperrno.h"
 #include "py/mphal.h"
 #include "fdfile.h"
 
@@ -49,21 +55,6 @@ extern const mp_obj_type_t mp_type_socket;
 // Flags for poll()
 #define FLAG_ONESHOT (1)
 
-/// \class Poll - poll class
-
-typedef struct _mp_obj_poll_t {
-    mp_obj_base_t base;
-    unsigned short alloc;
-    unsigned short len;
-    struct pollfd *entries;
-    mp_obj_t *obj_map;
-    short iter_cnt;
-    short iter_idx;
-    int flags;
-    // callee-owned tuple
-    mp_obj_t ret_tuple;
-} mp_obj_poll_t;
-
 STATIC int get_fd(mp_obj_t fdlike) {
     int fd;
     // Shortcut for fdfile compatible types
@@ -80,6 +71,298 @@ STATIC int get_fd(mp_obj_t fdlike) {
     return fd;
 }
 
+#if MICROPY_PY_USELECT_EPOLL
+
+// Registrations are kept by the kernel in an epoll instance, so a call to
+// poll() or ipoll() only costs in proportion to the number of objects that
+// are ready, not to the number registered.
+
+// Flag for register() and modify() to report an object only when it becomes
+// ready rather than for as long as it is ready; EPOLLET itself doesn't fit in
+// a small int on 32-bit builds.
+#define MP_POLLET (1 << 24)
+
+typedef struct _poll_entry_t {
+    mp_obj_t obj; // the registered object, MP_OBJ_NULL if the fd isn't registered
+    mp_uint_t events;
+    // epoll can't watch regular files, which poll() always reports as ready
+    bool always_ready;
+} poll_entry_t;
+
+typedef struct _mp_obj_poll_t {
+    mp_obj_base_t base;
+    int epfd;
+    size_t n_entries;
+    size_t n_always_ready;
+    // entries are indexed by fd
+    size_t entries_alloc;
+    poll_entry_t *entries;
+    // filled by epoll_wait, big enough for every registered fd to be ready
+    size_t ready_alloc;
+    struct epoll_event *ready;
+    int iter_cnt;
+    int iter_idx;
+    int flags;
+    // callee-owned tuple
+    mp_obj_t ret_tuple;
+} mp_obj_poll_t;
+
+STATIC int poll_ctl(mp_obj_poll_t *self, int op, int fd, mp_uint_t events) {
+    struct epoll_event ev;
+    ev.events = (events & ~MP_POLLET) | (events & MP_POLLET ? EPOLLET : 0);
+    ev.data.fd = fd;
+    return epoll_ctl(self->epfd, op, fd, &ev);
+}
+
+STATIC poll_entry_t *poll_lookup(mp_obj_poll_t *self, mp_obj_t obj) {
+    int fd = get_fd(obj);
+    if (fd < 0 || (size_t)fd >= self->entries_alloc || self->entries[fd].obj == MP_OBJ_NULL) {
+        return NULL;
+    }
+    return &self->entries[fd];
+}
+
+/// \method register(obj[, eventmask])
+STATIC mp_obj_t poll_register(size_t n_args, const mp_obj_t *args) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
+    int fd = get_fd(args[1]);
+
+    mp_uint_t flags;
+    if (n_args == 3) {
+        flags = mp_obj_get_int(args[2]);
+    } else {
+        flags = POLLIN | POLLOUT;
+    }
+
+    if (fd < 0) {
+        mp_raise_OSError(MP_EBADF);
+    }
+
+    // make room first, so that nothing is left half done if this fails
+    if ((size_t)fd >= self->entries_alloc) {
+        size_t alloc = self->entries_alloc * 2;
+        if (alloc <= (size_t)fd) {
+            alloc = fd + 1;
+        }
+        self->entries = m_renew(poll_entry_t, self->entries, self->entries_alloc, alloc);
+        memset(self->entries + self->entries_alloc, 0, (alloc - self->entries_alloc) * sizeof(poll_entry_t));
+        self->entries_alloc = alloc;
+    }
+    if (self->n_entries >= self->ready_alloc) {
+        size_t alloc = self->ready_alloc * 2;
+        self->ready = m_renew(struct epoll_event, self->ready, self->ready_alloc, alloc);
+        self->ready_alloc = alloc;
+    }
+
+    poll_entry_t *entry = &self->entries[fd];
+    bool is_new = entry->obj == MP_OBJ_NULL;
+    if (!entry->always_ready) {
+        int ret = -1;
+        if (!is_new) {
+            ret = poll_ctl(self, EPOLL_CTL_MOD, fd, flags);
+        }
+        // the fd may have been closed and reused since it was registered
+        if (is_new || (ret == -1 && errno == ENOENT)) {
+            ret = poll_ctl(self, EPOLL_CTL_ADD, fd, flags);
+        }
+        if (ret == -1 && errno == EPERM) {
+            entry->always_ready = true;
+            self->n_always_ready += 1;
+        } else {
+            RAISE_ERRNO(ret, errno);
+        }
+    }
+
+    if (is_new) {
+        self->n_entries += 1;
+    }
+    entry->obj = args[1];
+    entry->events = flags;
+    return mp_obj_new_bool(is_new);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_register_obj, 2, 3, poll_register);
+
+/// \method unregister(obj)
+STATIC mp_obj_t poll_unregister(mp_obj_t self_in, mp_obj_t obj_in) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
+    poll_entry_t *entry = poll_lookup(self, obj_in);
+    if (entry != NULL) {
+        if (entry->always_ready) {
+            entry->always_ready = false;
+            self->n_always_ready -= 1;
+        } else {
+            // this fails harmlessly if the fd was already closed
+            poll_ctl(self, EPOLL_CTL_DEL, entry - self->entries, 0);
+        }
+        entry->obj = MP_OBJ_NULL;
+        self->n_entries -= 1;
+    }
+
+    // TODO raise KeyError if obj didn't exist in map
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_2(poll_unregister_obj, poll_unregister);
+
+/// \method modify(obj, eventmask)
+STATIC mp_obj_t poll_modify(mp_obj_t self_in, mp_obj_t obj_in, mp_obj_t eventmask_in) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
+    poll_entry_t *entry = poll_lookup(self, obj_in);
+    if (entry != NULL) {
+        entry->events = mp_obj_get_int(eventmask_in);
+        if (!entry->always_ready) {
+            poll_ctl(self, EPOLL_CTL_MOD, entry - self->entries, entry->events);
+        }
+    }
+
+    // TODO raise KeyError if obj didn't exist in map
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_3(poll_modify_obj, poll_modify);
+
+STATIC int poll_poll_internal(size_t n_args, const mp_obj_t *args) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    // work out timeout (it's given already in ms)
+    int timeout = -1;
+    int flags = 0;
+    if (n_args >= 2) {
+        if (args[1] != mp_const_none) {
+            mp_int_t timeout_i = mp_obj_get_int(args[1]);
+            if (timeout_i >= 0) {
+                timeout = timeout_i;
+            }
+        }
+        if (n_args >= 3) {
+            flags = mp_obj_get_int(args[2]);
+        }
+    }
+
+    self->flags = flags;
+
+    // leave room at the end of the buffer for the fds that are always ready
+    size_t n_always_ready = self->n_always_ready;
+    if (n_always_ready > 0) {
+        timeout = 0;
+    }
+    int n_ready = 0;
+    if (self->n_entries > n_always_ready) {
+        n_ready = epoll_wait(self->epfd, self->ready, self->ready_alloc - n_always_ready, timeout);
+        RAISE_ERRNO(n_ready, errno);
+    } else if (n_always_ready == 0) {
+        // nothing to wait for except the timeout, as poll() would
+        n_ready = epoll_wait(self->epfd, self->ready, 1, timeout);
+        RAISE_ERRNO(n_ready, errno);
+    }
+
+    if (n_always_ready > 0) {
+        poll_entry_t *entry = self->entries;
+        for (size_t fd = 0; fd < self->entries_alloc; fd++, entry++) {
+            mp_uint_t revents = entry->events & (POLLIN | POLLOUT);
+            if (entry->obj != MP_OBJ_NULL && entry->always_ready && revents != 0) {
+                self->ready[n_ready].events = revents;
+                self->ready[n_ready].data.fd = fd;
+                n_ready += 1;
+            }
+        }
+    }
+
+    return n_ready;
+}
+
+// Returns the registered object for a ready event, or MP_OBJ_NULL if it has
+// been unregistered since the event was returned.
+STATIC mp_obj_t poll_ready_obj(mp_obj_poll_t *self, struct epoll_event *ev) {
+    poll_entry_t *entry = &self->entries[ev->data.fd];
+    if (entry->obj != MP_OBJ_NULL && (self->flags & FLAG_ONESHOT)) {
+        entry->events = 0;
+        if (!entry->always_ready) {
+            poll_ctl(self, EPOLL_CTL_MOD, ev->data.fd, 0);
+        }
+    }
+    return entry->obj;
+}
+
+/// \method poll([timeout])
+/// Timeout is in milliseconds.
+STATIC mp_obj_t poll_poll(size_t n_args, const mp_obj_t *args) {
+    int n_ready = poll_poll_internal(n_args, args);
+
+    if (n_ready == 0) {
+        return mp_const_empty_tuple;
+    }
+
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    mp_obj_list_t *ret_list = MP_OBJ_TO_PTR(mp_obj_new_list(n_ready, NULL));
+    for (int i = 0; i < n_ready; i++) {
+        mp_obj_tuple_t *t = MP_OBJ_TO_PTR(mp_obj_new_tuple(2, NULL));
+        t->items[0] = poll_ready_obj(self, &self->ready[i]);
+        t->items[1] = MP_OBJ_NEW_SMALL_INT(self->ready[i].events);
+        ret_list->items[i] = MP_OBJ_FROM_PTR(t);
+    }
+
+    return MP_OBJ_FROM_PTR(ret_list);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_poll_obj, 1, 3, poll_poll);
+
+STATIC mp_obj_t poll_ipoll(size_t n_args, const mp_obj_t *args) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    if (self->ret_tuple == MP_OBJ_NULL) {
+        self->ret_tuple = mp_obj_new_tuple(2, NULL);
+    }
+
+    int n_ready = poll_poll_internal(n_args, args);
+    self->iter_cnt = n_ready;
+    self->iter_idx = 0;
+
+    return args[0];
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(poll_ipoll_obj, 1, 3, poll_ipoll);
+
+STATIC mp_obj_t poll_iternext(mp_obj_t self_in) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
+
+    while (self->iter_idx < self->iter_cnt) {
+        struct epoll_event *ev = &self->ready[self->iter_idx++];
+        mp_obj_t obj = poll_ready_obj(self, ev);
+        if (obj != MP_OBJ_NULL) {
+            mp_obj_tuple_t *t = MP_OBJ_TO_PTR(self->ret_tuple);
+            t->items[0] = obj;
+            t->items[1] = MP_OBJ_NEW_SMALL_INT(ev->events);
+            return MP_OBJ_FROM_PTR(t);
+        }
+    }
+
+    return MP_OBJ_STOP_ITERATION;
+}
+
+STATIC mp_obj_t poll_del(mp_obj_t self_in) {
+    mp_obj_poll_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->epfd >= 0) {
+        close(self->epfd);
+        self->epfd = -1;
+    }
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_1(poll_del_obj, poll_del);
+#else // MICROPY_PY_USELECT_EPOLL
+
+/// \class Poll - poll class
+
+typedef struct _mp_obj_poll_t {
+    mp_obj_base_t base;
+    unsigned short alloc;
+    unsigned short len;
+    struct pollfd *entries;
+    mp_obj_t *obj_map;
+    short iter_cnt;
+    short iter_idx;
+    int flags;
+    // callee-owned tuple
+    mp_obj_t ret_tuple;
+} mp_obj_poll_t;
+
 /// \method register(obj[, eventmask])
 STATIC mp_obj_t poll_register(size_t n_args, const mp_obj_t *args) {
     mp_obj_poll_t *self = MP_OBJ_TO_PTR(args[0]);
@@ -298,13 +581,18 @@ STATIC mp_obj_t poll_dump(mp_obj_t self_in) {
 MP_DEFINE_CONST_FUN_OBJ_1(poll_dump_obj, poll_dump);
 #endif
 
+#endif // MICROPY_PY_USELECT_EPOLL
+
 STATIC const mp_rom_map_elem_t poll_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_register), MP_ROM_PTR(&poll_register_obj) },
     { MP_ROM_QSTR(MP_QSTR_unregister), MP_ROM_PTR(&poll_unregister_obj) },
     { MP_ROM_QSTR(MP_QSTR_modify), MP_ROM_PTR(&poll_modify_obj) },
     { MP_ROM_QSTR(MP_QSTR_poll), MP_ROM_PTR(&poll_poll_obj) },
     { MP_ROM_QSTR(MP_QSTR_ipoll), MP_ROM_PTR(&poll_ipoll_obj) },
-    #if DEBUG
+    #if MICROPY_PY_USELECT_EPOLL
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&poll_del_obj) },
+    #endif
+    #if DEBUG && !MICROPY_PY_USELECT_EPOLL
     { MP_ROM_QSTR(MP_QSTR_dump), MP_ROM_PTR(&poll_dump_obj) },
     #endif
 };
@@ -323,6 +611,25 @@ STATIC mp_obj_t select_poll(size_t n_args, const mp_obj_t *args) {
     if (n_args > 0) {
         alloc = mp_obj_get_int(args[0]);
     }
+    #if MICROPY_PY_USELECT_EPOLL
+    if (alloc < 1) {
+        alloc = 1;
+    }
+    mp_obj_poll_t *poll = m_new_obj_with_finaliser(mp_obj_poll_t);
+    poll->base.type = &mp_type_poll;
+    poll->epfd = -1;
+    poll->n_entries = 0;
+    poll->n_always_ready = 0;
+    poll->entries_alloc = 0;
+    poll->entries = NULL;
+    poll->ready = m_new(struct epoll_event, alloc);
+    poll->ready_alloc = alloc;
+    poll->iter_cnt = 0;
+    poll->ret_tuple = MP_OBJ_NULL;
+    poll->epfd = epoll_create1(EPOLL_CLOEXEC);
+    RAISE_ERRNO(poll->epfd, errno);
+    return MP_OBJ_FROM_PTR(poll);
+    #else
     mp_obj_poll_t *poll = m_new_obj(mp_obj_poll_t);
     poll->base.type = &mp_type_poll;
     poll->entries = m_new(struct pollfd, alloc);
@@ -332,6 +639,7 @@ STATIC mp_obj_t select_poll(size_t n_args, const mp_obj_t *args) {
     poll->iter_cnt = 0;
     poll->ret_tuple = MP_OBJ_NULL;
     return MP_OBJ_FROM_PTR(poll);
+    #endif
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_select_poll_obj, 0, 1, select_poll);
 
@@ -342,6 +650,9 @@ STATIC const mp_rom_map_elem_t mp_module_select_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_POLLOUT), MP_ROM_INT(POLLOUT) },
     { MP_ROM_QSTR(MP_QSTR_POLLERR), MP_ROM_INT(POLLERR) },
     { MP_ROM_QSTR(MP_QSTR_POLLHUP), MP_ROM_INT(POLLHUP) },
+    #if MICROPY_PY_USELECT_EPOLL
+    { MP_ROM_QSTR(MP_QSTR_EPOLLET), MP_ROM_INT(MP_POLLET) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_select_globals, mp_module_select_globals_table);
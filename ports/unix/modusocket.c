@@ -33,10 +33,12 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <errno.h>
+#include <limits.h>
 
 #include "py/objtuple.h"
 #include "py/objstr.h"
@@ -231,6 +233,55 @@ STATIC mp_obj_t socket_recvfrom(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recvfrom_obj, 2, 3, socket_recvfrom);
 
+// The *_into variants receive into a buffer given by the caller, which may be
+// reused from call to call, instead of allocating a new bytes object for each
+// one.  As in CPython, an nbytes of 0 means the whole buffer.
+STATIC int socket_recv_into_args(size_t n_args, const mp_obj_t *args, mp_buffer_info_t *bufinfo) {
+    mp_get_buffer_raise(args[1], bufinfo, MP_BUFFER_WRITE);
+    if (n_args > 2) {
+        mp_int_t nbytes = mp_obj_get_int(args[2]);
+        if (nbytes < 0 || (size_t)nbytes > bufinfo->len) {
+            mp_raise_ValueError(translate("buffer too small"));
+        }
+        if (nbytes > 0) {
+            bufinfo->len = nbytes;
+        }
+    }
+    int flags = 0;
+    if (n_args > 3) {
+        flags = MP_OBJ_SMALL_INT_VALUE(args[3]);
+    }
+    return flags;
+}
+
+STATIC mp_obj_t socket_recv_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    int flags = socket_recv_into_args(n_args, args, &bufinfo);
+    int out_sz = recv(self->fd, bufinfo.buf, bufinfo.len, flags);
+    RAISE_ERRNO(out_sz, errno);
+    return MP_OBJ_NEW_SMALL_INT(out_sz);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recv_into_obj, 2, 4, socket_recv_into);
+
+STATIC mp_obj_t socket_recvfrom_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    int flags = socket_recv_into_args(n_args, args, &bufinfo);
+
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    int out_sz = recvfrom(self->fd, bufinfo.buf, bufinfo.len, flags, (struct sockaddr*)&addr, &addr_len);
+    RAISE_ERRNO(out_sz, errno);
+
+    mp_obj_t items[2] = {
+        MP_OBJ_NEW_SMALL_INT(out_sz),
+        mp_obj_from_sockaddr((struct sockaddr*)&addr, addr_len),
+    };
+    return mp_obj_new_tuple(2, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recvfrom_into_obj, 2, 4, socket_recvfrom_into);
+
 // Note: besides flag param, this differs from write() in that
 // this does not swallow blocking errors (EAGAIN, EWOULDBLOCK) -
 // these would be thrown as exceptions.
@@ -251,6 +302,41 @@ STATIC mp_obj_t socket_send(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_send_obj, 2, 3, socket_send);
 
+// Unlike send(), this keeps sending until all of the data has gone.  Passing a
+// memoryview slice sends part of a buffer without copying it.
+STATIC mp_obj_t socket_sendall(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    int flags = 0;
+
+    if (n_args > 2) {
+        flags = MP_OBJ_SMALL_INT_VALUE(args[2]);
+    }
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+    const byte *buf = bufinfo.buf;
+    size_t len = bufinfo.len;
+    while (len > 0) {
+        int out_sz = send(self->fd, buf, len, flags);
+        if (out_sz == -1 && errno == EINTR) {
+            // a signal arrived, maybe after part of the data was sent; stop
+            // only if it raised something, such as KeyboardInterrupt
+            if (MP_STATE_VM(mp_pending_exception) != MP_OBJ_NULL) {
+                mp_obj_t obj = MP_STATE_VM(mp_pending_exception);
+                MP_STATE_VM(mp_pending_exception) = MP_OBJ_NULL;
+                nlr_raise(obj);
+            }
+            continue;
+        }
+        RAISE_ERRNO(out_sz, errno);
+        buf += out_sz;
+        len -= out_sz;
+    }
+
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_sendall_obj, 2, 3, socket_sendall);
+
 STATIC mp_obj_t socket_sendto(size_t n_args, const mp_obj_t *args) {
     mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
     int flags = 0;
@@ -272,6 +358,103 @@ STATIC mp_obj_t socket_sendto(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_sendto_obj, 3, 4, socket_sendto);
 
+// sendmsg and recvmsg_into take a list or tuple of buffers, which are passed
+// to the system in place as an array of iovecs on the C stack.
+#ifndef IOV_MAX
+// the limit on Linux; the system still checks its own
+#define IOV_MAX (1024)
+#endif
+
+STATIC struct iovec *socket_fill_iovec(struct iovec *iov, size_t n_bufs, const mp_obj_t *bufs, mp_uint_t buf_flags) {
+    for (size_t i = 0; i < n_bufs; i++) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(bufs[i], &bufinfo, buf_flags);
+        iov[i].iov_base = bufinfo.buf;
+        iov[i].iov_len = bufinfo.len;
+    }
+    return iov;
+}
+
+STATIC mp_obj_t socket_sendmsg(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    int flags = 0;
+
+    if (n_args > 2 && mp_obj_is_true(args[2])) {
+        mp_raise_NotImplementedError(translate("ancillary data not supported"));
+    }
+    if (n_args > 3) {
+        flags = MP_OBJ_SMALL_INT_VALUE(args[3]);
+    }
+
+    size_t n_bufs;
+    mp_obj_t *bufs;
+    mp_obj_get_array(args[1], &n_bufs, &bufs);
+    if (n_bufs > IOV_MAX) {
+        mp_raise_OSError(EMSGSIZE);
+    }
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = socket_fill_iovec(alloca(n_bufs * sizeof(struct iovec)), n_bufs, bufs, MP_BUFFER_READ);
+    msg.msg_iovlen = n_bufs;
+    if (n_args > 4 && args[4] != mp_const_none) {
+        mp_buffer_info_t addr_bi;
+        mp_get_buffer_raise(args[4], &addr_bi, MP_BUFFER_READ);
+        msg.msg_name = addr_bi.buf;
+        msg.msg_namelen = addr_bi.len;
+    }
+
+    int out_sz = sendmsg(self->fd, &msg, flags);
+    RAISE_ERRNO(out_sz, errno);
+
+    return MP_OBJ_NEW_SMALL_INT(out_sz);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_sendmsg_obj, 2, 5, socket_sendmsg);
+
+// Returns (nbytes, ancdata, msg_flags, address) like CPython, with ancdata
+// always empty and address None when the socket is connected.
+STATIC mp_obj_t socket_recvmsg_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    int flags = 0;
+
+    if (n_args > 2 && mp_obj_get_int(args[2]) != 0) {
+        mp_raise_NotImplementedError(translate("ancillary data not supported"));
+    }
+    if (n_args > 3) {
+        flags = MP_OBJ_SMALL_INT_VALUE(args[3]);
+    }
+
+    size_t n_bufs;
+    mp_obj_t *bufs;
+    mp_obj_get_array(args[1], &n_bufs, &bufs);
+    if (n_bufs > IOV_MAX) {
+        mp_raise_OSError(EMSGSIZE);
+    }
+
+    struct sockaddr_storage addr;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = socket_fill_iovec(alloca(n_bufs * sizeof(struct iovec)), n_bufs, bufs, MP_BUFFER_WRITE);
+    msg.msg_iovlen = n_bufs;
+    msg.msg_name = &addr;
+    msg.msg_namelen = sizeof(addr);
+
+    int out_sz = recvmsg(self->fd, &msg, flags);
+    RAISE_ERRNO(out_sz, errno);
+
+    mp_obj_t items[4] = {
+        MP_OBJ_NEW_SMALL_INT(out_sz),
+        mp_obj_new_list(0, NULL),
+        MP_OBJ_NEW_SMALL_INT(msg.msg_flags),
+        mp_const_none,
+    };
+    if (msg.msg_namelen > 0) {
+        items[3] = mp_obj_from_sockaddr((struct sockaddr*)&addr, msg.msg_namelen);
+    }
+    return mp_obj_new_tuple(4, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_recvmsg_into_obj, 2, 4, socket_recvmsg_into);
+
 STATIC mp_obj_t socket_setsockopt(size_t n_args, const mp_obj_t *args) {
     (void)n_args; // always 4
     mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
@@ -364,8 +547,13 @@ STATIC const mp_rom_map_elem_t usocket_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_accept), MP_ROM_PTR(&socket_accept_obj) },
     { MP_ROM_QSTR(MP_QSTR_recv), MP_ROM_PTR(&socket_recv_obj) },
     { MP_ROM_QSTR(MP_QSTR_recvfrom), MP_ROM_PTR(&socket_recvfrom_obj) },
+    { MP_ROM_QSTR(MP_QSTR_recv_into), MP_ROM_PTR(&socket_recv_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_recvfrom_into), MP_ROM_PTR(&socket_recvfrom_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_recvmsg_into), MP_ROM_PTR(&socket_recvmsg_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_send), MP_ROM_PTR(&socket_send_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sendall), MP_ROM_PTR(&socket_sendall_obj) },
     { MP_ROM_QSTR(MP_QSTR_sendto), MP_ROM_PTR(&socket_sendto_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sendmsg), MP_ROM_PTR(&socket_sendmsg_obj) },
     { MP_ROM_QSTR(MP_QSTR_setsockopt), MP_ROM_PTR(&socket_setsockopt_obj) },
     { MP_ROM_QSTR(MP_QSTR_setblocking), MP_ROM_PTR(&socket_setblocking_obj) },
     { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mp_stream_close_obj) },
@@ -548,6 +736,8 @@ STATIC const mp_rom_map_elem_t mp_module_socket_globals_table[] = {
 
     C(MSG_DONTROUTE),
     C(MSG_DONTWAIT),
+    C(MSG_PEEK),
+    C(MSG_TRUNC),
 
     C(SOL_SOCKET),
     C(SO_BROADCAST),
@@ -28,6 +28,7 @@
 
 #define MICROPY_ALLOC_PATH_MAX      (PATH_MAX)
 #define MICROPY_PERSISTENT_CODE_LOAD (1)
+#define MICROPY_PERSISTENT_CODE_XIP (1)
 #if !defined(MICROPY_EMIT_X64) && defined(__x86_64__)
     #define MICROPY_EMIT_X64        (1)
 #endif
@@ -48,6 +49,7 @@
 #define MICROPY_COMP_RETURN_IF_EXPR (1)
 #define MICROPY_ENABLE_GC           (1)
 #define MICROPY_ENABLE_FINALISER    (1)
+#define MICROPY_GC_STACK_GROW       (1)
 #define MICROPY_STACK_CHECK         (1)
 #define MICROPY_MALLOC_USES_ALLOCATED_SIZE (1)
 #define MICROPY_MEM_STATS           (1)
@@ -70,6 +72,7 @@
 #ifndef MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
 #define MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE (1)
 #endif
+#define MICROPY_OPT_FAST_STR_SEARCH (1)
 #define MICROPY_CAN_OVERRIDE_BUILTINS (1)
 #define MICROPY_PY_FUNCTION_ATTRS   (1)
 #define MICROPY_PY_DESCRIPTORS      (1)
@@ -120,9 +123,15 @@
 #define MICROPY_PY_UERRNO           (1)
 #define MICROPY_PY_UCTYPES          (1)
 #define MICROPY_PY_UZLIB            (1)
+#define MICROPY_PY_UZLIB_COMPRESS   (1)
 #define MICROPY_PY_UJSON            (1)
 #define MICROPY_PY_URE              (1)
+#define MICROPY_PY_URE_PIKEVM       (1)
+#define MICROPY_PY_URE_CACHE_SIZE   (8)
 #define MICROPY_PY_UHEAPQ           (1)
+#define MICROPY_PY_UARRAYOPS        (1)
+#define MICROPY_PY_UMMAP            (1)
+#define MICROPY_PY_UMMAP_POSIX      (1)
 #define MICROPY_PY_UTIMEQ           (1)
 #define MICROPY_PY_UHASHLIB         (1)
 #if MICROPY_PY_USSL
@@ -134,6 +143,15 @@
 #ifndef MICROPY_PY_USELECT_POSIX
 #define MICROPY_PY_USELECT_POSIX    (1)
 #endif
+#ifndef MICROPY_PY_USELECT_EPOLL
+#ifdef __linux__
+#define MICROPY_PY_USELECT_EPOLL    (MICROPY_PY_USELECT_POSIX)
+#else
+#define MICROPY_PY_USELECT_EPOLL    (0)
+#endif
+#endif
+#define MICROPY_PY_UEVLOOP          (1)
+#define MICROPY_PY_UEVLOOP_POLL     (MICROPY_PY_USELECT_POSIX)
 #define MICROPY_PY_WEBSOCKET        (1)
 #define MICROPY_PY_MACHINE          (1)
 #define MICROPY_PY_MACHINE_PULSE    (1)
@@ -256,6 +274,10 @@ void mp_unix_free_exec(void *ptr, size_t size);
 void mp_unix_mark_exec(void);
 #define MP_PLAT_ALLOC_EXEC(min_size, ptr, size) mp_unix_alloc_exec(min_size, ptr, size)
 #define MP_PLAT_FREE_EXEC(ptr, size) mp_unix_free_exec(ptr, size)
+void *mp_unix_alloc_gc_stack(size_t n_bytes);
+void mp_unix_free_gc_stack(void *ptr, size_t n_bytes);
+#define MP_PLAT_ALLOC_GC_STACK(n_bytes) mp_unix_alloc_gc_stack(n_bytes)
+#define MP_PLAT_FREE_GC_STACK(ptr, n_bytes) mp_unix_free_gc_stack(ptr, n_bytes)
 #ifndef MICROPY_FORCE_PLAT_ALLOC_EXEC
 // Use MP_PLAT_ALLOC_EXEC for any executable memory allocation, including for FFI
 // (overriding libffi own implementation)
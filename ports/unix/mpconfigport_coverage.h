@@ -29,10 +29,12 @@
 
 #define MICROPY_VFS                    (1)
 #define MICROPY_PY_UOS_VFS             (1)
+#define MICROPY_VFS_IMPORT_CACHE       (1)
 
 #include <mpconfigport.h>
 
 #define MICROPY_FLOAT_HIGH_QUALITY_HASH (1)
+#define MICROPY_GC_ALLOC_SITES         (16)
 #define MICROPY_ENABLE_SCHEDULER       (1)
 #define MICROPY_READER_VFS             (1)
 #define MICROPY_PY_DELATTR_SETATTR     (1)
@@ -48,8 +50,15 @@
 #undef MICROPY_VFS_FAT
 #define MICROPY_VFS_FAT                (1)
 #define MICROPY_FATFS_USE_LABEL        (1)
+#define MICROPY_FATFS_USE_FASTSEEK     (1)
+#define MICROPY_FATFS_CACHE_SECTORS    (4)
 #define MICROPY_PY_FRAMEBUF            (1)
+#define MICROPY_PY_MICROPYTHON_PROFILE (1)
+#define MICROPY_PY_MICROPYTHON_PROFILE_SAMPLE_PERIOD (1000)
 #define MICROPY_PY_COLLECTIONS_NAMEDTUPLE__ASDICT (1)
+#define MICROPY_PERSISTENT_CODE_SAVE   (1)
+#define MICROPY_PERSISTENT_CODE_CACHE  (1)
+#define MICROPY_COMP_INCREMENTAL       (1)
 
 // TODO these should be generic, not bound to fatfs
 #define mp_type_fileio mp_type_vfs_posix_fileio
@@ -38,3 +38,7 @@
 #undef _DIRENT_HAVE_D_INO
 
 #define MICROPY_USE_INTERNAL_ERRNO  (1)
+
+// djgpp has no mmap()
+#undef MICROPY_PY_UMMAP_POSIX
+#define MICROPY_PY_UMMAP_POSIX      (0)
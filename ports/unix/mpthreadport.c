@@ -36,6 +36,7 @@
 
 #include <signal.h>
 #include <sched.h>
+#include <unistd.h>
 
 // this structure forms a linked list, one node per active thread
 typedef struct _thread_t {
@@ -55,11 +56,16 @@ STATIC thread_t *thread;
 // it's needed because we can't use any pthread calls in a signal handler
 STATIC volatile int thread_signal_done;
 
+// this is incremented when the GC has finished, to let the threads that it
+// stopped carry on
+STATIC volatile unsigned int thread_gc_resume_count;
+
 // this signal handler is used to scan the regs and stack of a thread
 STATIC void mp_thread_gc(int signo, siginfo_t *info, void *context) {
     (void)info; // unused
     (void)context; // unused
     if (signo == SIGUSR1) {
+        unsigned int resume_count = thread_gc_resume_count;
         void gc_collect_regs_and_stack(void);
         gc_collect_regs_and_stack();
         // We have access to the context (regs, stack) of the thread but it seems
@@ -70,7 +76,15 @@ STATIC void mp_thread_gc(int signo, siginfo_t *info, void *context) {
         void **ptrs = (void**)(void*)MP_STATE_THREAD(pystack_start);
         gc_collect_root(ptrs, (MP_STATE_THREAD(pystack_cur) - MP_STATE_THREAD(pystack_start)) / sizeof(void*));
         #endif
+        #if MICROPY_GC_THREAD_ALLOC_BUFFER
+        gc_collect_alloc_buffer();
+        #endif
         thread_signal_done = 1;
+        // Wait here until the heap is marked, so this thread can't move a
+        // pointer from a place the GC hasn't scanned yet to one it has.
+        while (thread_gc_resume_count == resume_count) {
+            sched_yield();
+        }
     }
 }
 
@@ -98,7 +112,12 @@ void mp_thread_init(void) {
 // own registers and stack.  Note that there may still be some edge cases left
 // with race conditions and root-pointer scanning: a given thread may manipulate
 // the global root pointers (in mp_state_ctx) while another thread is doing a
-// garbage collection and tracing these pointers.
+// garbage collection and tracing these pointers.  Each thread stays stopped in
+// the signal handler until mp_thread_gc_others_resume is called, and the list
+// stays locked until then too, so that another collection can't start and
+// stop this thread before it has let the others go.  gc_collect lets them go
+// once the heap is marked, so that the finalisers called by the sweep don't
+// wait for a lock that a stopped thread holds.
 void mp_thread_gc_others(void) {
     pthread_mutex_lock(&thread_mutex);
     for (thread_t *th = thread; th != NULL; th = th->next) {
@@ -115,6 +134,10 @@ void mp_thread_gc_others(void) {
             sched_yield();
         }
     }
+}
+
+void mp_thread_gc_others_resume(void) {
+    thread_gc_resume_count += 1;
     pthread_mutex_unlock(&thread_mutex);
 }
 
@@ -228,4 +251,80 @@ void mp_thread_mutex_unlock(mp_thread_mutex_t *mutex) {
     // TODO check return value
 }
 
+#if MICROPY_GC_PARALLEL_MARK
+
+// the most threads that are started to help the GC mark the heap
+#define GC_MARK_HELPERS_MAX (7)
+
+// The helpers are started the first time a collection needs them, one for
+// each online CPU besides the one the collector runs on, and then wait for
+// the next collection.  They aren't Python threads, so they aren't in the
+// linked list of threads.
+STATIC pthread_mutex_t gc_mark_mutex = PTHREAD_MUTEX_INITIALIZER;
+STATIC pthread_cond_t gc_mark_start_cond = PTHREAD_COND_INITIALIZER;
+STATIC pthread_cond_t gc_mark_done_cond = PTHREAD_COND_INITIALIZER;
+STATIC int gc_mark_n_helpers = -1;
+STATIC unsigned int gc_mark_generation;
+STATIC int gc_mark_n_running;
+
+STATIC void *gc_mark_helper_entry(void *arg) {
+    (void)arg;
+    mp_gc_stack_t stack = {NULL, 0, 0};
+    // the helpers are all started before the first collection they help with
+    unsigned int generation = 0;
+    pthread_mutex_lock(&gc_mark_mutex);
+    for (;;) {
+        while (gc_mark_generation == generation) {
+            pthread_cond_wait(&gc_mark_start_cond, &gc_mark_mutex);
+        }
+        generation = gc_mark_generation;
+        pthread_mutex_unlock(&gc_mark_mutex);
+        gc_mark_helper(&stack);
+        pthread_mutex_lock(&gc_mark_mutex);
+        if (--gc_mark_n_running == 0) {
+            pthread_cond_signal(&gc_mark_done_cond);
+        }
+    }
+    return NULL;
+}
+
+void mp_thread_gc_mark_start(void) {
+    if (gc_mark_n_helpers < 0) {
+        gc_mark_n_helpers = 0;
+        long n_cpu = sysconf(_SC_NPROCESSORS_ONLN);
+        // block all signals in the helpers, they must be handled by Python threads
+        sigset_t all, old;
+        sigfillset(&all);
+        pthread_sigmask(SIG_BLOCK, &all, &old);
+        while (gc_mark_n_helpers < n_cpu - 1 && gc_mark_n_helpers < GC_MARK_HELPERS_MAX) {
+            pthread_t id;
+            if (pthread_create(&id, NULL, gc_mark_helper_entry, NULL) != 0) {
+                break;
+            }
+            pthread_detach(id);
+            gc_mark_n_helpers += 1;
+        }
+        pthread_sigmask(SIG_SETMASK, &old, NULL);
+    }
+    pthread_mutex_lock(&gc_mark_mutex);
+    gc_mark_n_running = gc_mark_n_helpers;
+    gc_mark_generation += 1;
+    pthread_cond_broadcast(&gc_mark_start_cond);
+    pthread_mutex_unlock(&gc_mark_mutex);
+}
+
+void mp_thread_gc_mark_wait(void) {
+    pthread_mutex_lock(&gc_mark_mutex);
+    while (gc_mark_n_running > 0) {
+        pthread_cond_wait(&gc_mark_done_cond, &gc_mark_mutex);
+    }
+    pthread_mutex_unlock(&gc_mark_mutex);
+}
+
+void mp_thread_yield(void) {
+    sched_yield();
+}
+
+#endif // MICROPY_GC_PARALLEL_MARK
+
 #endif // MICROPY_PY_THREAD
@@ -30,3 +30,4 @@ typedef pthread_mutex_t mp_thread_mutex_t;
 
 void mp_thread_init(void);
 void mp_thread_gc_others(void);
+void mp_thread_gc_others_resume(void);
@@ -294,6 +294,64 @@ continue2:;
     dump_args(code_state->state, n_state);
 }
 
+// Find the function name, source file and line number of the opcode at ip
+// by decoding the code-info block of fun's bytecode.
+size_t mp_bytecode_get_source_line(const mp_obj_fun_bc_t *fun, const byte *ip_in, qstr *block_name_out, qstr *source_file_out) {
+    const byte *ip = fun->bytecode;
+    ip = mp_decode_uint_skip(ip); // skip n_state
+    ip = mp_decode_uint_skip(ip); // skip n_exc_stack
+    ip++; // skip scope_params
+    ip++; // skip n_pos_args
+    ip++; // skip n_kwonly_args
+    ip++; // skip n_def_pos_args
+    size_t bc = ip_in - ip;
+    size_t code_info_size = mp_decode_uint_value(ip);
+    ip = mp_decode_uint_skip(ip); // skip code_info_size
+    bc -= code_info_size;
+    #if MICROPY_PERSISTENT_CODE
+    qstr block_name = ip[0] | (ip[1] << 8);
+    qstr source_file = ip[2] | (ip[3] << 8);
+    ip += 4;
+    #if MICROPY_PERSISTENT_CODE_XIP
+    if (fun->qstr_table != NULL) {
+        block_name = fun->qstr_table[block_name];
+        source_file = fun->qstr_table[source_file];
+    }
+    #endif
+    #else
+    qstr block_name = mp_decode_uint_value(ip);
+    ip = mp_decode_uint_skip(ip);
+    qstr source_file = mp_decode_uint_value(ip);
+    ip = mp_decode_uint_skip(ip);
+    #endif
+    size_t source_line = 1;
+    size_t c;
+    while ((c = *ip)) {
+        size_t b, l;
+        if ((c & 0x80) == 0) {
+            // 0b0LLBBBBB encoding
+            b = c & 0x1f;
+            l = c >> 5;
+            ip += 1;
+        } else {
+            // 0b1LLLBBBB 0bLLLLLLLL encoding (l's LSB in second byte)
+            b = c & 0xf;
+            l = ((c << 4) & 0x700) | ip[1];
+            ip += 2;
+        }
+        if (bc >= b) {
+            bc -= b;
+            source_line += l;
+        } else {
+            // found source line corresponding to bytecode offset
+            break;
+        }
+    }
+    *block_name_out = block_name;
+    *source_file_out = source_file;
+    return source_line;
+}
+
 #if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_PERSISTENT_CODE_SAVE
 
 // The following table encodes the number of bytes that a specific opcode
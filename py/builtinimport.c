@@ -38,6 +38,14 @@
 #include "py/builtin.h"
 #include "py/frozenmod.h"
 
+#if MICROPY_PERSISTENT_CODE_CACHE
+#include "py/stream.h"
+#include "extmod/vfs.h"
+#if MICROPY_VFS_POSIX
+#include "extmod/vfs_posix.h"
+#endif
+#endif
+
 #include "supervisor/shared/translate.h"
 
 #if MICROPY_DEBUG_VERBOSE // print debugging info
@@ -140,6 +148,76 @@ STATIC mp_import_stat_t find_file(const char *file_str, uint file_len, vstr_t *d
 #endif
 }
 
+#if MICROPY_COMP_INCREMENTAL
+// Compile the module one top-level statement at a time, so only the parse
+// tree of the current statement needs to be in memory.  Returns the raw code
+// of each statement, and sets *n to how many there are.
+STATIC mp_raw_code_t **compile_incremental(mp_lexer_t *lex, size_t *n) {
+    qstr source_name = lex->source_name;
+    mp_parse_stream_t *volatile ps = NULL;
+    mp_raw_code_t **volatile raw_codes = NULL;
+    size_t volatile len = 0;
+    size_t volatile alloc = 0;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        ps = mp_parse_stream_new(lex);
+        mp_parse_tree_t parse_tree;
+        while (mp_parse_stream_next(ps, &parse_tree)) {
+            if (len == alloc) {
+                raw_codes = m_renew(mp_raw_code_t*, raw_codes, alloc, alloc + 8);
+                alloc += 8;
+            }
+            // this frees the parse tree
+            raw_codes[len++] = mp_compile_to_raw_code(&parse_tree, source_name, MP_EMIT_OPT_NONE, false);
+        }
+        // this closes the input before the module runs
+        mp_parse_stream_free(ps);
+        nlr_pop();
+    } else {
+        // free the parser and lexer and re-raise the exception
+        if (ps != NULL) {
+            mp_parse_stream_free(ps);
+        }
+        nlr_jump(nlr.ret_val);
+    }
+    *n = len;
+    return raw_codes;
+}
+
+// Compile the module incrementally, then execute it.  The whole module is
+// compiled before any of it runs, so a syntax error is raised before any
+// statement has been executed, as with mp_parse_compile_execute.
+STATIC void do_execute_incremental(mp_lexer_t *lex, mp_obj_dict_t *mod_globals) {
+    size_t n;
+    mp_raw_code_t **raw_codes = compile_incremental(lex, &n);
+
+    // save context
+    mp_obj_dict_t *volatile old_globals = mp_globals_get();
+    mp_obj_dict_t *volatile old_locals = mp_locals_get();
+
+    // set new context
+    mp_globals_set(mod_globals);
+    mp_locals_set(mod_globals);
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            mp_call_function_0(mp_make_function_from_raw_code(raw_codes[i], MP_OBJ_NULL, MP_OBJ_NULL));
+        }
+
+        // finish nlr block, restore context
+        nlr_pop();
+        mp_globals_set(old_globals);
+        mp_locals_set(old_locals);
+    } else {
+        // exception; restore context and re-raise same exception
+        mp_globals_set(old_globals);
+        mp_locals_set(old_locals);
+        nlr_jump(nlr.ret_val);
+    }
+}
+#endif
+
 #if MICROPY_ENABLE_COMPILER
 STATIC void do_load_from_lexer(mp_obj_t module_obj, mp_lexer_t *lex) {
     #if MICROPY_PY___FILE__
@@ -149,13 +227,18 @@ STATIC void do_load_from_lexer(mp_obj_t module_obj, mp_lexer_t *lex) {
 
     // parse, compile and execute the module in its context
     mp_obj_dict_t *mod_globals = mp_obj_module_get_globals(module_obj);
+    #if MICROPY_COMP_INCREMENTAL
+    do_execute_incremental(lex, mod_globals);
+    #else
     mp_parse_compile_execute(lex, MP_PARSE_FILE_INPUT, mod_globals, mod_globals);
+    #endif
     mp_obj_module_set_globals(module_obj, make_dict_long_lived(mod_globals, 10));
 }
 #endif
 
 #if MICROPY_PERSISTENT_CODE_LOAD || MICROPY_MODULE_FROZEN_MPY
-STATIC void do_execute_raw_code(mp_obj_t module_obj, mp_raw_code_t *raw_code, const char *filename) {
+// Execute the raw code of a module, or of each part of one in turn.
+STATIC void do_execute_raw_code(mp_obj_t module_obj, mp_raw_code_t *const *raw_codes, size_t n, const char *filename) {
     #if MICROPY_PY___FILE__
     mp_store_attr(module_obj, MP_QSTR___file__, MP_OBJ_NEW_QSTR(qstr_from_str(filename)));
     #endif
@@ -173,8 +256,10 @@ STATIC void do_execute_raw_code(mp_obj_t module_obj, mp_raw_code_t *raw_code, co
 
     nlr_buf_t nlr;
     if (nlr_push(&nlr) == 0) {
-        mp_obj_t module_fun = mp_make_function_from_raw_code(raw_code, MP_OBJ_NULL, MP_OBJ_NULL);
-        mp_call_function_0(module_fun);
+        for (size_t i = 0; i < n; ++i) {
+            mp_obj_t module_fun = mp_make_function_from_raw_code(raw_codes[i], MP_OBJ_NULL, MP_OBJ_NULL);
+            mp_call_function_0(module_fun);
+        }
 
         // finish nlr block, restore context
         nlr_pop();
@@ -191,6 +276,264 @@ STATIC void do_execute_raw_code(mp_obj_t module_obj, mp_raw_code_t *raw_code, co
 }
 #endif
 
+#if MICROPY_PERSISTENT_CODE_CACHE
+// A compiled module is cached as <dir>/__pycache__/<name>.mpy.  The file
+// starts with a 16 byte header: the size and a hash of the source it was
+// compiled from, the length of the data that follows and the number of .mpy
+// images in it, each stored as 4 bytes little endian.  There is one image
+// for the whole module, or with MICROPY_COMP_INCREMENTAL one for each
+// top-level statement.  The key is taken from the contents of the source
+// rather than its mtime, which FAT only stores to 2 seconds and which boards
+// without a clock don't set.  If the source changes then the key won't match
+// and the module is compiled again, and if the file is shorter or longer than
+// its header says it is ignored.  The file is written under a temporary name
+// and renamed into place, so a reader never sees one that is partly written.
+#define CACHE_KEY_LEN (8)
+#define CACHE_HEADER_LEN (CACHE_KEY_LEN + 8)
+
+// Exceptions raised while reading or writing the cache that mean the cache
+// can't be used and the module should be compiled as normal.
+STATIC bool cache_error_is_ignored(nlr_buf_t *nlr) {
+    const mp_obj_type_t *type = mp_obj_get_type(MP_OBJ_FROM_PTR(nlr->ret_val));
+    return mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(type), MP_OBJ_FROM_PTR(&mp_type_OSError))
+        || mp_obj_is_subclass_fast(MP_OBJ_FROM_PTR(type), MP_OBJ_FROM_PTR(&mp_type_ValueError));
+}
+
+// Only filesystems implemented in C are cached, as a user-defined filesystem
+// may not support the mkdir, seek and rename that writing the cache needs.
+// The host filesystem of the unix port isn't cached either: compiling is
+// cheap there and __pycache__ directories would be left all over the host.
+STATIC bool cache_is_supported(const char *file_str) {
+    const char *path_out;
+    mp_vfs_mount_t *vfs = mp_vfs_lookup_path(file_str, &path_out);
+    if (vfs == MP_VFS_NONE || vfs == MP_VFS_ROOT) {
+        return false;
+    }
+    const mp_obj_type_t *type = mp_obj_get_type(vfs->obj);
+    #if MICROPY_VFS_POSIX
+    if (type == &mp_type_vfs_posix) {
+        return false;
+    }
+    #endif
+    return type->protocol != NULL;
+}
+
+STATIC void cache_put_uint32(byte *buf, mp_uint_t val) {
+    for (size_t i = 0; i < 4; ++i) {
+        buf[i] = val >> (8 * i);
+    }
+}
+
+STATIC mp_uint_t cache_get_uint32(const byte *buf) {
+    return buf[0] | buf[1] << 8 | buf[2] << 16 | (mp_uint_t)buf[3] << 24;
+}
+
+STATIC mp_uint_t cache_get_file_size(const char *file_str) {
+    mp_obj_t stat = mp_vfs_stat(mp_obj_new_str(file_str, strlen(file_str)));
+    mp_obj_t *items;
+    mp_obj_get_array_fixed_n(stat, 10, &items);
+    return mp_obj_get_int_truncated(items[6]);
+}
+
+// The key is the size of the source and its 32-bit FNV-1a hash.
+STATIC void cache_get_key(const char *file_str, byte *key) {
+    mp_reader_t reader;
+    mp_reader_new_file(&reader, file_str);
+    uint32_t size = 0;
+    uint32_t hash = 2166136261;
+    for (mp_uint_t c; (c = reader.readbyte(reader.data)) != MP_READER_EOF;) {
+        hash = (hash ^ c) * 16777619;
+        size += 1;
+    }
+    reader.close(reader.data);
+    cache_put_uint32(key, size);
+    cache_put_uint32(key + 4, hash);
+}
+
+// Reads the data of a cache file, which must end exactly where the header
+// says it does.  Closing it leaves the file open for the next image.
+typedef struct _cache_reader_t {
+    mp_reader_t *file;
+    mp_uint_t remaining;
+} cache_reader_t;
+
+STATIC mp_uint_t cache_reader_readbyte(void *data) {
+    cache_reader_t *reader = data;
+    if (reader->remaining == 0) {
+        return MP_READER_EOF;
+    }
+    reader->remaining -= 1;
+    return reader->file->readbyte(reader->file->data);
+}
+
+STATIC void cache_reader_close(void *data) {
+    (void)data;
+}
+
+// Returns the raw code of each image in the cache file and sets *n to their
+// number, or returns NULL if the file can't be used.
+STATIC mp_raw_code_t **cache_load(const char *cache_str, const byte *key, size_t *n) {
+    if (mp_import_stat(cache_str) != MP_IMPORT_STAT_FILE) {
+        return NULL;
+    }
+    mp_raw_code_t **volatile raw_codes = NULL;
+    mp_reader_t reader;
+    bool volatile reader_open = false;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_uint_t file_size = cache_get_file_size(cache_str);
+        mp_reader_new_file(&reader, cache_str);
+        reader_open = true;
+        byte header[CACHE_HEADER_LEN];
+        for (size_t i = 0; i < CACHE_HEADER_LEN; ++i) {
+            header[i] = reader.readbyte(reader.data);
+        }
+        mp_uint_t data_len = cache_get_uint32(header + CACHE_KEY_LEN);
+        mp_uint_t n_images = cache_get_uint32(header + CACHE_KEY_LEN + 4);
+        // an image takes at least 4 bytes, which bounds the allocation
+        if (file_size > CACHE_HEADER_LEN
+            && memcmp(header, key, CACHE_KEY_LEN) == 0
+            && data_len == file_size - CACHE_HEADER_LEN
+            && n_images != 0 && n_images <= data_len / 4) {
+            cache_reader_t data = {&reader, data_len};
+            mp_reader_t data_reader = {&data, cache_reader_readbyte, cache_reader_close};
+            mp_raw_code_t **rcs = m_new(mp_raw_code_t*, n_images);
+            for (size_t i = 0; i < n_images; ++i) {
+                rcs[i] = mp_raw_code_load(&data_reader);
+            }
+            if (data.remaining != 0) {
+                mp_raise_ValueError(translate("Incompatible .mpy file. Please update all .mpy files. See http://adafru.it/mpy-update for more info."));
+            }
+            raw_codes = rcs;
+            *n = n_images;
+        }
+        reader.close(reader.data);
+        nlr_pop();
+    } else {
+        if (reader_open) {
+            // the reader is left open if loading the .mpy data failed
+            reader.close(reader.data);
+        }
+        if (!cache_error_is_ignored(&nlr)) {
+            nlr_jump(nlr.ret_val);
+        }
+    }
+    return raw_codes;
+}
+
+// Writes to the cache file through mp_stream_write_adaptor, counting the
+// bytes written.
+typedef struct _cache_writer_t {
+    mp_obj_t file;
+    mp_uint_t len;
+} cache_writer_t;
+
+STATIC void cache_write_strn(void *data, const char *str, size_t len) {
+    cache_writer_t *writer = data;
+    mp_stream_write_adaptor(MP_OBJ_TO_PTR(writer->file), str, len);
+    writer->len += len;
+}
+
+STATIC void cache_save(mp_raw_code_t *const *raw_codes, size_t n, vstr_t *cache, size_t dir_len, const byte *key) {
+    mp_obj_t path = mp_obj_new_str(vstr_str(cache), cache->len);
+    vstr_t tmp;
+    vstr_init(&tmp, cache->len + 5);
+    vstr_add_strn(&tmp, vstr_str(cache), cache->len);
+    vstr_add_str(&tmp, ".tmp");
+    mp_obj_t tmp_path = mp_obj_new_str_from_vstr(&mp_type_str, &tmp);
+
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        // the directory may already exist
+        mp_vfs_mkdir(mp_obj_new_str(vstr_str(cache), dir_len));
+        nlr_pop();
+    } else if (!cache_error_is_ignored(&nlr)) {
+        nlr_jump(nlr.ret_val);
+    }
+
+    cache_writer_t writer = {MP_OBJ_NULL, 0};
+    mp_obj_t volatile file = MP_OBJ_NULL;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t args[2] = {tmp_path, MP_OBJ_NEW_QSTR(MP_QSTR_wb)};
+        file = mp_vfs_open(MP_ARRAY_SIZE(args), args, (mp_map_t*)&mp_const_empty_map);
+        writer.file = file;
+        // the length of the data is filled in once it is known
+        byte header[CACHE_HEADER_LEN] = {0};
+        memcpy(header, key, CACHE_KEY_LEN);
+        mp_stream_write_adaptor(MP_OBJ_TO_PTR(file), (const char*)header, CACHE_HEADER_LEN);
+        mp_print_t print = {&writer, cache_write_strn};
+        for (size_t i = 0; i < n; ++i) {
+            mp_raw_code_save(raw_codes[i], &print);
+        }
+        struct mp_stream_seek_t seek_s = {CACHE_KEY_LEN, MP_SEEK_SET};
+        int errcode;
+        if (mp_get_stream(file)->ioctl(file, MP_STREAM_SEEK, (uintptr_t)&seek_s, &errcode) == MP_STREAM_ERROR) {
+            mp_raise_OSError(errcode);
+        }
+        cache_put_uint32(header, writer.len);
+        cache_put_uint32(header + 4, n);
+        mp_stream_write_adaptor(MP_OBJ_TO_PTR(file), (const char*)header, 8);
+        mp_stream_close(file);
+        file = MP_OBJ_NULL;
+        mp_vfs_rename(tmp_path, path);
+        nlr_pop();
+    } else {
+        // Read-only filesystem, no space left or code that can't be saved
+        // (eg native functions): don't leave a partial file behind.
+        nlr_buf_t nlr2;
+        if (nlr_push(&nlr2) == 0) {
+            if (file != MP_OBJ_NULL) {
+                mp_stream_close(file);
+            }
+            mp_vfs_remove(tmp_path);
+            nlr_pop();
+        }
+        if (!cache_error_is_ignored(&nlr)) {
+            nlr_jump(nlr.ret_val);
+        }
+    }
+}
+
+// Load the module from its cached .mpy, or compile it and update the cache.
+STATIC void do_load_cached(mp_obj_t module_obj, vstr_t *file) {
+    const char *file_str = vstr_null_terminated_str(file);
+    byte key[CACHE_KEY_LEN];
+    cache_get_key(file_str, key);
+
+    vstr_t cache;
+    vstr_init(&cache, file->len + 16);
+    const char *name = strrchr(file_str, PATH_SEP_CHAR);
+    name = name == NULL ? file_str : name + 1;
+    vstr_add_strn(&cache, file_str, name - file_str);
+    vstr_add_str(&cache, "__pycache__");
+    size_t dir_len = cache.len;
+    vstr_add_char(&cache, PATH_SEP_CHAR);
+    // replace the .py extension
+    vstr_add_strn(&cache, name, file_str + file->len - 3 - name);
+    vstr_add_str(&cache, ".mpy");
+
+    size_t n = 0;
+    mp_raw_code_t **raw_codes = cache_load(vstr_null_terminated_str(&cache), key, &n);
+    if (raw_codes == NULL) {
+        mp_lexer_t *lex = mp_lexer_new_from_file(file_str);
+        #if MICROPY_COMP_INCREMENTAL
+        raw_codes = compile_incremental(lex, &n);
+        #else
+        qstr source_name = lex->source_name;
+        mp_parse_tree_t parse_tree = mp_parse(lex, MP_PARSE_FILE_INPUT);
+        raw_codes = m_new(mp_raw_code_t*, 1);
+        raw_codes[0] = mp_compile_to_raw_code(&parse_tree, source_name, MP_EMIT_OPT_NONE, false);
+        n = 1;
+        #endif
+        cache_save(raw_codes, n, &cache, dir_len, key);
+    }
+    vstr_clear(&cache);
+
+    do_execute_raw_code(module_obj, raw_codes, n, file_str);
+}
+#endif
+
+
 STATIC void do_load(mp_obj_t module_obj, vstr_t *file) {
     #if MICROPY_MODULE_FROZEN || MICROPY_PERSISTENT_CODE_LOAD || MICROPY_ENABLE_COMPILER
     char *file_str = vstr_null_terminated_str(file);
@@ -220,7 +563,8 @@ STATIC void do_load(mp_obj_t module_obj, vstr_t *file) {
         // its data) in the list of frozen files, execute it.
         #if MICROPY_MODULE_FROZEN_MPY
         if (frozen_type == MP_FROZEN_MPY) {
-            do_execute_raw_code(module_obj, modref, file_str);
+            mp_raw_code_t *raw_code = modref;
+            do_execute_raw_code(module_obj, &raw_code, 1, file_str);
             return;
         }
         #endif
@@ -233,7 +577,7 @@ STATIC void do_load(mp_obj_t module_obj, vstr_t *file) {
     #if MICROPY_PERSISTENT_CODE_LOAD
     if (file_str[file->len - 3] == 'm') {
         mp_raw_code_t *raw_code = mp_raw_code_load_file(file_str);
-        do_execute_raw_code(module_obj, raw_code, file_str);
+        do_execute_raw_code(module_obj, &raw_code, 1, file_str);
         return;
     }
     #endif
@@ -241,6 +585,12 @@ STATIC void do_load(mp_obj_t module_obj, vstr_t *file) {
     // If we can compile scripts then load the file and compile and execute it.
     #if MICROPY_ENABLE_COMPILER
     {
+        #if MICROPY_PERSISTENT_CODE_CACHE
+        if (cache_is_supported(file_str)) {
+            do_load_cached(module_obj, file);
+            return;
+        }
+        #endif
         mp_lexer_t *lex = mp_lexer_new_from_file(file_str);
         do_load_from_lexer(module_obj, lex);
         return;
@@ -69,6 +69,9 @@ void mp_emit_glue_assign_bytecode(mp_raw_code_t *rc, const byte *code,
     rc->scope_flags = scope_flags;
     rc->data.u_byte.bytecode = code;
     rc->data.u_byte.const_table = const_table;
+    #if MICROPY_PERSISTENT_CODE_XIP
+    rc->data.u_byte.qstr_table = NULL;
+    #endif
     #if MICROPY_PERSISTENT_CODE_SAVE
     rc->data.u_byte.bc_len = len;
     rc->data.u_byte.n_obj = n_obj;
@@ -146,6 +149,9 @@ mp_obj_t mp_make_function_from_raw_code(const mp_raw_code_t *rc, mp_obj_t def_ar
             // rc->kind should always be set and BYTECODE is the only remaining case
             assert(rc->kind == MP_CODE_BYTECODE);
             fun = mp_obj_new_fun_bc(def_args, def_kw_args, rc->data.u_byte.bytecode, rc->data.u_byte.const_table);
+            #if MICROPY_PERSISTENT_CODE_XIP
+            ((mp_obj_fun_bc_t*)MP_OBJ_TO_PTR(fun))->qstr_table = rc->data.u_byte.qstr_table;
+            #endif
             break;
     }
 
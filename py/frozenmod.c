@@ -31,6 +31,36 @@
 #include "py/lexer.h"
 #include "py/frozenmod.h"
 
+#if MICROPY_MODULE_FROZEN
+
+// The tools that generate the frozen tables sort the names, and emit the
+// offset of each name within the NUL-separated list so it can be searched.
+// Find the name that is the len bytes at str, followed by tail if nonzero,
+// and return its position, or -1.  A tail of '/' matches any name within the
+// package str.
+STATIC int mp_frozen_find(const char *names, const uint16_t *index, size_t count, const char *str, size_t len, char tail) {
+    size_t lo = 0;
+    size_t hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const char *name = names + index[mid];
+        int cmp = strncmp(name, str, len);
+        if (cmp == 0) {
+            cmp = (byte)name[len] - (byte)tail;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else if (cmp > 0) {
+            hi = mid;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+#endif
+
 #if MICROPY_MODULE_FROZEN_STR
 
 #ifndef MICROPY_MODULE_FROZEN_LEXER
@@ -40,7 +70,10 @@ mp_lexer_t *MICROPY_MODULE_FROZEN_LEXER(qstr src_name, const char *str, mp_uint_
 #endif
 
 extern const char mp_frozen_str_names[];
+extern const uint16_t mp_frozen_str_count;
+extern const uint16_t mp_frozen_str_index[];
 extern const uint32_t mp_frozen_str_sizes[];
+extern const uint32_t mp_frozen_str_offsets[];
 extern const char mp_frozen_str_content[];
 
 // str_len is length of str. *len is set on on output to size of content
@@ -51,19 +84,12 @@ const char *mp_find_frozen_str(const char *str, size_t str_len, size_t *len) {
         str_len = str_len - MP_FROZEN_FAKE_DIR_SLASH_LENGTH;
     }
 
-    const char *name = mp_frozen_str_names;
-
-    size_t offset = 0;
-    for (int i = 0; *name != 0; i++) {
-        size_t l = strlen(name);
-        if (l == str_len && !memcmp(str, name, l)) {
-            *len = mp_frozen_str_sizes[i];
-            return mp_frozen_str_content + offset;
-        }
-        name += l + 1;
-        offset += mp_frozen_str_sizes[i] + 1;
+    int i = mp_frozen_find(mp_frozen_str_names, mp_frozen_str_index, mp_frozen_str_count, str, str_len, 0);
+    if (i < 0) {
+        return NULL;
     }
-    return NULL;
+    *len = mp_frozen_str_sizes[i];
+    return mp_frozen_str_content + mp_frozen_str_offsets[i];
 }
 
 STATIC mp_lexer_t *mp_lexer_frozen_str(const char *str, size_t str_len) {
@@ -85,37 +111,29 @@ STATIC mp_lexer_t *mp_lexer_frozen_str(const char *str, size_t str_len) {
 #include "py/emitglue.h"
 
 extern const char mp_frozen_mpy_names[];
+extern const uint16_t mp_frozen_mpy_count;
+extern const uint16_t mp_frozen_mpy_index[];
 extern const mp_raw_code_t *const mp_frozen_mpy_content[];
 
 STATIC const mp_raw_code_t *mp_find_frozen_mpy(const char *str, size_t str_len) {
-    const char *name = mp_frozen_mpy_names;
-    for (size_t i = 0; *name != 0; i++) {
-        size_t l = strlen(name);
-        if (l == str_len && !memcmp(str, name, l)) {
-            return mp_frozen_mpy_content[i];
-        }
-        name += l + 1;
+    int i = mp_frozen_find(mp_frozen_mpy_names, mp_frozen_mpy_index, mp_frozen_mpy_count, str, str_len, 0);
+    if (i < 0) {
+        return NULL;
     }
-    return NULL;
+    return mp_frozen_mpy_content[i];
 }
 
 #endif
 
 #if MICROPY_MODULE_FROZEN
 
-STATIC mp_import_stat_t mp_frozen_stat_helper(const char *name, const char *str) {
+STATIC mp_import_stat_t mp_frozen_stat_helper(const char *names, const uint16_t *index, size_t count, const char *str) {
     size_t len = strlen(str);
-
-    for (int i = 0; *name != 0; i++) {
-        size_t l = strlen(name);
-        if (l >= len && !memcmp(str, name, len)) {
-            if (name[len] == 0) {
-                return MP_IMPORT_STAT_FILE;
-            } else if (name[len] == '/') {
-                return MP_IMPORT_STAT_DIR;
-            }
-        }
-        name += l + 1;
+    if (mp_frozen_find(names, index, count, str, len, 0) >= 0) {
+        return MP_IMPORT_STAT_FILE;
+    }
+    if (mp_frozen_find(names, index, count, str, len, '/') >= 0) {
+        return MP_IMPORT_STAT_DIR;
     }
     return MP_IMPORT_STAT_NO_EXIST;
 }
@@ -124,14 +142,14 @@ mp_import_stat_t mp_frozen_stat(const char *str) {
     mp_import_stat_t stat;
 
     #if MICROPY_MODULE_FROZEN_STR
-    stat = mp_frozen_stat_helper(mp_frozen_str_names, str);
+    stat = mp_frozen_stat_helper(mp_frozen_str_names, mp_frozen_str_index, mp_frozen_str_count, str);
     if (stat != MP_IMPORT_STAT_NO_EXIST) {
         return stat;
     }
     #endif
 
     #if MICROPY_MODULE_FROZEN_MPY
-    stat = mp_frozen_stat_helper(mp_frozen_mpy_names, str);
+    stat = mp_frozen_stat_helper(mp_frozen_mpy_names, mp_frozen_mpy_index, mp_frozen_mpy_count, str);
     if (stat != MP_IMPORT_STAT_NO_EXIST) {
         return stat;
     }
@@ -30,6 +30,7 @@
 
 #include "py/gc.h"
 #include "py/runtime.h"
+#include "py/bc.h"
 
 #if MICROPY_ENABLE_GC
 
@@ -69,11 +70,30 @@
 
 #define BLOCK_SHIFT(block) (2 * ((block) & (BLOCKS_PER_ATB - 1)))
 #define ATB_GET_KIND(block) ((MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] >> BLOCK_SHIFT(block)) & 3)
-#define ATB_ANY_TO_FREE(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] &= (~(AT_MARK << BLOCK_SHIFT(block))); } while (0)
-#define ATB_FREE_TO_HEAD(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (AT_HEAD << BLOCK_SHIFT(block)); } while (0)
-#define ATB_FREE_TO_TAIL(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (AT_TAIL << BLOCK_SHIFT(block)); } while (0)
-#define ATB_HEAD_TO_MARK(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (AT_MARK << BLOCK_SHIFT(block)); } while (0)
-#define ATB_MARK_TO_HEAD(block) do { MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] &= (~(AT_TAIL << BLOCK_SHIFT(block))); } while (0)
+
+#if MICROPY_GC_THREAD_ALLOC_BUFFER
+// Threads split blocks off their allocation buffer without holding the GC
+// lock, while other blocks described by the same byte may change under the
+// lock, so updates of the table must be atomic.  That includes the sweep,
+// because a thread stopped part way through a split finishes it once the
+// collection lets it go.
+#define ATB_AND(block, bits) __atomic_fetch_and(&MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (byte)(bits), __ATOMIC_RELAXED)
+#define ATB_OR(block, bits) __atomic_fetch_or(&MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (byte)(bits), __ATOMIC_RELAXED)
+#define ATB_XOR(block, bits) __atomic_fetch_xor(&MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (byte)(bits), __ATOMIC_RELAXED)
+#else
+#define ATB_AND(block, bits) (MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] &= (bits))
+#define ATB_OR(block, bits) (MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] |= (bits))
+#define ATB_XOR(block, bits) (MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB] ^= (bits))
+#endif
+
+#define ATB_ANY_TO_FREE(block) do { ATB_AND(block, ~(AT_MARK << BLOCK_SHIFT(block))); } while (0)
+#define ATB_FREE_TO_HEAD(block) do { ATB_OR(block, AT_HEAD << BLOCK_SHIFT(block)); } while (0)
+#define ATB_FREE_TO_TAIL(block) do { ATB_OR(block, AT_TAIL << BLOCK_SHIFT(block)); } while (0)
+#define ATB_HEAD_TO_MARK(block) do { ATB_OR(block, AT_MARK << BLOCK_SHIFT(block)); } while (0)
+#define ATB_TAIL_TO_HEAD(block) do { ATB_XOR(block, AT_MARK << BLOCK_SHIFT(block)); } while (0)
+// for the sweep only
+#define ATB_MARK_TO_HEAD(block) do { ATB_AND(block, ~(AT_TAIL << BLOCK_SHIFT(block))); } while (0)
+#define ATB_SWEEP_TO_FREE(block) do { ATB_AND(block, ~(AT_MARK << BLOCK_SHIFT(block))); } while (0)
 
 #define BLOCK_FROM_PTR(ptr) (((byte*)(ptr) - MP_STATE_MEM(gc_pool_start)) / BYTES_PER_BLOCK)
 #define PTR_FROM_BLOCK(block) (((block) * BYTES_PER_BLOCK + (uintptr_t)MP_STATE_MEM(gc_pool_start)))
@@ -98,6 +118,26 @@
 #define GC_EXIT()
 #endif
 
+#if MICROPY_GC_THREAD_ALLOC_BUFFER && !(MICROPY_PY_THREAD && !MICROPY_PY_THREAD_GIL)
+#error MICROPY_GC_THREAD_ALLOC_BUFFER requires threads without the GIL
+#endif
+
+#if MICROPY_GC_STACK_GROW && !defined(MP_PLAT_ALLOC_GC_STACK)
+#error MICROPY_GC_STACK_GROW requires MP_PLAT_ALLOC_GC_STACK and MP_PLAT_FREE_GC_STACK
+#endif
+
+#if MICROPY_GC_PARALLEL_MARK && !(MICROPY_PY_THREAD && MICROPY_GC_STACK_GROW)
+#error MICROPY_GC_PARALLEL_MARK requires MICROPY_PY_THREAD and MICROPY_GC_STACK_GROW
+#endif
+
+#if MICROPY_GC_PARALLEL_MARK
+// Several threads may mark at once, so the mark is set atomically, and only the
+// thread that turned the head into a mark goes on to look at its children.
+#define ATB_HEAD_TO_MARK_ONCE(block) (((__atomic_fetch_or(&MP_STATE_MEM(gc_alloc_table_start)[(block) / BLOCKS_PER_ATB], (byte)(AT_MARK << BLOCK_SHIFT(block)), __ATOMIC_RELAXED) >> BLOCK_SHIFT(block)) & 3) == AT_HEAD)
+#else
+#define ATB_HEAD_TO_MARK_ONCE(block) (ATB_OR(block, AT_MARK << BLOCK_SHIFT(block)), true)
+#endif
+
 #ifdef LOG_HEAP_ACTIVITY
 volatile uint32_t change_me;
 #pragma GCC push_options
@@ -109,6 +149,71 @@ void __attribute__ ((noinline)) gc_log_change(uint32_t start_block, uint32_t len
 #pragma GCC pop_options
 #endif
 
+#if MICROPY_GC_ALLOC_SITES
+gc_alloc_sites_t gc_alloc_sites;
+
+// Returns the C function that asked for an allocation: the caller of the
+// m_malloc function if there was one, otherwise ret_addr.
+STATIC void *gc_alloc_site_caller(void *ret_addr) {
+    void *caller = MP_STATE_THREAD(gc_alloc_caller);
+    MP_STATE_THREAD(gc_alloc_caller) = NULL;
+    return caller != NULL ? caller : ret_addr;
+}
+
+// Must be called with the GC lock held.
+STATIC void gc_alloc_site_record(void *caller, size_t n_bytes, bool ok) {
+    qstr source_file = MP_QSTR_NULL;
+    qstr block_name = MP_QSTR_NULL;
+    uintptr_t line = (uintptr_t)caller;
+    const mp_code_state_t *code_state = MP_STATE_THREAD(current_code_state);
+    if (code_state != NULL) {
+        line = mp_bytecode_get_source_line(code_state->fun_bc, code_state->ip, &block_name, &source_file);
+    }
+
+    // The busiest sites are at the start so a linear search is quick.
+    gc_alloc_site_t *site = gc_alloc_sites.sites;
+    size_t i = 0;
+    for (; i < gc_alloc_sites.len; i++, site++) {
+        if (site->line == line && site->block_name == block_name && site->source_file == source_file) {
+            break;
+        }
+    }
+    if (i == gc_alloc_sites.len) {
+        if (i == MICROPY_GC_ALLOC_SITES) {
+            i -= 1;
+            site -= 1;
+            gc_alloc_sites.other_count += site->count;
+            gc_alloc_sites.other_bytes += site->bytes;
+        } else {
+            gc_alloc_sites.len += 1;
+        }
+        site->source_file = source_file;
+        site->block_name = block_name;
+        site->line = line;
+        site->count = 0;
+        site->bytes = 0;
+        site->failed = 0;
+    }
+    if (ok) {
+        site->count += 1;
+        site->bytes += n_bytes;
+    } else {
+        site->failed += 1;
+    }
+
+    // bytes only increases so one pass keeps the table sorted.
+    for (; i > 0 && site[-1].bytes < site->bytes; i--, site--) {
+        gc_alloc_site_t tmp = site[-1];
+        site[-1] = *site;
+        *site = tmp;
+    }
+}
+#endif
+
+#if MICROPY_GC_STACK_GROW
+STATIC void gc_stack_free(mp_gc_stack_t *stack);
+#endif
+
 // TODO waste less memory; currently requires that all entries in alloc_table have a corresponding block in pool
 void gc_init(void *start, void *end) {
     // align end pointer on block boundary
@@ -174,6 +279,33 @@ void gc_init(void *start, void *end) {
     mp_thread_mutex_init(&MP_STATE_MEM(gc_mutex));
     #endif
 
+    #if MICROPY_GC_STACK_GROW
+    gc_stack_free(&MP_STATE_MEM(gc_mark_stack));
+    MP_STATE_MEM(gc_mark_stack).blocks = MP_STATE_MEM(gc_stack);
+    MP_STATE_MEM(gc_mark_stack).sp = 0;
+    MP_STATE_MEM(gc_mark_stack).len = MICROPY_ALLOC_GC_STACK_SIZE;
+    #endif
+
+    #if MICROPY_GC_PARALLEL_MARK
+    mp_thread_mutex_init(&MP_STATE_MEM(gc_mark_mutex));
+    gc_stack_free(&MP_STATE_MEM(gc_mark_pool));
+    MP_STATE_MEM(gc_mark_pool).blocks = NULL;
+    MP_STATE_MEM(gc_mark_pool).sp = 0;
+    MP_STATE_MEM(gc_mark_pool).len = 0;
+    MP_STATE_MEM(gc_mark_n_markers) = 0;
+    MP_STATE_MEM(gc_mark_n_idle) = 0;
+    MP_STATE_MEM(gc_mark_parallel) = false;
+    #endif
+
+    #if MICROPY_GC_THREAD_ALLOC_BUFFER
+    memset(&MP_STATE_THREAD(gc_alloc_buffer), 0, sizeof(mp_gc_alloc_buffer_t));
+    #endif
+
+    #if MICROPY_GC_ALLOC_SITES
+    // Any dynamic qstrs in the table were in the old heap.
+    gc_clear_alloc_sites();
+    #endif
+
     DEBUG_printf("GC layout:\n");
     DEBUG_printf("  alloc table at %p, length " UINT_FMT " bytes, " UINT_FMT " blocks\n", MP_STATE_MEM(gc_alloc_table_start), MP_STATE_MEM(gc_alloc_table_byte_len), MP_STATE_MEM(gc_alloc_table_byte_len) * BLOCKS_PER_ATB);
 #if MICROPY_ENABLE_FINALISER
@@ -213,6 +345,214 @@ bool gc_is_locked(void) {
 #endif
 #endif
 
+#if MICROPY_GC_STACK_GROW
+
+// A stack that has grown keeps its memory for the following collections, so
+// that they don't have to fault in fresh pages again.  Only a stack that has
+// grown is bigger than its initial fixed array.
+STATIC void gc_stack_free(mp_gc_stack_t *stack) {
+    if (stack->len > MICROPY_ALLOC_GC_STACK_SIZE) {
+        MP_PLAT_FREE_GC_STACK(stack->blocks, stack->len * sizeof(size_t));
+    }
+}
+
+// Move the stack to memory twice its current size, or to its first memory if
+// it has none.  Returns false if there isn't any to be had, leaving the stack
+// as it was.
+STATIC bool gc_stack_grow(mp_gc_stack_t *stack) {
+    size_t len = stack->len * 2;
+    if (len < 2 * MICROPY_ALLOC_GC_STACK_SIZE) {
+        len = 2 * MICROPY_ALLOC_GC_STACK_SIZE;
+    }
+    size_t *blocks = MP_PLAT_ALLOC_GC_STACK(len * sizeof(size_t));
+    if (blocks == NULL) {
+        return false;
+    }
+    if (stack->sp > 0) {
+        memcpy(blocks, stack->blocks, stack->sp * sizeof(size_t));
+    }
+    gc_stack_free(stack);
+    stack->blocks = blocks;
+    stack->len = len;
+    return true;
+}
+
+#if MICROPY_GC_PARALLEL_MARK
+STATIC void gc_mark_share(mp_gc_stack_t *stack);
+#endif
+
+// Pop blocks off the stack until it is empty.  For each one check all its
+// children: mark the unmarked child blocks and push those newly marked blocks
+// on the stack.  The stack is only written back when it has to grow or be
+// shared, so that the loop can keep it in registers.
+STATIC void gc_mark_stack_drain(mp_gc_stack_t *stack) {
+    size_t *blocks = stack->blocks;
+    size_t sp = stack->sp;
+    while (sp > 0) {
+        size_t block = blocks[--sp];
+
+        // work out number of consecutive blocks in the chain starting with this one
+        size_t n_blocks = 0;
+        do {
+            n_blocks += 1;
+        } while (ATB_GET_KIND(block + n_blocks) == AT_TAIL);
+
+        // check this block's children
+        void **ptrs = (void**)PTR_FROM_BLOCK(block);
+        for (size_t i = n_blocks * BYTES_PER_BLOCK / sizeof(void*); i > 0; i--, ptrs++) {
+            void *ptr = *ptrs;
+            if (VERIFY_PTR(ptr)) {
+                // Mark and push this pointer
+                size_t childblock = BLOCK_FROM_PTR(ptr);
+                if (ATB_GET_KIND(childblock) == AT_HEAD && ATB_HEAD_TO_MARK_ONCE(childblock)) {
+                    // an unmarked head, mark it, and push it on gc stack
+                    TRACE_MARK(childblock, ptr);
+                    if (sp == stack->len) {
+                        stack->sp = sp;
+                        if (!gc_stack_grow(stack)) {
+                            MP_STATE_MEM(gc_stack_overflow) = 1;
+                            continue;
+                        }
+                        blocks = stack->blocks;
+                    }
+                    blocks[sp++] = childblock;
+                }
+            }
+        }
+
+        #if MICROPY_GC_PARALLEL_MARK
+        // During a parallel mark, if another marker is out of work and nobody
+        // has given it any yet, give it some of ours.
+        if (sp > 1 && __atomic_load_n(&MP_STATE_MEM(gc_mark_n_markers), __ATOMIC_RELAXED) > 1
+            && __atomic_load_n(&MP_STATE_MEM(gc_mark_n_idle), __ATOMIC_RELAXED) > 0
+            && __atomic_load_n(&MP_STATE_MEM(gc_mark_pool).sp, __ATOMIC_RELAXED) == 0) {
+            stack->sp = sp;
+            gc_mark_share(stack);
+            sp = stack->sp;
+        }
+        #endif
+    }
+    stack->sp = 0;
+}
+
+// Mark the children of the given (already marked) block and all their
+// children in turn.  During a parallel collection the block is only pushed,
+// and the markers look at it in gc_collect_mark_end.
+STATIC void gc_mark_subtree(size_t block) {
+    mp_gc_stack_t *stack = &MP_STATE_MEM(gc_mark_stack);
+    if (stack->sp == stack->len && !gc_stack_grow(stack)) {
+        MP_STATE_MEM(gc_stack_overflow) = 1;
+        return;
+    }
+    stack->blocks[stack->sp++] = block;
+    #if MICROPY_GC_PARALLEL_MARK
+    if (MP_STATE_MEM(gc_mark_parallel)) {
+        return;
+    }
+    #endif
+    gc_mark_stack_drain(stack);
+}
+
+#if MICROPY_GC_PARALLEL_MARK
+
+// Hand the bottom half of the stack, the blocks pushed longest ago and so
+// likely to have the most below them, over to the markers that are idle.
+STATIC void gc_mark_share(mp_gc_stack_t *stack) {
+    mp_gc_stack_t *pool = &MP_STATE_MEM(gc_mark_pool);
+    size_t n = stack->sp / 2;
+    mp_thread_mutex_lock(&MP_STATE_MEM(gc_mark_mutex), 1);
+    while (pool->sp + n > pool->len) {
+        if (!gc_stack_grow(pool)) {
+            n = pool->len - pool->sp;
+            break;
+        }
+    }
+    if (n == 0) {
+        mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+        return;
+    }
+    memcpy(pool->blocks + pool->sp, stack->blocks, n * sizeof(size_t));
+    __atomic_store_n(&pool->sp, pool->sp + n, __ATOMIC_RELAXED);
+    mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+    memmove(stack->blocks, stack->blocks + n, (stack->sp - n) * sizeof(size_t));
+    stack->sp -= n;
+}
+
+// Called by a marker whose stack is empty.  Waits until another marker shares
+// some blocks and moves them to the stack, or returns false once all markers
+// are out of work, which means that the mark is complete.
+STATIC bool gc_mark_take(mp_gc_stack_t *stack) {
+    mp_gc_stack_t *pool = &MP_STATE_MEM(gc_mark_pool);
+    mp_thread_mutex_lock(&MP_STATE_MEM(gc_mark_mutex), 1);
+    __atomic_store_n(&MP_STATE_MEM(gc_mark_n_idle), MP_STATE_MEM(gc_mark_n_idle) + 1, __ATOMIC_RELAXED);
+    for (;;) {
+        // Leave some behind for any other idle markers.
+        size_t n = (pool->sp + 1) / 2;
+        while (n > stack->len && gc_stack_grow(stack)) {
+        }
+        if (n > stack->len) {
+            n = stack->len;
+        }
+        if (n > 0) {
+            __atomic_store_n(&pool->sp, pool->sp - n, __ATOMIC_RELAXED);
+            memcpy(stack->blocks, pool->blocks + pool->sp, n * sizeof(size_t));
+            stack->sp = n;
+            __atomic_store_n(&MP_STATE_MEM(gc_mark_n_idle), MP_STATE_MEM(gc_mark_n_idle) - 1, __ATOMIC_RELAXED);
+            mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+            return true;
+        }
+        if (MP_STATE_MEM(gc_mark_n_idle) == MP_STATE_MEM(gc_mark_n_markers)) {
+            MP_STATE_MEM(gc_mark_done) = true;
+            mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+            return false;
+        }
+        mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+        while (__atomic_load_n(&pool->sp, __ATOMIC_RELAXED) == 0
+            && __atomic_load_n(&MP_STATE_MEM(gc_mark_n_idle), __ATOMIC_RELAXED)
+                != __atomic_load_n(&MP_STATE_MEM(gc_mark_n_markers), __ATOMIC_RELAXED)) {
+            mp_thread_yield();
+        }
+        mp_thread_mutex_lock(&MP_STATE_MEM(gc_mark_mutex), 1);
+    }
+}
+
+void gc_mark_helper(struct _mp_gc_stack_t *stack) {
+    mp_thread_mutex_lock(&MP_STATE_MEM(gc_mark_mutex), 1);
+    if (MP_STATE_MEM(gc_mark_done)) {
+        // Started too late to be of any use.
+        mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+        return;
+    }
+    __atomic_store_n(&MP_STATE_MEM(gc_mark_n_markers), MP_STATE_MEM(gc_mark_n_markers) + 1, __ATOMIC_RELAXED);
+    mp_thread_mutex_unlock(&MP_STATE_MEM(gc_mark_mutex));
+    while (gc_mark_take(stack)) {
+        gc_mark_stack_drain(stack);
+    }
+}
+
+// Mark everything reachable from the blocks pushed by gc_collect_root, with
+// the help of any threads the port can spare.
+STATIC void gc_mark_in_parallel(void) {
+    MP_STATE_MEM(gc_mark_parallel) = false;
+    MP_STATE_MEM(gc_mark_n_markers) = 1;
+    MP_STATE_MEM(gc_mark_n_idle) = 0;
+    MP_STATE_MEM(gc_mark_done) = false;
+    mp_gc_stack_t *stack = &MP_STATE_MEM(gc_mark_stack);
+    mp_thread_gc_mark_start();
+    do {
+        gc_mark_stack_drain(stack);
+    } while (gc_mark_take(stack));
+    mp_thread_gc_mark_wait();
+    // The mark is over, so a later drain, eg in gc_deal_with_stack_overflow,
+    // must keep all of its stack rather than share it with the markers.
+    MP_STATE_MEM(gc_mark_n_markers) = 0;
+    MP_STATE_MEM(gc_mark_n_idle) = 0;
+}
+
+#endif // MICROPY_GC_PARALLEL_MARK
+
+#else // MICROPY_GC_STACK_GROW
+
 // Take the given block as the topmost block on the stack. Check all it's
 // children: mark the unmarked child blocks and put those newly marked
 // blocks on the stack. When all children have been checked, pop off the
@@ -257,6 +597,8 @@ STATIC void gc_mark_subtree(size_t block) {
     }
 }
 
+#endif // MICROPY_GC_STACK_GROW
+
 STATIC void gc_deal_with_stack_overflow(void) {
     while (MP_STATE_MEM(gc_stack_overflow)) {
         MP_STATE_MEM(gc_stack_overflow) = 0;
@@ -303,7 +645,7 @@ STATIC void gc_sweep(void) {
                 }
 #endif
                 free_tail = 1;
-                ATB_ANY_TO_FREE(block);
+                ATB_SWEEP_TO_FREE(block);
                 #if CLEAR_ON_SWEEP
                 memset((void*)PTR_FROM_BLOCK(block), 0, BYTES_PER_BLOCK);
                 #endif
@@ -319,7 +661,7 @@ STATIC void gc_sweep(void) {
 
             case AT_TAIL:
                 if (free_tail) {
-                    ATB_ANY_TO_FREE(block);
+                    ATB_SWEEP_TO_FREE(block);
                     #if CLEAR_ON_SWEEP
                     memset((void*)PTR_FROM_BLOCK(block), 0, BYTES_PER_BLOCK);
                     #endif
@@ -337,10 +679,21 @@ STATIC void gc_sweep(void) {
 void gc_collect_start(void) {
     GC_ENTER();
     MP_STATE_MEM(gc_lock_depth)++;
+    #if MICROPY_GC_THREAD_ALLOC_BUFFER
+    // From here on other threads allocate under the GC lock, and so wait for
+    // the collection to end.  Pairs with the fence in gc_alloc: either the
+    // thread sees the lock, or everything it stored is visible to the mark.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    #endif
     #if MICROPY_GC_ALLOC_THRESHOLD
     MP_STATE_MEM(gc_alloc_amount) = 0;
     #endif
     MP_STATE_MEM(gc_stack_overflow) = 0;
+    #if MICROPY_GC_PARALLEL_MARK
+    // On a big heap just mark the roots as they are found, and leave tracing
+    // what they point to until gc_collect_mark_end, when it can be done in parallel.
+    MP_STATE_MEM(gc_mark_parallel) = (size_t)(MP_STATE_MEM(gc_pool_end) - MP_STATE_MEM(gc_pool_start)) >= MICROPY_GC_PARALLEL_MARK_MIN_BYTES;
+    #endif
 
     // Trace root pointers.  This relies on the root pointers being organised
     // correctly in the mp_state_ctx structure.  We scan nlr_top, dict_locals,
@@ -355,6 +708,10 @@ void gc_collect_start(void) {
     ptrs = (void**)(void*)MP_STATE_THREAD(pystack_start);
     gc_collect_root(ptrs, (MP_STATE_THREAD(pystack_cur) - MP_STATE_THREAD(pystack_start)) / sizeof(void*));
     #endif
+
+    #if MICROPY_GC_THREAD_ALLOC_BUFFER
+    gc_collect_alloc_buffer();
+    #endif
 }
 
 void gc_collect_root(void **ptrs, size_t len) {
@@ -372,8 +729,18 @@ void gc_collect_root(void **ptrs, size_t len) {
     }
 }
 
-void gc_collect_end(void) {
+void gc_collect_mark_end(void) {
+    #if MICROPY_GC_PARALLEL_MARK
+    if (MP_STATE_MEM(gc_mark_parallel)) {
+        gc_mark_in_parallel();
+    }
+    #endif
     gc_deal_with_stack_overflow();
+}
+
+void gc_collect_end(void) {
+    // does nothing if the port has already called it
+    gc_collect_mark_end();
     gc_sweep();
     MP_STATE_MEM(gc_first_free_atb_index) = 0;
     MP_STATE_MEM(gc_last_free_atb_index) = MP_STATE_MEM(gc_alloc_table_byte_len) - 1;
@@ -385,6 +752,9 @@ void gc_sweep_all(void) {
     GC_ENTER();
     MP_STATE_MEM(gc_lock_depth)++;
     MP_STATE_MEM(gc_stack_overflow) = 0;
+    #if MICROPY_GC_PARALLEL_MARK
+    MP_STATE_MEM(gc_mark_parallel) = false;
+    #endif
     gc_collect_end();
 }
 
@@ -452,21 +822,148 @@ void gc_info(gc_info_t *info) {
     GC_EXIT();
 }
 
+#if MICROPY_GC_THREAD_ALLOC_BUFFER
+
+// Objects up to this many blocks are taken from the allocation buffer.
+#define ALLOC_BUFFER_MAX_BLOCKS (MICROPY_GC_THREAD_ALLOC_BUFFER / 4)
+
+// Take n_blocks from the front of the calling thread's buffer without taking
+// the GC lock, or return NULL if the run is too short.  A collection only
+// looks at the buffer from this thread (see gc_collect_alloc_buffer), so
+// the stores need to be ordered for a signal handler but not for other CPUs.
+STATIC void *gc_alloc_buffer_take(mp_gc_alloc_buffer_t *buf, size_t n_blocks) {
+    size_t block = buf->next_block;
+    // next_block is past end_block after a collection cut a take short
+    if (block >= buf->end_block || buf->end_block - block < n_blocks) {
+        return NULL;
+    }
+    buf->last_block = block;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    if (block + n_blocks < buf->end_block) {
+        // the rest of the run becomes a chain of its own
+        ATB_TAIL_TO_HEAD(block + n_blocks);
+    }
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    buf->next_block = block + n_blocks;
+    return (void*)PTR_FROM_BLOCK(block);
+}
+
+// Mark what is left of the calling thread's buffer and stop it taking any
+// more blocks from it.  gc_collect_start calls this for the collecting thread,
+// and the port's gc_collect must call it from each other thread while it has
+// the thread stopped, and keep it stopped until gc_collect_mark_end returns.
+// The thread may have been stopped part way through gc_alloc_buffer_take, so
+// everything from the start of the last object taken is marked.  It finishes
+// that take when it carries on, maybe during the sweep, so the rest of the
+// run can't be used again: it is freed by the next collection.
+void gc_collect_alloc_buffer(void) {
+    mp_gc_alloc_buffer_t *buf = &MP_STATE_THREAD(gc_alloc_buffer);
+    for (size_t bl = buf->last_block; bl < buf->end_block; bl++) {
+        void *ptr = (void*)PTR_FROM_BLOCK(bl);
+        gc_collect_root(&ptr, 1);
+    }
+    buf->end_block = 0;
+}
+
+// Claim the first run of free blocks in the heap, up to the buffer size, for
+// the buffer.  Runs too short for n_blocks are passed over as they are, and
+// like the unused end of the old run they are chains that nothing refers to,
+// so the next collection sweeps them.  Taking the first run each time means
+// gc_first_free_atb_index always moves forward.  Returns false if there is no
+// free run or if a collection is due, and the caller takes the slow path.
+STATIC bool gc_alloc_buffer_refill(mp_gc_alloc_buffer_t *buf, size_t n_blocks) {
+    GC_ENTER();
+    // a collection can't start until GC_EXIT, so it sees the old run or the
+    // new one and never a mix
+    buf->last_block = buf->next_block = buf->end_block = 0;
+    #if MICROPY_GC_ALLOC_THRESHOLD
+    if (MP_STATE_MEM(gc_auto_collect_enabled)
+        && MP_STATE_MEM(gc_alloc_amount) >= MP_STATE_MEM(gc_alloc_threshold)) {
+        GC_EXIT();
+        return false;
+    }
+    #endif
+    size_t bl = MP_STATE_MEM(gc_first_free_atb_index) * BLOCKS_PER_ATB;
+    size_t end = (MP_STATE_MEM(gc_last_free_atb_index) + 1) * BLOCKS_PER_ATB;
+    size_t start_block;
+    size_t n_free;
+    do {
+        while (bl < end && ATB_GET_KIND(bl) != AT_FREE) {
+            bl++;
+        }
+        if (bl == end) {
+            GC_EXIT();
+            return false;
+        }
+        start_block = bl;
+        while (bl < end && bl - start_block < MICROPY_GC_THREAD_ALLOC_BUFFER && ATB_GET_KIND(bl) == AT_FREE) {
+            bl++;
+        }
+        n_free = bl - start_block;
+        ATB_FREE_TO_HEAD(start_block);
+        for (size_t b = start_block + 1; b < bl; b++) {
+            ATB_FREE_TO_TAIL(b);
+        }
+        MP_STATE_MEM(gc_first_free_atb_index) = bl / BLOCKS_PER_ATB;
+    } while (n_free < n_blocks);
+    memset((void*)PTR_FROM_BLOCK(start_block), 0, n_free * BYTES_PER_BLOCK);
+    #if MICROPY_GC_ALLOC_THRESHOLD
+    MP_STATE_MEM(gc_alloc_amount) += n_free;
+    #endif
+    buf->last_block = buf->next_block = start_block;
+    buf->end_block = start_block + n_free;
+    GC_EXIT();
+    return true;
+}
+
+#endif
+
 // We place long lived objects at the end of the heap rather than the start. This reduces
 // fragmentation by localizing the heap churn to one portion of memory (the start of the heap.)
 void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
     size_t n_blocks = ((n_bytes + BYTES_PER_BLOCK - 1) & (~(BYTES_PER_BLOCK - 1))) / BYTES_PER_BLOCK;
     DEBUG_printf("gc_alloc(" UINT_FMT " bytes -> " UINT_FMT " blocks)\n", n_bytes, n_blocks);
 
+    #if MICROPY_GC_ALLOC_SITES
+    void *caller = gc_alloc_site_caller(__builtin_return_address(0));
+    #endif
+
     // check for 0 allocation
     if (n_blocks == 0) {
         return NULL;
     }
 
+    #if MICROPY_GC_THREAD_ALLOC_BUFFER
+    // Small objects come from the thread's own buffer, which was zeroed when
+    // it was claimed.  Once a collection has started they come from the slow
+    // path, which waits for it to end (see gc_collect_start).
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (n_blocks <= ALLOC_BUFFER_MAX_BLOCKS && !has_finaliser && !long_lived
+        && __atomic_load_n(&MP_STATE_MEM(gc_lock_depth), __ATOMIC_RELAXED) == 0) {
+        mp_gc_alloc_buffer_t *buf = &MP_STATE_THREAD(gc_alloc_buffer);
+        void *ret_ptr = gc_alloc_buffer_take(buf, n_blocks);
+        if (ret_ptr == NULL && gc_alloc_buffer_refill(buf, n_blocks)) {
+            ret_ptr = gc_alloc_buffer_take(buf, n_blocks);
+        }
+        if (ret_ptr != NULL) {
+            #if MICROPY_GC_ALLOC_SITES
+            // The site table is shared, so this gives up the lock-free path.
+            GC_ENTER();
+            gc_alloc_site_record(caller, n_blocks * BYTES_PER_BLOCK, true);
+            GC_EXIT();
+            #endif
+            return ret_ptr;
+        }
+    }
+    #endif
+
     GC_ENTER();
 
     // check if GC is locked
     if (MP_STATE_MEM(gc_lock_depth) > 0) {
+        #if MICROPY_GC_ALLOC_SITES
+        gc_alloc_site_record(caller, n_bytes, false);
+        #endif
         GC_EXIT();
         return NULL;
     }
@@ -530,11 +1027,15 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
             break;
         }
 
-        GC_EXIT();
         // nothing found!
         if (collected) {
+            #if MICROPY_GC_ALLOC_SITES
+            gc_alloc_site_record(caller, n_bytes, false);
+            #endif
+            GC_EXIT();
             return NULL;
         }
+        GC_EXIT();
         DEBUG_printf("gc_alloc(" UINT_FMT "): no free mem, triggering GC\n", n_bytes);
         gc_collect();
         collected = true;
@@ -593,6 +1094,10 @@ void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived) {
     MP_STATE_MEM(gc_alloc_amount) += n_blocks;
     #endif
 
+    #if MICROPY_GC_ALLOC_SITES
+    gc_alloc_site_record(caller, n_blocks * BYTES_PER_BLOCK, true);
+    #endif
+
     GC_EXIT();
 
     #if MICROPY_GC_CONSERVATIVE_CLEAR
@@ -785,6 +1290,10 @@ void *gc_realloc(void *ptr_in, size_t n_bytes, bool allow_move) {
         return gc_alloc(n_bytes, false, false);
     }
 
+    #if MICROPY_GC_ALLOC_SITES
+    void *caller = gc_alloc_site_caller(__builtin_return_address(0));
+    #endif
+
     // check for pure free
     if (n_bytes == 0) {
         gc_free(ptr_in);
@@ -876,6 +1385,10 @@ void *gc_realloc(void *ptr_in, size_t n_bytes, bool allow_move) {
             ATB_FREE_TO_TAIL(bl);
         }
 
+        #if MICROPY_GC_ALLOC_SITES
+        gc_alloc_site_record(caller, (new_blocks - n_blocks) * BYTES_PER_BLOCK, true);
+        #endif
+
         GC_EXIT();
 
         #if MICROPY_GC_CONSERVATIVE_CLEAR
@@ -911,6 +1424,9 @@ void *gc_realloc(void *ptr_in, size_t n_bytes, bool allow_move) {
     }
 
     // can't resize inplace; try to find a new contiguous chain
+    #if MICROPY_GC_ALLOC_SITES
+    MP_STATE_THREAD(gc_alloc_caller) = caller;
+    #endif
     void *ptr_out = gc_alloc(n_bytes, ftb_state, false);
 
     // check that the alloc succeeded
@@ -934,6 +1450,32 @@ void gc_dump_info(void) {
            (uint)info.num_1block, (uint)info.num_2block, (uint)info.max_block, (uint)info.max_free);
 }
 
+#if MICROPY_GC_ALLOC_SITES
+void gc_dump_alloc_sites(void) {
+    GC_ENTER();
+    mp_printf(&mp_plat_print, "   bytes    count failed site\n");
+    for (size_t i = 0; i < gc_alloc_sites.len; i++) {
+        const gc_alloc_site_t *site = &gc_alloc_sites.sites[i];
+        mp_printf(&mp_plat_print, "%8u %8u %6u ", (uint)site->bytes, (uint)site->count, (uint)site->failed);
+        if (site->source_file == MP_QSTR_NULL) {
+            mp_printf(&mp_plat_print, "C %p\n", (void*)site->line);
+        } else {
+            mp_printf(&mp_plat_print, "%q:%u %q\n", site->source_file, (uint)site->line, site->block_name);
+        }
+    }
+    mp_printf(&mp_plat_print, "%8u %8u        other\n", (uint)gc_alloc_sites.other_bytes, (uint)gc_alloc_sites.other_count);
+    GC_EXIT();
+}
+
+void gc_clear_alloc_sites(void) {
+    GC_ENTER();
+    gc_alloc_sites.len = 0;
+    gc_alloc_sites.other_count = 0;
+    gc_alloc_sites.other_bytes = 0;
+    GC_EXIT();
+}
+#endif
+
 void gc_dump_alloc_table(void) {
     GC_ENTER();
     static const size_t DUMP_BYTES_PER_LINE = 64;
@@ -43,7 +43,20 @@ bool gc_is_locked(void);
 void gc_collect(void);
 void gc_collect_start(void);
 void gc_collect_root(void **ptrs, size_t len);
+#if MICROPY_GC_THREAD_ALLOC_BUFFER
+void gc_collect_alloc_buffer(void);
+#endif
+// Finish marking.  A port that stops other threads for a collection can
+// call this and let them go before gc_collect_end sweeps and runs finalisers.
+void gc_collect_mark_end(void);
 void gc_collect_end(void);
+#if MICROPY_GC_PARALLEL_MARK
+// Run by the port's helper threads after mp_thread_gc_mark_start.  Each
+// helper has its own stack, which starts out zeroed and keeps the memory it
+// grows into for later collections.
+struct _mp_gc_stack_t;
+void gc_mark_helper(struct _mp_gc_stack_t *stack);
+#endif
 
 void *gc_alloc(size_t n_bytes, bool has_finaliser, bool long_lived);
 
@@ -70,4 +83,30 @@ void gc_info(gc_info_t *info);
 void gc_dump_info(void);
 void gc_dump_alloc_table(void);
 
+#if MICROPY_GC_ALLOC_SITES
+typedef struct _gc_alloc_site_t {
+    size_t source_file; // qstr, or MP_QSTR_NULL for an allocation made from C
+    size_t block_name; // qstr
+    uintptr_t line; // or the address of the C caller
+    uint32_t count;
+    uint32_t bytes;
+    uint32_t failed;
+} gc_alloc_site_t;
+
+// Sites are kept in order of bytes allocated, largest first.  When the table
+// is full the last site is merged into other_count and other_bytes to make
+// room for a new one.
+typedef struct _gc_alloc_sites_t {
+    size_t len;
+    uint32_t other_count;
+    uint32_t other_bytes;
+    gc_alloc_site_t sites[MICROPY_GC_ALLOC_SITES];
+} gc_alloc_sites_t;
+
+extern gc_alloc_sites_t gc_alloc_sites;
+
+void gc_dump_alloc_sites(void);
+void gc_clear_alloc_sites(void);
+#endif
+
 #endif // MICROPY_INCLUDED_PY_GC_H
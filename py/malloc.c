@@ -77,7 +77,19 @@ STATIC void *realloc_ext(void *ptr, size_t n_bytes, bool allow_move) {
 }
 #endif // MICROPY_ENABLE_GC
 
+#if MICROPY_GC_ALLOC_SITES
+// Tell the GC which C function is allocating, unless an outer m_malloc
+// function (eg m_malloc0) already did.  The GC clears it once used.
+#define SET_ALLOC_CALLER() \
+    if (MP_STATE_THREAD(gc_alloc_caller) == NULL) { \
+        MP_STATE_THREAD(gc_alloc_caller) = __builtin_return_address(0); \
+    }
+#else
+#define SET_ALLOC_CALLER()
+#endif
+
 void *m_malloc(size_t num_bytes, bool long_lived) {
+    SET_ALLOC_CALLER();
     void *ptr = malloc_ll(num_bytes, long_lived);
     if (ptr == NULL && num_bytes != 0) {
         m_malloc_fail(num_bytes);
@@ -92,6 +104,7 @@ void *m_malloc(size_t num_bytes, bool long_lived) {
 }
 
 void *m_malloc_maybe(size_t num_bytes, bool long_lived) {
+    SET_ALLOC_CALLER();
     void *ptr = malloc_ll(num_bytes, long_lived);
 #if MICROPY_MEM_STATS
     MP_STATE_MEM(total_bytes_allocated) += num_bytes;
@@ -104,6 +117,7 @@ void *m_malloc_maybe(size_t num_bytes, bool long_lived) {
 
 #if MICROPY_ENABLE_FINALISER
 void *m_malloc_with_finaliser(size_t num_bytes) {
+    SET_ALLOC_CALLER();
     void *ptr = malloc_with_finaliser(num_bytes);
     if (ptr == NULL && num_bytes != 0) {
         m_malloc_fail(num_bytes);
@@ -119,6 +133,7 @@ void *m_malloc_with_finaliser(size_t num_bytes) {
 #endif
 
 void *m_malloc0(size_t num_bytes, bool long_lived) {
+    SET_ALLOC_CALLER();
     void *ptr = m_malloc(num_bytes, long_lived);
     // If this config is set then the GC clears all memory, so we don't need to.
     #if !MICROPY_GC_CONSERVATIVE_CLEAR
@@ -132,6 +147,7 @@ void *m_realloc(void *ptr, size_t old_num_bytes, size_t new_num_bytes) {
 #else
 void *m_realloc(void *ptr, size_t new_num_bytes) {
 #endif
+    SET_ALLOC_CALLER();
     void *new_ptr = realloc(ptr, new_num_bytes);
     if (new_ptr == NULL && new_num_bytes != 0) {
         m_malloc_fail(new_num_bytes);
@@ -160,6 +176,7 @@ void *m_realloc_maybe(void *ptr, size_t old_num_bytes, size_t new_num_bytes, boo
 #else
 void *m_realloc_maybe(void *ptr, size_t new_num_bytes, bool allow_move) {
 #endif
+    SET_ALLOC_CALLER();
     void *new_ptr = realloc_ext(ptr, new_num_bytes, allow_move);
 #if MICROPY_MEM_STATS
     // At first thought, "Total bytes allocated" should only grow,
@@ -51,30 +51,158 @@ const mp_map_t mp_const_empty_map = {
     .table = NULL,
 };
 
-// This table of sizes is used to control the growth of hash tables.
-// The first set of sizes are chosen so the allocation fits exactly in a
-// 4-word GC block, and it's not so important for these small values to be
-// prime.  The latter sizes are prime and increase at an increasing rate.
-STATIC const uint16_t hash_allocation_sizes[] = {
-    0, 2, 4, 6, 8, 10, 12, // +2
-    17, 23, 29, 37, 47, 59, 73, // *1.25
-    97, 127, 167, 223, 293, 389, 521, 691, 919, 1223, 1627, 2161, // *1.33
-    3229, 4831, 7243, 10861, 16273, 24407, 36607, 54907, // *1.5
-};
+/******************************************************************************/
+/* map                                                                        */
 
-STATIC size_t get_hash_alloc_greater_or_equal_to(size_t x) {
-    for (size_t i = 0; i < MP_ARRAY_SIZE(hash_allocation_sizes); i++) {
-        if (hash_allocation_sizes[i] >= x) {
-            return hash_allocation_sizes[i];
-        }
+// Hash tables (maps that are not ordered arrays) store their entries in
+// map->table in the order they were added, with room for map->alloc entries.
+// A removed entry has its key set to MP_OBJ_SENTINEL and its space is only
+// reclaimed when the table is rehashed.  Entries after the last one used have
+// a key of MP_OBJ_NULL.
+//
+// Tables with up to MAP_LINEAR_MAX entries are searched directly.  Larger
+// tables are followed, in the same allocation, by a map_index_t header and
+// an index: a power-of-2 sized array of slots which map a hash to an entry
+// and are probed linearly.  A slot holds 0 if it's empty, the position of its
+// entry plus 1, or all ones if its entry was removed.  Slots are 8, 16 or 32
+// bits wide depending on map->alloc, so the index of a small table is small.
+#define MAP_LINEAR_MAX (8)
+
+#define MAP_SLOT_EMPTY (0)
+#define MAP_SLOT_DELETED ((size_t)-1)
+
+typedef struct _map_index_t {
+    size_t filled; // number of entries used, including removed ones
+    size_t shift; // number of bits to shift a hash down by to get a slot
+} map_index_t;
+
+static inline bool map_has_index(const mp_map_t *map) {
+    return !map->is_ordered && map->alloc > MAP_LINEAR_MAX;
+}
+
+static inline map_index_t *map_get_index(const mp_map_t *map) {
+    return (map_index_t*)&map->table[map->alloc];
+}
+
+static inline void *map_get_slots(map_index_t *index) {
+    return index + 1;
+}
+
+STATIC size_t map_slot_size(size_t alloc) {
+    if (alloc < 0xff) {
+        return sizeof(uint8_t);
+    } else if (alloc < 0xffff) {
+        return sizeof(uint16_t);
+    } else {
+        return sizeof(uint32_t);
     }
-    // ran out of primes in the table!
-    // return something sensible, at least make it odd
-    return (x + x / 2) | 1;
 }
 
-/******************************************************************************/
-/* map                                                                        */
+// Number of bits needed to index the slots of a table with alloc entries,
+// keeping it at most 2/3 full.
+STATIC size_t map_index_bits(size_t alloc) {
+    size_t bits = 4;
+    while ((((size_t)2 << bits) / 3) < alloc) {
+        bits += 1;
+    }
+    return bits;
+}
+
+// Number of entries to allocate for a hash table that must hold at least n.
+// Small tables are rounded up to an even size, so they fill whole GC blocks.
+// Larger ones take 5/12, 1/2, 7/12 or 2/3 of the slots of their index, so a
+// table grows by 1.14 to 1.25 times and its index doubles every 4th step.
+STATIC size_t map_alloc_greater_or_equal_to(size_t n) {
+    if (n <= MAP_LINEAR_MAX) {
+        return (n + 1) & ~(size_t)1;
+    }
+    size_t bits = map_index_bits(n);
+    size_t k = (n * 12 + ((size_t)1 << bits) - 1) >> bits;
+    return (k << bits) / 12;
+}
+
+STATIC size_t map_table_bytes(size_t alloc, bool has_index) {
+    size_t n = alloc * sizeof(mp_map_elem_t);
+    if (has_index) {
+        n += sizeof(map_index_t) + (map_slot_size(alloc) << map_index_bits(alloc));
+    }
+    return n;
+}
+
+size_t mp_map_table_bytes(const mp_map_t *map) {
+    return map_table_bytes(map->alloc, map_has_index(map));
+}
+
+STATIC mp_map_elem_t *map_new_table(size_t alloc) {
+    bool has_index = alloc > MAP_LINEAR_MAX;
+    mp_map_elem_t *table = (mp_map_elem_t*)m_new0(byte, map_table_bytes(alloc, has_index));
+    if (has_index) {
+        map_index_t *index = (map_index_t*)&table[alloc];
+        index->shift = 8 * sizeof(size_t) - map_index_bits(alloc);
+    }
+    return table;
+}
+
+static inline MP_ALWAYSINLINE size_t map_slot_get(size_t alloc, const void *slots, size_t pos) {
+    size_t s;
+    if (alloc < 0xff) {
+        s = ((const uint8_t*)slots)[pos];
+        return s == 0xff ? MAP_SLOT_DELETED : s;
+    } else if (alloc < 0xffff) {
+        s = ((const uint16_t*)slots)[pos];
+        return s == 0xffff ? MAP_SLOT_DELETED : s;
+    } else {
+        s = ((const uint32_t*)slots)[pos];
+        return s == 0xffffffff ? MAP_SLOT_DELETED : s;
+    }
+}
+
+static inline MP_ALWAYSINLINE void map_slot_set(size_t alloc, void *slots, size_t pos, size_t s) {
+    // MAP_SLOT_DELETED is truncated to all ones in each width
+    if (alloc < 0xff) {
+        ((uint8_t*)slots)[pos] = s;
+    } else if (alloc < 0xffff) {
+        ((uint16_t*)slots)[pos] = s;
+    } else {
+        ((uint32_t*)slots)[pos] = s;
+    }
+}
+
+// Fibonacci hashing: multiplying spreads hashes that only differ in their
+// high or low bits, such as aligned pointers and consecutive small ints,
+// over the top bits, which select the slot.
+static inline MP_ALWAYSINLINE size_t map_hash_slot(mp_uint_t hash, size_t shift) {
+    const size_t mult = sizeof(size_t) > 4 ? (size_t)0x9e3779b97f4a7c15ULL : (size_t)0x9e3779b9UL;
+    return ((size_t)hash * mult) >> shift;
+}
+
+static inline MP_ALWAYSINLINE mp_uint_t map_hash(mp_obj_t index) {
+    // fast path for the common case of qstr
+    if (MP_OBJ_IS_QSTR(index)) {
+        return qstr_hash(MP_OBJ_QSTR_VALUE(index));
+    } else if (MP_OBJ_IS_SMALL_INT(index)) {
+        // a small int is its own hash
+        return MP_OBJ_SMALL_INT_VALUE(index);
+    } else {
+        return MP_OBJ_SMALL_INT_VALUE(mp_unary_op(MP_UNARY_OP_HASH, index));
+    }
+}
+
+// Two different small ints or qstrs are never equal, so only other objects
+// need a full comparison.
+static inline MP_ALWAYSINLINE bool map_key_equal(mp_obj_t key, mp_obj_t index, bool compare_only_ptrs) {
+    if (key == index) {
+        return true;
+    }
+    if (compare_only_ptrs || key == MP_OBJ_SENTINEL) {
+        return false;
+    }
+    if ((MP_OBJ_IS_SMALL_INT(key) || MP_OBJ_IS_QSTR(key))
+        && (MP_OBJ_IS_SMALL_INT(index) || MP_OBJ_IS_QSTR(index))) {
+        return false;
+    }
+    return mp_obj_equal(key, index);
+}
 
 void mp_map_init(mp_map_t *map, size_t n) {
     if (n == 0) {
@@ -82,7 +210,7 @@ void mp_map_init(mp_map_t *map, size_t n) {
         map->table = NULL;
     } else {
         map->alloc = n;
-        map->table = m_new0(mp_map_elem_t, map->alloc);
+        map->table = map_new_table(n);
     }
     map->used = 0;
     map->all_keys_are_qstrs = 1;
@@ -102,14 +230,14 @@ void mp_map_init_fixed_table(mp_map_t *map, size_t n, const mp_obj_t *table) {
 // Differentiate from mp_map_clear() - semantics is different
 void mp_map_deinit(mp_map_t *map) {
     if (!map->is_fixed) {
-        m_del(mp_map_elem_t, map->table, map->alloc);
+        m_del(byte, map->table, mp_map_table_bytes(map));
     }
     map->used = map->alloc = 0;
 }
 
 void mp_map_clear(mp_map_t *map) {
     if (!map->is_fixed) {
-        m_del(mp_map_elem_t, map->table, map->alloc);
+        m_del(byte, map->table, mp_map_table_bytes(map));
     }
     map->alloc = 0;
     map->used = 0;
@@ -118,23 +246,59 @@ void mp_map_clear(mp_map_t *map) {
     map->table = NULL;
 }
 
+// Move the entries in use to a new table, in order, and build its index.
+// The keys are already known to be distinct so they don't need comparing.
 STATIC void mp_map_rehash(mp_map_t *map) {
     size_t old_alloc = map->alloc;
-    size_t new_alloc = get_hash_alloc_greater_or_equal_to(map->alloc + 1);
+    size_t old_bytes = mp_map_table_bytes(map);
+    // a full table grows to the next size; one that is full of removed
+    // entries keeps some room so that it isn't rehashed again straight away
+    size_t new_alloc = map->used + 1;
+    if (map->used < old_alloc) {
+        new_alloc += map->used / 4;
+    }
+    new_alloc = map_alloc_greater_or_equal_to(new_alloc);
     DEBUG_printf("mp_map_rehash(%p): " UINT_FMT " -> " UINT_FMT "\n", map, old_alloc, new_alloc);
     mp_map_elem_t *old_table = map->table;
-    mp_map_elem_t *new_table = m_new0(mp_map_elem_t, new_alloc);
+    mp_map_elem_t *new_table = map_new_table(new_alloc);
     // If we reach this point, table resizing succeeded, now we can edit the old map.
-    map->alloc = new_alloc;
-    map->used = 0;
+    size_t n = 0;
     map->all_keys_are_qstrs = 1;
+    for (size_t i = 0; i < old_alloc && old_table[i].key != MP_OBJ_NULL; i++) {
+        if (old_table[i].key != MP_OBJ_SENTINEL) {
+            new_table[n++] = old_table[i];
+            if (!MP_OBJ_IS_QSTR(old_table[i].key)) {
+                map->all_keys_are_qstrs = 0;
+            }
+        }
+    }
+    map->alloc = new_alloc;
+    map->used = n;
     map->table = new_table;
-    for (size_t i = 0; i < old_alloc; i++) {
-        if (old_table[i].key != MP_OBJ_NULL && old_table[i].key != MP_OBJ_SENTINEL) {
-            mp_map_lookup(map, old_table[i].key, MP_MAP_LOOKUP_ADD_IF_NOT_FOUND)->value = old_table[i].value;
+    if (map_has_index(map)) {
+        map_index_t *index = map_get_index(map);
+        void *slots = map_get_slots(index);
+        size_t mask = ((size_t)-1) >> index->shift;
+        index->filled = n;
+        for (size_t i = 0; i < n; i++) {
+            size_t pos = map_hash_slot(map_hash(new_table[i].key), index->shift);
+            while (map_slot_get(new_alloc, slots, pos) != MAP_SLOT_EMPTY) {
+                pos = (pos + 1) & mask;
+            }
+            map_slot_set(new_alloc, slots, pos, i + 1);
         }
     }
-    m_del(mp_map_elem_t, old_table, old_alloc);
+    m_del(byte, old_table, old_bytes);
+}
+
+STATIC mp_map_elem_t *map_add_entry(mp_map_t *map, mp_map_elem_t *elem, mp_obj_t index) {
+    map->used += 1;
+    elem->key = index;
+    elem->value = MP_OBJ_NULL;
+    if (!MP_OBJ_IS_QSTR(index)) {
+        map->all_keys_are_qstrs = 0;
+    }
+    return elem;
 }
 
 // MP_MAP_LOOKUP behaviour:
@@ -142,7 +306,8 @@ STATIC void mp_map_rehash(mp_map_t *map) {
 // MP_MAP_LOOKUP_ADD_IF_NOT_FOUND behaviour:
 //  - returns slot, with key non-null and value=MP_OBJ_NULL if it was added
 // MP_MAP_LOOKUP_REMOVE_IF_FOUND behaviour:
-//  - returns NULL if not found, else the slot if was found in with key null and value non-null
+//  - returns NULL if not found, else the slot if was found in with key null or
+//    MP_OBJ_SENTINEL and value non-null
 mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t lookup_kind) {
     // If the map is a fixed array then we must only be called for a lookup
     assert(!map->is_fixed || lookup_kind == MP_MAP_LOOKUP);
@@ -206,7 +371,7 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
         #endif
     }
 
-    // map is a hash table (not an ordered array), so do a hash lookup
+    // map is a hash table (not an ordered array)
 
     if (map->alloc == 0) {
         if (lookup_kind == MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
@@ -216,83 +381,84 @@ mp_map_elem_t *mp_map_lookup(mp_map_t *map, mp_obj_t index, mp_map_lookup_kind_t
         }
     }
 
-    // get hash of index, with fast path for common case of qstr
-    mp_uint_t hash;
-    if (MP_OBJ_IS_QSTR(index)) {
-        hash = qstr_hash(MP_OBJ_QSTR_VALUE(index));
-    } else {
-        hash = MP_OBJ_SMALL_INT_VALUE(mp_unary_op(MP_UNARY_OP_HASH, index));
+    if (!map_has_index(map)) {
+        // small table, so search its entries directly; the hash isn't needed
+        // but computing it raises TypeError for an unhashable index
+        if (!MP_OBJ_IS_QSTR(index) && !MP_OBJ_IS_SMALL_INT(index)) {
+            map_hash(index);
+        }
+        mp_map_elem_t *elem = &map->table[0], *top = &map->table[map->alloc];
+        for (; elem < top && elem->key != MP_OBJ_NULL; elem++) {
+            if (map_key_equal(elem->key, index, compare_only_ptrs)) {
+                // found index
+                // Note: CPython does not replace the index; try x={True:'true'};x[1]='one';x
+                if (lookup_kind == MP_MAP_LOOKUP_REMOVE_IF_FOUND) {
+                    // remove the entry, keeping elem->value so that caller can access it if needed
+                    map->used--;
+                    elem->key = MP_OBJ_SENTINEL;
+                }
+                return elem;
+            }
+        }
+        if (lookup_kind != MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
+            return NULL;
+        }
+        if (elem == top) {
+            // no room after the last entry, so rehash and add it to the new table
+            mp_map_rehash(map);
+            return mp_map_lookup(map, index, lookup_kind);
+        }
+        return map_add_entry(map, elem, index);
     }
 
-    size_t pos = hash % map->alloc;
-    size_t start_pos = pos;
-    mp_map_elem_t *avail_slot = NULL;
+    // large table, so probe its index
+    mp_uint_t hash = map_hash(index);
+    map_index_t *map_index = map_get_index(map);
+    void *slots = map_get_slots(map_index);
+    size_t mask = ((size_t)-1) >> map_index->shift;
+    size_t pos = map_hash_slot(hash, map_index->shift);
+    size_t avail_pos = (size_t)-1;
     for (;;) {
-        mp_map_elem_t *slot = &map->table[pos];
-        if (slot->key == MP_OBJ_NULL) {
-            // found NULL slot, so index is not in table
-            if (lookup_kind == MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
-                map->used += 1;
-                if (avail_slot == NULL) {
-                    avail_slot = slot;
+        size_t s = map_slot_get(map->alloc, slots, pos);
+        if (s == MAP_SLOT_EMPTY) {
+            break;
+        } else if (s != MAP_SLOT_DELETED) {
+            mp_map_elem_t *elem = &map->table[s - 1];
+            if (map_key_equal(elem->key, index, compare_only_ptrs)) {
+                // found index
+                if (lookup_kind == MP_MAP_LOOKUP_REMOVE_IF_FOUND) {
+                    map->used--;
+                    elem->key = MP_OBJ_SENTINEL;
+                    map_slot_set(map->alloc, slots, pos, MAP_SLOT_DELETED);
                 }
-                avail_slot->key = index;
-                avail_slot->value = MP_OBJ_NULL;
-                if (!MP_OBJ_IS_QSTR(index)) {
-                    map->all_keys_are_qstrs = 0;
-                }
-                return avail_slot;
-            } else {
-                return NULL;
-            }
-        } else if (slot->key == MP_OBJ_SENTINEL) {
-            // found deleted slot, remember for later
-            if (avail_slot == NULL) {
-                avail_slot = slot;
+                return elem;
             }
-        } else if (slot->key == index || (!compare_only_ptrs && mp_obj_equal(slot->key, index))) {
-            // found index
-            // Note: CPython does not replace the index; try x={True:'true'};x[1]='one';x
-            if (lookup_kind == MP_MAP_LOOKUP_REMOVE_IF_FOUND) {
-                // delete element in this slot
-                map->used--;
-                if (map->table[(pos + 1) % map->alloc].key == MP_OBJ_NULL) {
-                    // optimisation if next slot is empty
-                    slot->key = MP_OBJ_NULL;
-                } else {
-                    slot->key = MP_OBJ_SENTINEL;
-                }
-                // keep slot->value so that caller can access it if needed
+            if (elem->key == MP_OBJ_SENTINEL && avail_pos == (size_t)-1) {
+                // entry was removed without updating the index (eg by dict.popitem)
+                avail_pos = pos;
             }
-            return slot;
+        } else if (avail_pos == (size_t)-1) {
+            // found deleted slot, remember for later
+            avail_pos = pos;
         }
+        pos = (pos + 1) & mask;
+    }
 
-        // not yet found, keep searching in this table
-        pos = (pos + 1) % map->alloc;
-
-        if (pos == start_pos) {
-            // search got back to starting position, so index is not in table
-            if (lookup_kind == MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
-                if (avail_slot != NULL) {
-                    // there was an available slot, so use that
-                    map->used++;
-                    avail_slot->key = index;
-                    avail_slot->value = MP_OBJ_NULL;
-                    if (!MP_OBJ_IS_QSTR(index)) {
-                        map->all_keys_are_qstrs = 0;
-                    }
-                    return avail_slot;
-                } else {
-                    // not enough room in table, rehash it
-                    mp_map_rehash(map);
-                    // restart the search for the new element
-                    start_pos = pos = hash % map->alloc;
-                }
-            } else {
-                return NULL;
-            }
-        }
+    // index is not in table
+    if (lookup_kind != MP_MAP_LOOKUP_ADD_IF_NOT_FOUND) {
+        return NULL;
+    }
+    if (map_index->filled == map->alloc) {
+        // no room after the last entry, so rehash and add it to the new table
+        mp_map_rehash(map);
+        return mp_map_lookup(map, index, lookup_kind);
+    }
+    if (avail_pos == (size_t)-1) {
+        avail_pos = pos;
     }
+    size_t n = map_index->filled++;
+    map_slot_set(map->alloc, slots, avail_pos, n + 1);
+    return map_add_entry(map, &map->table[n], index);
 }
 
 /******************************************************************************/
@@ -309,7 +475,10 @@ void mp_set_init(mp_set_t *set, size_t n) {
 STATIC void mp_set_rehash(mp_set_t *set) {
     size_t old_alloc = set->alloc;
     mp_obj_t *old_table = set->table;
-    set->alloc = get_hash_alloc_greater_or_equal_to(set->alloc + 1);
+    // grow by 2 while the table is small, so that it fills whole GC blocks,
+    // then by about 1.25 times, keeping the size odd so that hashes which
+    // share a power of 2 factor, such as aligned pointers, are spread out
+    set->alloc = old_alloc < 12 ? old_alloc + 2 : (old_alloc + old_alloc / 4) | 1;
     set->used = 0;
     set->table = m_new0(mp_obj_t, set->alloc);
     for (size_t i = 0; i < old_alloc; i++) {
@@ -104,7 +104,7 @@ $(HEADER_BUILD):
 	$(Q)$(MKDIR) -p $@
 
 ifneq ($(FROZEN_DIR),)
-$(BUILD)/frozen.c: $(wildcard $(FROZEN_DIR)/*) $(HEADER_BUILD) $(FROZEN_EXTRA_DEPS)
+$(BUILD)/frozen.c: $(wildcard $(FROZEN_DIR)/*) $(HEADER_BUILD) $(FROZEN_EXTRA_DEPS) $(TOP)/tools/make-frozen.py
 	$(STEPECHO) "Generating $@"
 	$(Q)$(MAKE_FROZEN) $(FROZEN_DIR) > $@
 endif
@@ -31,6 +31,7 @@
 #include "py/runtime.h"
 #include "py/gc.h"
 #include "py/mphal.h"
+#include "py/profile.h"
 
 #include "supervisor/shared/translate.h"
 
@@ -109,6 +110,18 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_micropython_qstr_info_obj, 0, 1, m
 
 #endif // MICROPY_PY_MICROPYTHON_MEM_INFO
 
+#if MICROPY_GC_ALLOC_SITES
+// Print the allocation site table, and clear it if an argument is given.
+STATIC mp_obj_t mp_micropython_alloc_sites(size_t n_args, const mp_obj_t *args) {
+    gc_dump_alloc_sites();
+    if (n_args == 1 && mp_obj_is_true(args[0])) {
+        gc_clear_alloc_sites();
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_micropython_alloc_sites_obj, 0, 1, mp_micropython_alloc_sites);
+#endif
+
 #if MICROPY_PY_MICROPYTHON_STACK_USE
 STATIC mp_obj_t mp_micropython_stack_use(void) {
     return MP_OBJ_NEW_SMALL_INT(mp_stack_usage());
@@ -159,6 +172,64 @@ STATIC mp_obj_t mp_micropython_schedule(mp_obj_t function, mp_obj_t arg) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(mp_micropython_schedule_obj, mp_micropython_schedule);
 #endif
 
+#if MICROPY_PY_MICROPYTHON_PROFILE
+STATIC mp_obj_t mp_micropython_profile_start(size_t n_args, const mp_obj_t *args) {
+    mp_int_t n_samples = 64;
+    if (n_args > 0) {
+        n_samples = mp_obj_get_int(args[0]);
+    }
+    if (n_samples < 1) {
+        mp_raise_ValueError(NULL);
+    }
+    mp_prof_start(n_samples);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_micropython_profile_start_obj, 0, 1, mp_micropython_profile_start);
+
+// Returns the number of samples that didn't fit in the table.
+STATIC mp_obj_t mp_micropython_profile_stop(void) {
+    mp_prof_stop();
+    mp_prof_t *prof = MP_STATE_VM(prof);
+    return MP_OBJ_NEW_SMALL_INT(prof == NULL ? 0 : prof->dropped);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_micropython_profile_stop_obj, mp_micropython_profile_stop);
+
+STATIC mp_obj_t mp_micropython_profile_opcodes(void) {
+    mp_obj_t dict = mp_obj_new_dict(0);
+    mp_prof_t *prof = MP_STATE_VM(prof);
+    if (prof != NULL) {
+        for (size_t i = 0; i < MP_ARRAY_SIZE(prof->opcode_count); i++) {
+            if (prof->opcode_count[i] != 0) {
+                mp_obj_dict_store(dict, MP_OBJ_NEW_SMALL_INT(i), mp_obj_new_int_from_uint(prof->opcode_count[i]));
+            }
+        }
+    }
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_micropython_profile_opcodes_obj, mp_micropython_profile_opcodes);
+
+STATIC mp_obj_t mp_micropython_profile_samples(void) {
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    mp_prof_t *prof = MP_STATE_VM(prof);
+    if (prof != NULL) {
+        for (size_t i = 0; i < prof->alloc; i++) {
+            mp_prof_sample_t *s = &prof->samples[i];
+            if (s->count != 0) {
+                mp_obj_t items[4] = {
+                    MP_OBJ_NEW_QSTR(s->source_file),
+                    MP_OBJ_NEW_QSTR(s->block_name),
+                    MP_OBJ_NEW_SMALL_INT(s->line),
+                    mp_obj_new_int_from_uint(s->count),
+                };
+                mp_obj_list_append(list, mp_obj_new_tuple(4, items));
+            }
+        }
+    }
+    return list;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_micropython_profile_samples_obj, mp_micropython_profile_samples);
+#endif
+
 STATIC const mp_rom_map_elem_t mp_module_micropython_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_micropython) },
     { MP_ROM_QSTR(MP_QSTR_const), MP_ROM_PTR(&mp_identity_obj) },
@@ -174,6 +245,9 @@ STATIC const mp_rom_map_elem_t mp_module_micropython_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_mem_info), MP_ROM_PTR(&mp_micropython_mem_info_obj) },
     { MP_ROM_QSTR(MP_QSTR_qstr_info), MP_ROM_PTR(&mp_micropython_qstr_info_obj) },
 #endif
+    #if MICROPY_GC_ALLOC_SITES
+    { MP_ROM_QSTR(MP_QSTR_alloc_sites), MP_ROM_PTR(&mp_micropython_alloc_sites_obj) },
+    #endif
     #if MICROPY_PY_MICROPYTHON_STACK_USE
     { MP_ROM_QSTR(MP_QSTR_stack_use), MP_ROM_PTR(&mp_micropython_stack_use_obj) },
     #endif
@@ -193,6 +267,12 @@ STATIC const mp_rom_map_elem_t mp_module_micropython_globals_table[] = {
     #if MICROPY_ENABLE_SCHEDULER
     { MP_ROM_QSTR(MP_QSTR_schedule), MP_ROM_PTR(&mp_micropython_schedule_obj) },
     #endif
+    #if MICROPY_PY_MICROPYTHON_PROFILE
+    { MP_ROM_QSTR(MP_QSTR_profile_start), MP_ROM_PTR(&mp_micropython_profile_start_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profile_stop), MP_ROM_PTR(&mp_micropython_profile_stop_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profile_opcodes), MP_ROM_PTR(&mp_micropython_profile_opcodes_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profile_samples), MP_ROM_PTR(&mp_micropython_profile_samples_obj) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_micropython_globals, mp_module_micropython_globals_table);
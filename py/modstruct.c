@@ -31,6 +31,7 @@
 #include "py/runtime.h"
 #include "py/builtin.h"
 #include "py/objtuple.h"
+#include "py/objproperty.h"
 #include "py/binary.h"
 #include "py/parsenum.h"
 #include "supervisor/shared/translate.h"
@@ -249,6 +250,274 @@ STATIC mp_obj_t struct_pack_into(size_t n_args, const mp_obj_t *args) {
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_pack_into_obj, 3, MP_OBJ_FUN_ARGS_MAX, struct_pack_into);
 
+// A Struct holds a format string that has been parsed once, as the offset and
+// type of each field, so that packing and unpacking many records of the same
+// format doesn't parse the format again for each one.
+
+typedef struct _struct_field_t {
+    char type;
+    mp_uint_t offset;
+    mp_uint_t len; // number of bytes for 's'
+} struct_field_t;
+
+typedef struct _mp_obj_struct_t {
+    mp_obj_base_t base;
+    mp_obj_t format;
+    char fmt_type;
+    size_t size;
+    size_t n_fields;
+    struct_field_t fields[];
+} mp_obj_struct_t;
+
+STATIC const mp_obj_type_t struct_type;
+
+STATIC mp_obj_struct_t *struct_compile(mp_obj_t fmt_in) {
+    const char *fmt = mp_obj_str_get_str(fmt_in);
+    size_t size;
+    size_t n_fields = calc_size_items(fmt, &size);
+    mp_obj_struct_t *self = m_new_obj_var(mp_obj_struct_t, struct_field_t, n_fields);
+    self->base.type = &struct_type;
+    self->format = fmt_in;
+    self->fmt_type = get_fmt_type(&fmt);
+    self->size = size;
+    self->n_fields = n_fields;
+    size_t offset = 0;
+    for (size_t i = 0; i < n_fields; fmt++) {
+        mp_uint_t cnt = 1;
+        if (unichar_isdigit(*fmt)) {
+            cnt = get_fmt_num(&fmt);
+        }
+        if (*fmt == 's') {
+            self->fields[i].type = 's';
+            self->fields[i].offset = offset;
+            self->fields[i++].len = cnt;
+            offset += cnt;
+        } else {
+            mp_uint_t align;
+            size_t sz = mp_binary_get_size(self->fmt_type, *fmt, &align);
+            while (cnt--) {
+                offset = (offset + align - 1) & ~(align - 1);
+                self->fields[i].type = *fmt;
+                self->fields[i++].offset = offset;
+                offset += sz;
+            }
+        }
+    }
+    return self;
+}
+
+STATIC mp_obj_t struct_unpack_record(mp_obj_struct_t *self, const byte *p) {
+    mp_obj_tuple_t *res = MP_OBJ_TO_PTR(mp_obj_new_tuple(self->n_fields, NULL));
+    for (size_t i = 0; i < self->n_fields; i++) {
+        const struct_field_t *f = &self->fields[i];
+        byte *q = (byte*)p + f->offset;
+        if (f->type == 's') {
+            res->items[i] = mp_obj_new_bytes(q, f->len);
+        } else {
+            res->items[i] = mp_binary_get_val(self->fmt_type, f->type, &q);
+        }
+    }
+    return MP_OBJ_FROM_PTR(res);
+}
+
+STATIC void struct_pack_record(mp_obj_struct_t *self, byte *p, size_t n_args, const mp_obj_t *args) {
+    if (n_args != self->n_fields) {
+        mp_raise_ValueError(translate("wrong number of arguments"));
+    }
+    for (size_t i = 0; i < n_args; i++) {
+        const struct_field_t *f = &self->fields[i];
+        byte *q = p + f->offset;
+        if (f->type == 's') {
+            mp_buffer_info_t bufinfo;
+            mp_get_buffer_raise(args[i], &bufinfo, MP_BUFFER_READ);
+            mp_uint_t to_copy = MIN(bufinfo.len, f->len);
+            memcpy(q, bufinfo.buf, to_copy);
+            memset(q + to_copy, 0, f->len - to_copy);
+        } else {
+            mp_binary_set_val(self->fmt_type, f->type, args[i], &q);
+        }
+    }
+}
+
+// Return the address of the record at offset in a buffer, checking that the
+// record fits.  A negative offset is relative to the end of the buffer.
+STATIC byte *struct_get_record(mp_obj_struct_t *self, const mp_buffer_info_t *bufinfo, mp_int_t offset) {
+    if (offset < 0) {
+        offset += bufinfo->len;
+    }
+    if (offset < 0 || (size_t)offset > bufinfo->len || bufinfo->len - offset < self->size) {
+        mp_raise_ValueError(translate("buffer too small"));
+    }
+    return (byte*)bufinfo->buf + offset;
+}
+
+STATIC mp_obj_t struct_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    (void)type;
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    return MP_OBJ_FROM_PTR(struct_compile(args[0]));
+}
+
+STATIC mp_obj_t struct_obj_pack(size_t n_args, const mp_obj_t *args) {
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(args[0]);
+    vstr_t vstr;
+    vstr_init_len(&vstr, self->size);
+    memset(vstr.buf, 0, self->size);
+    struct_pack_record(self, (byte*)vstr.buf, n_args - 1, args + 1);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_obj_pack_obj, 1, MP_OBJ_FUN_ARGS_MAX, struct_obj_pack);
+
+STATIC mp_obj_t struct_obj_pack_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    byte *p = struct_get_record(self, &bufinfo, mp_obj_get_int(args[2]));
+    struct_pack_record(self, p, n_args - 3, args + 3);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_obj_pack_into_obj, 3, MP_OBJ_FUN_ARGS_MAX, struct_obj_pack_into);
+
+STATIC mp_obj_t struct_obj_unpack_from(size_t n_args, const mp_obj_t *args) {
+    // as for the module function, unpack only needs the buffer to be big enough
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+    mp_int_t offset = n_args > 2 ? mp_obj_get_int(args[2]) : 0;
+    return struct_unpack_record(self, struct_get_record(self, &bufinfo, offset));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_obj_unpack_from_obj, 2, 3, struct_obj_unpack_from);
+
+// Pack each sequence in records into consecutive records of the buffer,
+// stride bytes apart, and return the number of records packed.
+STATIC mp_obj_t struct_obj_pack_many_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    mp_int_t offset = mp_obj_get_int(args[2]);
+    mp_int_t stride = n_args > 4 ? mp_obj_get_int(args[4]) : (mp_int_t)self->size;
+    if (stride <= 0) {
+        mp_raise_ValueError(translate("stride must be > 0"));
+    }
+    mp_obj_iter_buf_t iter_buf;
+    mp_obj_t iterable = mp_getiter(args[3], &iter_buf);
+    mp_obj_t record;
+    size_t n = 0;
+    while ((record = mp_iternext(iterable)) != MP_OBJ_STOP_ITERATION) {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(record, &len, &items);
+        struct_pack_record(self, struct_get_record(self, &bufinfo, offset), len, items);
+        offset += stride;
+        n += 1;
+    }
+    return MP_OBJ_NEW_SMALL_INT(n);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_obj_pack_many_into_obj, 4, 5, struct_obj_pack_many_into);
+
+typedef struct _mp_obj_struct_iter_t {
+    mp_obj_base_t base;
+    mp_fun_1_t iternext;
+    mp_obj_struct_t *st;
+    mp_obj_t buffer;
+    size_t offset;
+    size_t stride;
+} mp_obj_struct_iter_t;
+
+STATIC mp_obj_t struct_iter_unpack_iternext(mp_obj_t self_in) {
+    mp_obj_struct_iter_t *self = MP_OBJ_TO_PTR(self_in);
+    // get the buffer each time in case it was resized
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(self->buffer, &bufinfo, MP_BUFFER_READ);
+    if (self->offset > bufinfo.len || bufinfo.len - self->offset < self->st->size) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    mp_obj_t res = struct_unpack_record(self->st, (byte*)bufinfo.buf + self->offset);
+    self->offset += self->stride;
+    return res;
+}
+
+STATIC mp_obj_t struct_iter_unpack_helper(mp_obj_struct_t *st, size_t n_args, const mp_obj_t *args) {
+    // check that the object has a buffer
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    mp_int_t offset = n_args > 1 ? mp_obj_get_int(args[1]) : 0;
+    mp_int_t stride = n_args > 2 ? mp_obj_get_int(args[2]) : (mp_int_t)st->size;
+    if (offset < 0) {
+        mp_raise_ValueError(translate("offset must be >= 0"));
+    }
+    if (stride <= 0) {
+        mp_raise_ValueError(translate("stride must be > 0"));
+    }
+    mp_obj_struct_iter_t *o = m_new_obj(mp_obj_struct_iter_t);
+    o->base.type = &mp_type_polymorph_iter;
+    o->iternext = struct_iter_unpack_iternext;
+    o->st = st;
+    o->buffer = args[0];
+    o->offset = offset;
+    o->stride = stride;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_obj_t struct_obj_iter_unpack(size_t n_args, const mp_obj_t *args) {
+    return struct_iter_unpack_helper(MP_OBJ_TO_PTR(args[0]), n_args - 1, args + 1);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_obj_iter_unpack_obj, 2, 4, struct_obj_iter_unpack);
+
+STATIC mp_obj_t struct_iter_unpack(size_t n_args, const mp_obj_t *args) {
+    return struct_iter_unpack_helper(struct_compile(args[0]), n_args - 1, args + 1);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_iter_unpack_obj, 2, 4, struct_iter_unpack);
+
+#if MICROPY_PY_BUILTINS_PROPERTY
+STATIC mp_obj_t struct_obj_get_format(mp_obj_t self_in) {
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(self_in);
+    return self->format;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(struct_obj_get_format_obj, struct_obj_get_format);
+
+STATIC const mp_obj_property_t struct_format_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&struct_obj_get_format_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC mp_obj_t struct_obj_get_size(mp_obj_t self_in) {
+    mp_obj_struct_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(self->size);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(struct_obj_get_size_obj, struct_obj_get_size);
+
+STATIC const mp_obj_property_t struct_size_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&struct_obj_get_size_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+#endif
+
+STATIC const mp_rom_map_elem_t struct_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_pack), MP_ROM_PTR(&struct_obj_pack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pack_into), MP_ROM_PTR(&struct_obj_pack_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pack_many_into), MP_ROM_PTR(&struct_obj_pack_many_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack), MP_ROM_PTR(&struct_obj_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack_from), MP_ROM_PTR(&struct_obj_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_iter_unpack), MP_ROM_PTR(&struct_obj_iter_unpack_obj) },
+    #if MICROPY_PY_BUILTINS_PROPERTY
+    { MP_ROM_QSTR(MP_QSTR_format), MP_ROM_PTR(&struct_format_obj) },
+    { MP_ROM_QSTR(MP_QSTR_size), MP_ROM_PTR(&struct_size_obj) },
+    #endif
+};
+
+STATIC MP_DEFINE_CONST_DICT(struct_locals_dict, struct_locals_dict_table);
+
+STATIC const mp_obj_type_t struct_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Struct,
+    .make_new = struct_make_new,
+    .locals_dict = (mp_obj_dict_t*)&struct_locals_dict,
+};
+
 STATIC const mp_rom_map_elem_t mp_module_struct_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ustruct) },
     { MP_ROM_QSTR(MP_QSTR_calcsize), MP_ROM_PTR(&struct_calcsize_obj) },
@@ -256,6 +525,8 @@ STATIC const mp_rom_map_elem_t mp_module_struct_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_pack_into), MP_ROM_PTR(&struct_pack_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_unpack), MP_ROM_PTR(&struct_unpack_from_obj) },
     { MP_ROM_QSTR(MP_QSTR_unpack_from), MP_ROM_PTR(&struct_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_iter_unpack), MP_ROM_PTR(&struct_iter_unpack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_Struct), MP_ROM_PTR(&struct_type) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_struct_globals, mp_module_struct_globals_table);
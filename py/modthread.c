@@ -164,6 +164,15 @@ STATIC void *thread_entry(void *args_in) {
     mp_state_thread_t ts;
     mp_thread_set_state(&ts);
 
+    #if MICROPY_GC_ALLOC_SITES
+    ts.current_code_state = NULL;
+    ts.gc_alloc_caller = NULL;
+    #endif
+
+    #if MICROPY_GC_THREAD_ALLOC_BUFFER
+    memset(&ts.gc_alloc_buffer, 0, sizeof(ts.gc_alloc_buffer));
+    #endif
+
     mp_stack_set_top(&ts + 1); // need to include ts in root-pointer scan
     mp_stack_set_limit(args->stack_size);
 
@@ -106,6 +106,28 @@
 #define MICROPY_ALLOC_GC_STACK_SIZE (64)
 #endif
 
+// Whether the GC stack can grow beyond MICROPY_ALLOC_GC_STACK_SIZE entries,
+// instead of rescanning the heap for marked blocks when it overflows.  The
+// port must provide MP_PLAT_ALLOC_GC_STACK(n_bytes), returning NULL on failure,
+// and MP_PLAT_FREE_GC_STACK(ptr, n_bytes).  These are called during a
+// collection, possibly from a signal handler, so must not use the GC heap.
+#ifndef MICROPY_GC_STACK_GROW
+#define MICROPY_GC_STACK_GROW (0)
+#endif
+
+// Whether other threads can help the collecting thread mark the heap.  The
+// port must provide mp_thread_gc_mark_start, mp_thread_gc_mark_wait and
+// mp_thread_yield (see py/mpthread.h), and all other threads that use the heap
+// must be stopped until gc_collect_mark_end returns.  Requires MICROPY_GC_STACK_GROW.
+#ifndef MICROPY_GC_PARALLEL_MARK
+#define MICROPY_GC_PARALLEL_MARK (0)
+#endif
+
+// Heaps smaller than this are always marked by the collecting thread alone.
+#ifndef MICROPY_GC_PARALLEL_MARK_MIN_BYTES
+#define MICROPY_GC_PARALLEL_MARK_MIN_BYTES (16 * 1024 * 1024)
+#endif
+
 // Be conservative and always clear to zero newly (re)allocated memory in the GC.
 // This helps eliminate stray pointers that hold on to memory that's no longer
 // used.  It decreases performance due to unnecessary memory clearing.
@@ -122,6 +144,23 @@
 #define MICROPY_GC_ALLOC_THRESHOLD (1)
 #endif
 
+// Number of allocation sites to keep byte and count statistics for.  A site
+// is the bytecode function and line that was running, or else the C function
+// that called the allocator.  With MICROPY_GC_THREAD_ALLOC_BUFFER every
+// allocation takes the GC lock to update the table.  Set to 0 to disable.
+#ifndef MICROPY_GC_ALLOC_SITES
+#define MICROPY_GC_ALLOC_SITES (0)
+#endif
+
+// Number of heap blocks that a thread claims at a time to allocate small
+// objects from without taking the GC lock.  Only for ports that run threads
+// without the GIL, and the port's gc_collect must stop the other threads,
+// have each one call gc_collect_alloc_buffer, and keep them stopped until
+// gc_collect_mark_end returns.  Set to 0 to disable.
+#ifndef MICROPY_GC_THREAD_ALLOC_BUFFER
+#define MICROPY_GC_THREAD_ALLOC_BUFFER (0)
+#endif
+
 // Number of bytes to allocate initially when creating new chunks to store
 // interned string data.  Smaller numbers lead to more chunks being needed
 // and more wastage at the end of the chunk.  Larger numbers lead to wasted
@@ -252,6 +291,24 @@
 #define MICROPY_PERSISTENT_CODE_SAVE (0)
 #endif
 
+// Whether to support executing the bytecode of .mpy files in place, from
+// memory-mapped storage, rather than copying it to the heap.  The port must
+// provide mp_raw_code_map_file() (see py/persistentcode.h).
+#ifndef MICROPY_PERSISTENT_CODE_XIP
+#define MICROPY_PERSISTENT_CODE_XIP (0)
+#endif
+
+// Whether import caches the compiled form of a .py module as an .mpy file in
+// a __pycache__ directory next to it, and loads that instead of compiling the
+// module again while the source's size and hash are unchanged.  With
+// MICROPY_COMP_INCREMENTAL a module is still compiled a statement at a time
+// and cached as one .mpy image per statement.  The unix port's host
+// filesystem is never cached.  Requires MICROPY_VFS,
+// MICROPY_PERSISTENT_CODE_LOAD and MICROPY_PERSISTENT_CODE_SAVE.
+#ifndef MICROPY_PERSISTENT_CODE_CACHE
+#define MICROPY_PERSISTENT_CODE_CACHE (0)
+#endif
+
 // Whether generated code can persist independently of the VM/runtime instance
 // This is enabled automatically when needed by other features
 #ifndef MICROPY_PERSISTENT_CODE
@@ -364,6 +421,13 @@
 #define MICROPY_COMP_RETURN_IF_EXPR (0)
 #endif
 
+// Whether imported .py modules are parsed and compiled one top-level
+// statement at a time, so that peak memory use depends on the size of the
+// largest statement's parse tree rather than of the whole module's.
+#ifndef MICROPY_COMP_INCREMENTAL
+#define MICROPY_COMP_INCREMENTAL (0)
+#endif
+
 /*****************************************************************************/
 /* Internal debugging stuff                                                  */
 
@@ -408,6 +472,14 @@
 #define MICROPY_OPT_MPZ_BITWISE (0)
 #endif
 
+// Whether str/bytes searching (find, split, count, replace, in) scans for the
+// first needle byte a machine word at a time and uses Horspool skipping for
+// longer needles.  Uses 256 bytes of C stack for long needles and increases
+// Thumb2 code size by about 300 bytes.
+#ifndef MICROPY_OPT_FAST_STR_SEARCH
+#define MICROPY_OPT_FAST_STR_SEARCH (0)
+#endif
+
 /*****************************************************************************/
 /* Python internal features                                                  */
 
@@ -433,6 +505,13 @@
 #define MICROPY_FATFS_NUM_PERSISTENT (0)
 #endif
 
+// Number of sectors of native block devices that the FAT driver keeps in a
+// RAM cache, shared between all mounts (0 to disable).  The cache is write
+// through, so it never holds data that isn't on the device.
+#ifndef MICROPY_FATFS_CACHE_SECTORS
+#define MICROPY_FATFS_CACHE_SECTORS (0)
+#endif
+
 // Hook for the VM at the start of the opcode loop (can contain variable
 // definitions usable by the other hook functions)
 #ifndef MICROPY_VM_HOOK_INIT
@@ -697,6 +776,12 @@ typedef double mp_float_t;
 #define MICROPY_VFS (0)
 #endif
 
+// Whether import answers its stat queries from a cached listing of each
+// directory searched, instead of asking the filesystem for every candidate
+#ifndef MICROPY_VFS_IMPORT_CACHE
+#define MICROPY_VFS_IMPORT_CACHE (0)
+#endif
+
 // Support for VFS POSIX component, to mount a POSIX filesystem within VFS
 #ifndef MICROPY_VFS
 #define MICROPY_VFS_POSIX (0)
@@ -945,6 +1030,19 @@ typedef double mp_float_t;
 #define MICROPY_PY_MICROPYTHON_STACK_USE (MICROPY_PY_MICROPYTHON_MEM_INFO)
 #endif
 
+// Whether to count executed opcodes and sample the running line in the VM,
+// and provide "micropython.profile_*" functions to read the results.  The
+// port should call mp_prof_tick() from a timer to request a sample.
+#ifndef MICROPY_PY_MICROPYTHON_PROFILE
+#define MICROPY_PY_MICROPYTHON_PROFILE (0)
+#endif
+
+// If non-zero, also take a profile sample every this many opcodes, for ports
+// that don't call mp_prof_tick().
+#ifndef MICROPY_PY_MICROPYTHON_PROFILE_SAMPLE_PERIOD
+#define MICROPY_PY_MICROPYTHON_PROFILE_SAMPLE_PERIOD (0)
+#endif
+
 // Whether to provide "array" module. Note that large chunk of the
 // underlying code is shared with "bytearray" builtin type, so to
 // get real savings, it should be disabled too.
@@ -1156,6 +1254,12 @@ typedef double mp_float_t;
 #define MICROPY_PY_UZLIB (0)
 #endif
 
+// Whether to provide uzlib.compress() and uzlib.CompIO
+// Depends on MICROPY_PY_UZLIB
+#ifndef MICROPY_PY_UZLIB_COMPRESS
+#define MICROPY_PY_UZLIB_COMPRESS (0)
+#endif
+
 #ifndef MICROPY_PY_UJSON
 #define MICROPY_PY_UJSON (0)
 #endif
@@ -1164,15 +1268,53 @@ typedef double mp_float_t;
 #define MICROPY_PY_URE (0)
 #endif
 
+// Whether ure matches with a Pike VM (linear time, bounded C stack) rather
+// than the recursive backtracking matcher, at the cost of a heap allocation
+// proportional to the regex size for each match
+#ifndef MICROPY_PY_URE_PIKEVM
+#define MICROPY_PY_URE_PIKEVM (0)
+#endif
+
+// Number of compiled regexes kept for reuse by ure.match() and ure.search()
+#ifndef MICROPY_PY_URE_CACHE_SIZE
+#define MICROPY_PY_URE_CACHE_SIZE (0)
+#endif
+
 #ifndef MICROPY_PY_UHEAPQ
 #define MICROPY_PY_UHEAPQ (0)
 #endif
 
+// Element-wise operations and reductions on arrays of numbers
+#ifndef MICROPY_PY_UARRAYOPS
+#define MICROPY_PY_UARRAYOPS (0)
+#endif
+
+// Memory-mapped files
+#ifndef MICROPY_PY_UMMAP
+#define MICROPY_PY_UMMAP (0)
+#endif
+
+// Whether ummap can map file descriptors with mmap(2)
+#ifndef MICROPY_PY_UMMAP_POSIX
+#define MICROPY_PY_UMMAP_POSIX (0)
+#endif
+
 // Optimized heap queue for relative timestamps
 #ifndef MICROPY_PY_UTIMEQ
 #define MICROPY_PY_UTIMEQ (0)
 #endif
 
+// Event loop running generator-based tasks natively
+#ifndef MICROPY_PY_UEVLOOP
+#define MICROPY_PY_UEVLOOP (0)
+#endif
+
+// Whether the event loop can wait for I/O, using the poll object of the
+// uselect module (which must be enabled)
+#ifndef MICROPY_PY_UEVLOOP_POLL
+#define MICROPY_PY_UEVLOOP_POLL (MICROPY_PY_UEVLOOP && MICROPY_PY_USELECT)
+#endif
+
 #ifndef MICROPY_PY_UHASHLIB
 #define MICROPY_PY_UHASHLIB (0)
 #endif
@@ -60,6 +60,29 @@ typedef struct _mp_sched_item_t {
     mp_obj_t arg;
 } mp_sched_item_t;
 
+#if MICROPY_GC_THREAD_ALLOC_BUFFER
+// A run of heap blocks that one thread allocates small objects from.  The run
+// is a single chain of blocks in the allocation table; taking an object from
+// the front just turns the block after it into the head of the chain.
+typedef struct _mp_gc_alloc_buffer_t {
+    size_t last_block; // first block of the object taken last
+    size_t next_block; // first block not yet handed out
+    size_t end_block; // block after the run
+} mp_gc_alloc_buffer_t;
+#endif
+
+#if MICROPY_GC_STACK_GROW
+// A stack of blocks that have been marked but whose children haven't been
+// looked at yet.  It starts out in a fixed array of MICROPY_ALLOC_GC_STACK_SIZE
+// entries, or with none, and moves to memory from MP_PLAT_ALLOC_GC_STACK when
+// that is full.
+typedef struct _mp_gc_stack_t {
+    size_t *blocks;
+    size_t sp;
+    size_t len;
+} mp_gc_stack_t;
+#endif
+
 // This structure hold information about the memory allocation system.
 typedef struct _mp_state_mem_t {
     #if MICROPY_MEM_STATS
@@ -80,6 +103,9 @@ typedef struct _mp_state_mem_t {
 
     int gc_stack_overflow;
     size_t gc_stack[MICROPY_ALLOC_GC_STACK_SIZE];
+    #if MICROPY_GC_STACK_GROW
+    mp_gc_stack_t gc_mark_stack;
+    #endif
     uint16_t gc_lock_depth;
 
     // This variable controls auto garbage collection.  If set to false then the
@@ -103,6 +129,18 @@ typedef struct _mp_state_mem_t {
     // This is a global mutex used to make the GC thread-safe.
     mp_thread_mutex_t gc_mutex;
     #endif
+
+    #if MICROPY_GC_PARALLEL_MARK
+    // Blocks handed over by busy markers to idle ones, and the number of
+    // markers taking part and waiting for work, which are both zero outside
+    // of gc_mark_in_parallel.  gc_mark_mutex protects these.
+    mp_thread_mutex_t gc_mark_mutex;
+    mp_gc_stack_t gc_mark_pool;
+    size_t gc_mark_n_markers;
+    size_t gc_mark_n_idle;
+    bool gc_mark_parallel;
+    bool gc_mark_done;
+    #endif
 } mp_state_mem_t;
 
 // This structure hold runtime and VM information.  It includes a section
@@ -184,9 +222,20 @@ typedef struct _mp_state_vm_t {
     mp_obj_t lwip_slip_stream;
     #endif
 
+    #if MICROPY_PY_URE && MICROPY_PY_URE_CACHE_SIZE
+    mp_obj_t ure_cache[2 * MICROPY_PY_URE_CACHE_SIZE];
+    #endif
+
     #if MICROPY_VFS
     struct _mp_vfs_mount_t *vfs_cur;
     struct _mp_vfs_mount_t *vfs_mount_table;
+    #if MICROPY_VFS_IMPORT_CACHE
+    struct _mp_vfs_import_dir_t *vfs_import_cache;
+    #endif
+    #endif
+
+    #if MICROPY_PY_MICROPYTHON_PROFILE
+    struct _mp_prof_t *prof;
     #endif
 
     //
@@ -218,6 +267,11 @@ typedef struct _mp_state_vm_t {
     uint16_t sched_sp;
     #endif
 
+    #if MICROPY_PY_MICROPYTHON_PROFILE
+    bool prof_active;
+    volatile bool prof_tick;
+    #endif
+
     #if MICROPY_PY_THREAD_GIL
     // This is a global mutex used to make the VM/runtime thread-safe.
     mp_thread_mutex_t gil_mutex;
@@ -244,6 +298,17 @@ typedef struct _mp_state_thread_t {
     uint8_t *pystack_cur;
     #endif
 
+    #if MICROPY_GC_ALLOC_SITES
+    // The bytecode being run and the C function that called m_malloc, used
+    // to tag allocations.
+    struct _mp_code_state_t *current_code_state;
+    void *gc_alloc_caller;
+    #endif
+
+    #if MICROPY_GC_THREAD_ALLOC_BUFFER
+    mp_gc_alloc_buffer_t gc_alloc_buffer;
+    #endif
+
     ////////////////////////////////////////////////////////////
     // START ROOT POINTER SECTION
     // Everything that needs GC scanning must start here, and
@@ -47,6 +47,15 @@ void mp_thread_mutex_init(mp_thread_mutex_t *mutex);
 int mp_thread_mutex_lock(mp_thread_mutex_t *mutex, int wait);
 void mp_thread_mutex_unlock(mp_thread_mutex_t *mutex);
 
+#if MICROPY_GC_PARALLEL_MARK
+// Wake the threads that help with marking, each of which calls gc_mark_helper.
+void mp_thread_gc_mark_start(void);
+// Wait until all helpers woken by mp_thread_gc_mark_start have returned.
+void mp_thread_gc_mark_wait(void);
+// Let other threads run while waiting for them.
+void mp_thread_yield(void);
+#endif
+
 #endif // MICROPY_PY_THREAD
 
 #if MICROPY_PY_THREAD && MICROPY_PY_THREAD_GIL
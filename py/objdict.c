@@ -106,7 +106,7 @@ STATIC mp_obj_t dict_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
         case MP_UNARY_OP_LEN: return MP_OBJ_NEW_SMALL_INT(self->map.used);
         #if MICROPY_PY_SYS_GETSIZEOF
         case MP_UNARY_OP_SIZEOF: {
-            size_t sz = sizeof(*self) + sizeof(*self->map.table) * self->map.alloc;
+            size_t sz = sizeof(*self) + mp_map_table_bytes(&self->map);
             return MP_OBJ_NEW_SMALL_INT(sz);
         }
         #endif
@@ -224,7 +224,8 @@ STATIC mp_obj_t dict_copy(mp_obj_t self_in) {
     other->map.all_keys_are_qstrs = self->map.all_keys_are_qstrs;
     other->map.is_fixed = 0;
     other->map.is_ordered = self->map.is_ordered;
-    memcpy(other->map.table, self->map.table, self->map.alloc * sizeof(mp_map_elem_t));
+    // this also copies the index of a hash table
+    memcpy(other->map.table, self->map.table, mp_map_table_bytes(&self->map));
     return other_out;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(dict_copy_obj, dict_copy);
@@ -29,7 +29,6 @@
 
 #include "py/objlist.h"
 #include "py/runtime.h"
-#include "py/stackctrl.h"
 
 #include "supervisor/shared/translate.h"
 
@@ -285,35 +284,311 @@ STATIC mp_obj_t list_pop(size_t n_args, const mp_obj_t *args) {
     return ret;
 }
 
-STATIC void mp_quicksort(mp_obj_t *head, mp_obj_t *tail, mp_obj_t key_fn, mp_obj_t binop_less_result) {
-    MP_STACK_CHECK();
-    while (head < tail) {
-        mp_obj_t *h = head - 1;
-        mp_obj_t *t = tail;
-        mp_obj_t v = key_fn == MP_OBJ_NULL ? tail[0] : mp_call_function_1(key_fn, tail[0]); // get pivot using key_fn
-        for (;;) {
-            do ++h; while (h < t && mp_binary_op(MP_BINARY_OP_LESS, key_fn == MP_OBJ_NULL ? h[0] : mp_call_function_1(key_fn, h[0]), v) == binop_less_result);
-            do --t; while (h < t && mp_binary_op(MP_BINARY_OP_LESS, v, key_fn == MP_OBJ_NULL ? t[0] : mp_call_function_1(key_fn, t[0])) == binop_less_result);
-            if (h >= t) break;
-            mp_obj_t x = h[0];
-            h[0] = t[0];
-            t[0] = x;
+// list.sort is a stable merge sort of the natural runs in the list, a
+// simplified timsort without galloping.  Short runs are extended with a
+// binary insertion sort.  Pending runs are merged so that their lengths grow
+// at least as fast as the Fibonacci numbers, which bounds the run stack, and
+// each merge copies only the shorter of its two runs, so the scratch buffer
+// is at most half the length of the list.
+
+#define LIST_SORT_MAX_RUNS (sizeof(size_t) > 4 ? 85 : 40)
+
+// How keys are compared: homogeneous lists of small ints, floats or strs
+// are compared directly instead of with mp_binary_op.
+enum {
+    LIST_SORT_GENERIC,
+    LIST_SORT_SMALL_INT,
+    #if MICROPY_PY_BUILTINS_FLOAT
+    LIST_SORT_FLOAT,
+    #endif
+    LIST_SORT_STR,
+};
+
+typedef struct _list_sort_t {
+    mp_obj_t *keys; // what is compared
+    mp_obj_t *values; // the items, moved along with keys, or NULL if they are the keys
+    mp_obj_t *tmp_keys;
+    mp_obj_t *tmp_values;
+    size_t tmp_alloc;
+    // During a merge, the entries of tmp from tmp_lo to tmp_hi still need to
+    // go back to the list starting at dest, so that the list can be restored
+    // if a comparison raises an exception.
+    size_t tmp_lo;
+    size_t tmp_hi;
+    size_t dest;
+    uint8_t kind;
+    bool reverse;
+    size_t n_runs;
+    size_t runs_end;
+    size_t run_len[LIST_SORT_MAX_RUNS];
+} list_sort_t;
+
+STATIC bool list_sort_lt(uint8_t kind, mp_obj_t a, mp_obj_t b) {
+    switch (kind) {
+        case LIST_SORT_SMALL_INT:
+            return MP_OBJ_SMALL_INT_VALUE(a) < MP_OBJ_SMALL_INT_VALUE(b);
+        #if MICROPY_PY_BUILTINS_FLOAT
+        case LIST_SORT_FLOAT:
+            return mp_obj_float_get(a) < mp_obj_float_get(b);
+        #endif
+        case LIST_SORT_STR: {
+            size_t a_len, b_len;
+            const char *a_data = mp_obj_str_get_data(a, &a_len);
+            const char *b_data = mp_obj_str_get_data(b, &b_len);
+            return mp_seq_cmp_bytes(MP_BINARY_OP_LESS, (const byte*)a_data, a_len, (const byte*)b_data, b_len);
+        }
+        default:
+            return mp_obj_is_true(mp_binary_op(MP_BINARY_OP_LESS, a, b));
+    }
+}
+
+// Whether a sorts before b.
+static inline bool list_sort_less(list_sort_t *s, mp_obj_t a, mp_obj_t b) {
+    if (s->reverse) {
+        return list_sort_lt(s->kind, b, a);
+    } else {
+        return list_sort_lt(s->kind, a, b);
+    }
+}
+
+STATIC uint8_t list_sort_kind_of(mp_obj_t key) {
+    if (MP_OBJ_IS_SMALL_INT(key)) {
+        return LIST_SORT_SMALL_INT;
+    #if MICROPY_PY_BUILTINS_FLOAT
+    } else if (mp_obj_is_float(key)) {
+        return LIST_SORT_FLOAT;
+    #endif
+    } else if (MP_OBJ_IS_STR(key)) {
+        return LIST_SORT_STR;
+    } else {
+        return LIST_SORT_GENERIC;
+    }
+}
+
+STATIC uint8_t list_sort_kind(const mp_obj_t *keys, size_t n) {
+    uint8_t kind = list_sort_kind_of(keys[0]);
+    for (size_t i = 1; i < n && kind != LIST_SORT_GENERIC; i++) {
+        if (list_sort_kind_of(keys[i]) != kind) {
+            kind = LIST_SORT_GENERIC;
+        }
+    }
+    return kind;
+}
+
+// Move the entry at src in the list to dest.
+static inline void list_sort_move(list_sort_t *s, size_t dest, size_t src) {
+    s->keys[dest] = s->keys[src];
+    if (s->values != NULL) {
+        s->values[dest] = s->values[src];
+    }
+}
+
+static inline void list_sort_from_tmp(list_sort_t *s, size_t dest, size_t src) {
+    s->keys[dest] = s->tmp_keys[src];
+    if (s->values != NULL) {
+        s->values[dest] = s->tmp_values[src];
+    }
+}
+
+STATIC void list_sort_to_tmp(list_sort_t *s, size_t src, size_t n) {
+    if (s->tmp_alloc < n) {
+        // the shorter run of a merge is at most half of the list, so this is
+        // only reallocated a few times
+        size_t alloc = n < 16 ? 16 : n;
+        size_t factor = s->values == NULL ? 1 : 2;
+        s->tmp_keys = m_renew(mp_obj_t, s->tmp_keys, factor * s->tmp_alloc, factor * alloc);
+        s->tmp_values = s->tmp_keys + alloc;
+        s->tmp_alloc = alloc;
+    }
+    memcpy(s->tmp_keys, s->keys + src, n * sizeof(mp_obj_t));
+    if (s->values != NULL) {
+        memcpy(s->tmp_values, s->values + src, n * sizeof(mp_obj_t));
+    }
+}
+
+// Copy the entries of tmp that haven't been merged back to the list.
+STATIC void list_sort_flush_tmp(list_sort_t *s) {
+    for (; s->tmp_lo < s->tmp_hi; s->tmp_lo++) {
+        list_sort_from_tmp(s, s->dest++, s->tmp_lo);
+    }
+}
+
+// Sort the entries from lo to hi, of which those before start are sorted.
+STATIC void list_sort_insertion(list_sort_t *s, size_t lo, size_t start, size_t hi) {
+    for (; start < hi; start++) {
+        mp_obj_t key = s->keys[start];
+        // find the first entry that sorts after key, so equal entries keep their order
+        size_t l = lo, r = start;
+        while (l < r) {
+            size_t m = l + (r - l) / 2;
+            if (list_sort_less(s, key, s->keys[m])) {
+                r = m;
+            } else {
+                l = m + 1;
+            }
+        }
+        memmove(s->keys + l + 1, s->keys + l, (start - l) * sizeof(mp_obj_t));
+        s->keys[l] = key;
+        if (s->values != NULL) {
+            mp_obj_t value = s->values[start];
+            memmove(s->values + l + 1, s->values + l, (start - l) * sizeof(mp_obj_t));
+            s->values[l] = value;
+        }
+    }
+}
+
+// Return the length of the run starting at lo, reversing it if it descends.
+// Only a strictly descending run is reversed, to keep the sort stable.
+STATIC size_t list_sort_count_run(list_sort_t *s, size_t lo, size_t hi) {
+    size_t i = lo + 1;
+    if (i == hi) {
+        return 1;
+    }
+    if (list_sort_less(s, s->keys[i], s->keys[lo])) {
+        while (++i < hi && list_sort_less(s, s->keys[i], s->keys[i - 1])) {
+        }
+        for (size_t l = lo, r = i - 1; l < r; l++, r--) {
+            mp_obj_t x = s->keys[l];
+            s->keys[l] = s->keys[r];
+            s->keys[r] = x;
+            if (s->values != NULL) {
+                x = s->values[l];
+                s->values[l] = s->values[r];
+                s->values[r] = x;
+            }
+        }
+    } else {
+        while (++i < hi && !list_sort_less(s, s->keys[i], s->keys[i - 1])) {
         }
-        mp_obj_t x = h[0];
-        h[0] = tail[0];
-        tail[0] = x;
-        // do the smaller recursive call first, to keep stack within O(log(N))
-        if (t - head < tail - h - 1) {
-            mp_quicksort(head, t, key_fn, binop_less_result);
-            head = h + 1;
+    }
+    return i - lo;
+}
+
+// Merge the runs base..base+na and base+na..base+na+nb with na <= nb,
+// copying the first run to tmp and filling the list from the bottom.
+STATIC void list_sort_merge_lo(list_sort_t *s, size_t base, size_t na, size_t nb) {
+    list_sort_to_tmp(s, base, na);
+    s->tmp_lo = 0;
+    s->tmp_hi = na;
+    s->dest = base;
+    for (size_t j = base + na, end = j + nb; j < end && s->tmp_lo < s->tmp_hi;) {
+        if (list_sort_less(s, s->keys[j], s->tmp_keys[s->tmp_lo])) {
+            list_sort_move(s, s->dest++, j++);
         } else {
-            mp_quicksort(h + 1, tail, key_fn, binop_less_result);
-            tail = t;
+            list_sort_from_tmp(s, s->dest++, s->tmp_lo++);
+        }
+    }
+    list_sort_flush_tmp(s);
+}
+
+// Merge the runs as above with na > nb, copying the second run to tmp and
+// filling the list from the top.  The part of the list that is waiting for
+// the entries still in tmp starts at the end of what's left of the first run.
+STATIC void list_sort_merge_hi(list_sort_t *s, size_t base, size_t na, size_t nb) {
+    list_sort_to_tmp(s, base + na, nb);
+    s->tmp_lo = 0;
+    s->tmp_hi = nb;
+    s->dest = base + na;
+    for (size_t k = base + na + nb; s->dest > base && s->tmp_lo < s->tmp_hi;) {
+        if (list_sort_less(s, s->tmp_keys[s->tmp_hi - 1], s->keys[s->dest - 1])) {
+            list_sort_move(s, --k, --s->dest);
+        } else {
+            list_sort_from_tmp(s, --k, --s->tmp_hi);
+        }
+    }
+    list_sort_flush_tmp(s);
+}
+
+// Merge pending runs i and i + 1.
+STATIC void list_sort_merge_at(list_sort_t *s, size_t i) {
+    size_t na = s->run_len[i];
+    size_t nb = s->run_len[i + 1];
+    size_t base = s->runs_end;
+    for (size_t j = i; j < s->n_runs; j++) {
+        base -= s->run_len[j];
+    }
+    s->run_len[i] = na + nb;
+    if (i + 3 == s->n_runs) {
+        s->run_len[i + 1] = s->run_len[i + 2];
+    }
+    s->n_runs -= 1;
+
+    // entries at the start of the first run that sort before the second run,
+    // and at the end of the second run that sort after the first run, are
+    // already in place
+    mp_obj_t key = s->keys[base + na];
+    while (na > 0 && !list_sort_less(s, key, s->keys[base])) {
+        base++;
+        na--;
+    }
+    if (na == 0) {
+        return;
+    }
+    key = s->keys[base + na - 1];
+    while (nb > 0 && !list_sort_less(s, s->keys[base + na + nb - 1], key)) {
+        nb--;
+    }
+    if (nb == 0) {
+        return;
+    }
+
+    if (na <= nb) {
+        list_sort_merge_lo(s, base, na, nb);
+    } else {
+        list_sort_merge_hi(s, base, na, nb);
+    }
+}
+
+// Merge pending runs until their lengths satisfy the invariants of timsort,
+// checking the top 4 runs.
+STATIC void list_sort_collapse(list_sort_t *s) {
+    size_t *len = s->run_len;
+    while (s->n_runs > 1) {
+        size_t n = s->n_runs - 2;
+        if ((n > 0 && len[n - 1] <= len[n] + len[n + 1])
+            || (n > 1 && len[n - 2] <= len[n - 1] + len[n])) {
+            if (len[n - 1] < len[n + 1]) {
+                n--;
+            }
+        } else if (len[n] > len[n + 1]) {
+            break;
         }
+        list_sort_merge_at(s, n);
+    }
+}
+
+STATIC void list_sort_run(list_sort_t *s, size_t n) {
+    // a run shorter than min_run is extended, where min_run is chosen to
+    // give a number of runs equal to, or a little below, a power of 2
+    size_t min_run = n;
+    bool round_up = false;
+    while (min_run >= 32) {
+        round_up |= min_run & 1;
+        min_run >>= 1;
+    }
+    min_run += round_up;
+
+    for (size_t lo = 0; lo < n;) {
+        size_t run = list_sort_count_run(s, lo, n);
+        if (run < min_run) {
+            size_t force = n - lo < min_run ? n - lo : min_run;
+            list_sort_insertion(s, lo, lo + run, lo + force);
+            run = force;
+        }
+        s->run_len[s->n_runs++] = run;
+        s->runs_end = lo + run;
+        list_sort_collapse(s);
+        lo += run;
+    }
+    while (s->n_runs > 1) {
+        size_t i = s->n_runs - 2;
+        if (i > 0 && s->run_len[i - 1] < s->run_len[i + 1]) {
+            i--;
+        }
+        list_sort_merge_at(s, i);
     }
 }
 
-// TODO Python defines sort to be stable but ours is not
 mp_obj_t mp_obj_list_sort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
     static const mp_arg_t allowed_args[] = {
         { MP_QSTR_key, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_PTR(&mp_const_none_obj)} },
@@ -330,10 +605,49 @@ mp_obj_t mp_obj_list_sort(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_
     mp_check_self(MP_OBJ_IS_TYPE(pos_args[0], &mp_type_list));
     mp_obj_list_t *self = MP_OBJ_TO_PTR(pos_args[0]);
 
-    if (self->len > 1) {
-        mp_quicksort(self->items, self->items + self->len - 1,
-                     args.key.u_obj == mp_const_none ? MP_OBJ_NULL : args.key.u_obj,
-                     args.reverse.u_bool ? mp_const_false : mp_const_true);
+    size_t n = self->len;
+    if (n <= 1) {
+        return mp_const_none;
+    }
+
+    list_sort_t s;
+    s.values = NULL;
+    s.tmp_keys = NULL;
+    s.tmp_alloc = 0;
+    s.tmp_lo = s.tmp_hi = 0;
+    s.reverse = args.reverse.u_bool;
+    s.n_runs = 0;
+    if (args.key.u_obj == mp_const_none) {
+        s.keys = self->items;
+    } else {
+        // call the key function once for each item
+        s.keys = m_new(mp_obj_t, n);
+        for (size_t i = 0; i < n; i++) {
+            s.keys[i] = mp_call_function_1(args.key.u_obj, self->items[i]);
+        }
+        s.values = self->items;
+    }
+    s.kind = list_sort_kind(s.keys, n);
+
+    void *exc = NULL;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        list_sort_run(&s, n);
+        nlr_pop();
+    } else {
+        // a comparison raised, so put back any items that were being merged
+        // so that the list keeps all its items
+        list_sort_flush_tmp(&s);
+        exc = nlr.ret_val;
+    }
+
+    size_t factor = s.values == NULL ? 1 : 2;
+    m_del(mp_obj_t, s.tmp_keys, factor * s.tmp_alloc);
+    if (s.values != NULL) {
+        m_del(mp_obj_t, s.keys, n);
+    }
+    if (exc != NULL) {
+        nlr_jump(exc);
     }
 
     return mp_const_none;
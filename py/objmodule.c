@@ -195,9 +195,18 @@ STATIC const mp_rom_map_elem_t mp_builtin_module_table[] = {
 #if MICROPY_PY_UHEAPQ
     { MP_ROM_QSTR(MP_QSTR_uheapq), MP_ROM_PTR(&mp_module_uheapq) },
 #endif
+#if MICROPY_PY_UARRAYOPS
+    { MP_ROM_QSTR(MP_QSTR_uarrayops), MP_ROM_PTR(&mp_module_uarrayops) },
+#endif
+#if MICROPY_PY_UMMAP
+    { MP_ROM_QSTR(MP_QSTR_ummap), MP_ROM_PTR(&mp_module_ummap) },
+#endif
 #if MICROPY_PY_UTIMEQ
     { MP_ROM_QSTR(MP_QSTR_utimeq), MP_ROM_PTR(&mp_module_utimeq) },
 #endif
+#if MICROPY_PY_UEVLOOP
+    { MP_ROM_QSTR(MP_QSTR_uevloop), MP_ROM_PTR(&mp_module_uevloop) },
+#endif
 #if MICROPY_PY_UHASHLIB
     { MP_ROM_QSTR(MP_QSTR_hashlib), MP_ROM_PTR(&mp_module_uhashlib) },
 #endif
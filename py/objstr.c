@@ -270,30 +270,139 @@ wrong_args:
     mp_raise_TypeError(translate("wrong number of arguments"));
 }
 
+#if MICROPY_OPT_FAST_STR_SEARCH
+
+// Word-at-a-time ("SWAR") byte search.  XOR-ing a word with the search byte
+// replicated into every lane turns matching lanes into zero bytes, which
+// SWAR_HAS_ZERO detects without examining each byte individually.
+#define SWAR_ONES ((size_t)-1 / 0xff)
+#define SWAR_HIGHS (SWAR_ONES * 0x80)
+#define SWAR_HAS_ZERO(w) (((w) - SWAR_ONES) & ~(w) & SWAR_HIGHS)
+#define SWAR_ALIGNED(p) (((uintptr_t)(p) & (sizeof(size_t) - 1)) == 0)
+
+// Needles at least this long use Horspool skipping, provided the haystack is
+// long enough to amortise building the skip table.
+#define FIND_SUBBYTES_HORSPOOL_MIN_NLEN (4)
+#define FIND_SUBBYTES_HORSPOOL_MIN_HLEN (64)
+
+STATIC const byte *find_byte_fwd(const byte *s, size_t n, byte c) {
+    const byte *top = s + n;
+    for (; s < top && !SWAR_ALIGNED(s); s++) {
+        if (*s == c) {
+            return s;
+        }
+    }
+    size_t pattern = SWAR_ONES * c;
+    for (; (size_t)(top - s) >= sizeof(size_t); s += sizeof(size_t)) {
+        size_t w = *(const size_t*)s ^ pattern;
+        if (SWAR_HAS_ZERO(w)) {
+            break;
+        }
+    }
+    for (; s < top; s++) {
+        if (*s == c) {
+            return s;
+        }
+    }
+    return NULL;
+}
+
+STATIC const byte *find_byte_rev(const byte *s, size_t n, byte c) {
+    const byte *top = s + n;
+    for (; top > s && !SWAR_ALIGNED(top); top--) {
+        if (top[-1] == c) {
+            return top - 1;
+        }
+    }
+    size_t pattern = SWAR_ONES * c;
+    for (; (size_t)(top - s) >= sizeof(size_t); top -= sizeof(size_t)) {
+        size_t w = *(const size_t*)(top - sizeof(size_t)) ^ pattern;
+        if (SWAR_HAS_ZERO(w)) {
+            break;
+        }
+    }
+    for (; top > s; top--) {
+        if (top[-1] == c) {
+            return top - 1;
+        }
+    }
+    return NULL;
+}
+
+// Boyer-Moore-Horspool search; requires 2 <= nlen <= hlen
+STATIC const byte *find_subbytes_horspool(const byte *haystack, size_t hlen, const byte *needle, size_t nlen) {
+    // shifts are capped at 255, which is always safe (just less aggressive)
+    byte skip[256];
+    memset(skip, nlen < 255 ? nlen : 255, sizeof(skip));
+    for (size_t i = 0; i < nlen - 1; i++) {
+        size_t d = nlen - 1 - i;
+        skip[needle[i]] = d < 255 ? d : 255;
+    }
+    byte last = needle[nlen - 1];
+    for (size_t i = 0; i <= hlen - nlen; ) {
+        byte c = haystack[i + nlen - 1];
+        if (c == last && memcmp(haystack + i, needle, nlen - 1) == 0) {
+            return haystack + i;
+        }
+        i += skip[c];
+    }
+    return NULL;
+}
+
+#endif // MICROPY_OPT_FAST_STR_SEARCH
+
 // like strstr but with specified length and allows \0 bytes
-// TODO replace with something more efficient/standard
 const byte *find_subbytes(const byte *haystack, size_t hlen, const byte *needle, size_t nlen, int direction) {
-    if (hlen >= nlen) {
-        size_t str_index, str_index_end;
-        if (direction > 0) {
-            str_index = 0;
-            str_index_end = hlen - nlen;
-        } else {
-            str_index = hlen - nlen;
-            str_index_end = 0;
-        }
-        for (;;) {
-            if (memcmp(&haystack[str_index], needle, nlen) == 0) {
-                //found
-                return haystack + str_index;
+    if (hlen < nlen) {
+        return NULL;
+    }
+    #if MICROPY_OPT_FAST_STR_SEARCH
+    if (nlen == 0) {
+        return direction > 0 ? haystack : haystack + hlen;
+    }
+    // candidate start positions are haystack[0] .. haystack[hlen - nlen]
+    size_t ncand = hlen - nlen + 1;
+    if (direction > 0) {
+        if (nlen >= FIND_SUBBYTES_HORSPOOL_MIN_NLEN && hlen >= FIND_SUBBYTES_HORSPOOL_MIN_HLEN) {
+            return find_subbytes_horspool(haystack, hlen, needle, nlen);
+        }
+        // find each occurrence of the first needle byte and verify the rest
+        const byte *top = haystack + ncand;
+        for (const byte *p = haystack; (p = find_byte_fwd(p, top - p, needle[0])) != NULL; p++) {
+            if (memcmp(p + 1, needle + 1, nlen - 1) == 0) {
+                return p;
             }
-            if (str_index == str_index_end) {
-                //not found
-                break;
+        }
+    } else {
+        const byte *p;
+        while ((p = find_byte_rev(haystack, ncand, needle[0])) != NULL) {
+            if (memcmp(p + 1, needle + 1, nlen - 1) == 0) {
+                return p;
             }
-            str_index += direction;
+            ncand = p - haystack;
         }
     }
+    #else
+    size_t str_index, str_index_end;
+    if (direction > 0) {
+        str_index = 0;
+        str_index_end = hlen - nlen;
+    } else {
+        str_index = hlen - nlen;
+        str_index_end = 0;
+    }
+    for (;;) {
+        if (memcmp(&haystack[str_index], needle, nlen) == 0) {
+            //found
+            return haystack + str_index;
+        }
+        if (str_index == str_index_end) {
+            //not found
+            break;
+        }
+        str_index += direction;
+    }
+    #endif
     return NULL;
 }
 
@@ -503,12 +612,12 @@ mp_obj_t mp_obj_str_split(size_t n_args, const mp_obj_t *args) {
         }
     }
 
-    mp_obj_t res = mp_obj_new_list(0, NULL);
     GET_STR_DATA_LEN(args[0], s, len);
     const byte *top = s + len;
 
     if (sep == mp_const_none) {
         // sep not given, so separate on whitespace
+        mp_obj_t res = mp_obj_new_list(0, NULL);
 
         // Initial whitespace is not counted as split, so we pre-do it
         while (s < top && unichar_isspace(*s)) s++;
@@ -529,6 +638,7 @@ mp_obj_t mp_obj_str_split(size_t n_args, const mp_obj_t *args) {
             mp_obj_list_append(res, mp_obj_new_str_of_type(self_type, s, top - s));
         }
 
+        return res;
     } else {
         // sep given
         if (mp_obj_get_type(sep) != self_type) {
@@ -542,29 +652,26 @@ mp_obj_t mp_obj_str_split(size_t n_args, const mp_obj_t *args) {
             mp_raise_ValueError(translate("empty separator"));
         }
 
-        for (;;) {
-            const byte *start = s;
-            for (;;) {
-                if (splits == 0 || s + sep_len > top) {
-                    s = top;
-                    break;
-                } else if (memcmp(s, sep_str, sep_len) == 0) {
-                    break;
-                }
-                s++;
-            }
-            mp_obj_list_append(res, mp_obj_new_str_of_type(self_type, start, s - start));
-            if (s >= top) {
+        // first pass counts the separators so the result list can be
+        // allocated at its final size, second pass creates the pieces
+        size_t num_seps = 0;
+        for (const byte *p = s; splits < 0 || num_seps < (size_t)splits; p += sep_len) {
+            p = find_subbytes(p, top - p, (const byte*)sep_str, sep_len, 1);
+            if (p == NULL) {
                 break;
             }
-            s += sep_len;
-            if (splits > 0) {
-                splits--;
-            }
+            num_seps++;
         }
-    }
 
-    return res;
+        mp_obj_list_t *res = MP_OBJ_TO_PTR(mp_obj_new_list(num_seps + 1, NULL));
+        for (size_t i = 0; i < num_seps; i++) {
+            const byte *p = find_subbytes(s, top - s, (const byte*)sep_str, sep_len, 1);
+            res->items[i] = mp_obj_new_str_of_type(self_type, s, p - s);
+            s = p + sep_len;
+        }
+        res->items[num_seps] = mp_obj_new_str_of_type(self_type, s, top - s);
+        return MP_OBJ_FROM_PTR(res);
+    }
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(str_split_obj, 1, 3, mp_obj_str_split);
 
@@ -650,16 +757,11 @@ STATIC mp_obj_t str_rsplit(size_t n_args, const mp_obj_t *args) {
         const byte *beg = s;
         const byte *last = s + len;
         for (;;) {
-            s = last - sep_len;
-            for (;;) {
-                if (splits == 0 || s < beg) {
-                    break;
-                } else if (memcmp(s, sep_str, sep_len) == 0) {
-                    break;
-                }
-                s--;
+            s = NULL;
+            if (splits != 0) {
+                s = find_subbytes(beg, last - beg, (const byte*)sep_str, sep_len, -1);
             }
-            if (s < beg || splits == 0) {
+            if (s == NULL) {
                 res->items[idx] = mp_obj_new_str_of_type(self_type, beg, last - beg);
                 break;
             }
@@ -1714,15 +1816,17 @@ STATIC mp_obj_t str_count(size_t n_args, const mp_obj_t *args) {
         return MP_OBJ_NEW_SMALL_INT(utf8_charlen(start, end - start) + 1);
     }
 
-    // count the occurrences
+    if (end < start) {
+        return MP_OBJ_NEW_SMALL_INT(0);
+    }
+
+    // count the occurrences; a match can't begin in the middle of a UTF-8
+    // encoded char so there's no need to step over the haystack char by char
     mp_int_t num_occurrences = 0;
-    for (const byte *haystack_ptr = start; haystack_ptr + needle_len <= end;) {
-        if (memcmp(haystack_ptr, needle, needle_len) == 0) {
-            num_occurrences++;
-            haystack_ptr += needle_len;
-        } else {
-            haystack_ptr = utf8_next_char(haystack_ptr);
-        }
+    for (const byte *haystack_ptr = start;
+        (haystack_ptr = find_subbytes(haystack_ptr, end - haystack_ptr, needle, needle_len, 1)) != NULL;
+        haystack_ptr += needle_len) {
+        num_occurrences++;
     }
 
     return MP_OBJ_NEW_SMALL_INT(num_occurrences);
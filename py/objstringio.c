@@ -73,6 +73,7 @@ STATIC void stringio_copy_on_write(mp_obj_stringio_t *o) {
     const void *buf = o->vstr->buf;
     o->vstr->buf = m_new(char, o->vstr->len);
     memcpy(o->vstr->buf, buf, o->vstr->len);
+    o->vstr->alloc = o->vstr->len;
     o->vstr->fixed_buf = false;
     o->ref_obj = MP_OBJ_NULL;
 }
@@ -167,8 +168,25 @@ STATIC mp_uint_t stringio_ioctl(mp_obj_t o_in, mp_uint_t request, uintptr_t arg,
 STATIC mp_obj_t stringio_getvalue(mp_obj_t self_in) {
     mp_obj_stringio_t *self = MP_OBJ_TO_PTR(self_in);
     check_stringio_is_open(self);
-    // TODO: Try to avoid copying string
-    return mp_obj_new_str_of_type(STREAM_TO_CONTENT_TYPE(self), (byte*)self->vstr->buf, self->vstr->len);
+    const mp_obj_type_t *type = STREAM_TO_CONTENT_TYPE(self);
+    if (self->vstr->fixed_buf) {
+        // Buffer is still shared with the str/bytes object it came from, so
+        // that object holds exactly the current value if its type matches
+        if (self->ref_obj != MP_OBJ_NULL && mp_obj_get_type(self->ref_obj) == type) {
+            return self->ref_obj;
+        }
+        return mp_obj_new_str_of_type(type, (byte*)self->vstr->buf, self->vstr->len);
+    }
+    // Hand the buffer over to the new object without copying it, and keep
+    // reading from it as a shared buffer; the next write copies it back out.
+    vstr_t vstr = *self->vstr;
+    mp_obj_t value = mp_obj_new_str_from_vstr(type, &vstr);
+    size_t len;
+    const char *data = mp_obj_str_get_data(value, &len);
+    vstr_init_fixed_buf(self->vstr, len, (char*)data);
+    self->vstr->len = len;
+    self->ref_obj = value;
+    return value;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(stringio_getvalue_obj, stringio_getvalue);
 
@@ -835,56 +835,65 @@ STATIC void push_result_rule(parser_t *parser, size_t src_line, uint8_t rule_id,
     push_result_node(parser, (mp_parse_node_t)pn);
 }
 
-mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
-
-    // initialise parser and allocate memory for its stacks
-
-    parser_t parser;
-
-    parser.rule_stack_alloc = MICROPY_ALLOC_PARSE_RULE_INIT;
-    parser.rule_stack_top = 0;
-    parser.rule_stack = NULL;
-    while (parser.rule_stack_alloc > 1) {
-        parser.rule_stack = m_new_maybe(rule_stack_t, parser.rule_stack_alloc);
-        if (parser.rule_stack != NULL) {
+STATIC void parser_init(parser_t *parser, mp_lexer_t *lex) {
+    // allocate memory for the parser's stacks
+
+    parser->rule_stack_alloc = MICROPY_ALLOC_PARSE_RULE_INIT;
+    parser->rule_stack_top = 0;
+    parser->rule_stack = NULL;
+    while (parser->rule_stack_alloc > 1) {
+        parser->rule_stack = m_new_maybe(rule_stack_t, parser->rule_stack_alloc);
+        if (parser->rule_stack != NULL) {
             break;
         } else {
-            parser.rule_stack_alloc /= 2;
+            parser->rule_stack_alloc /= 2;
         }
     }
 
-    parser.result_stack_alloc = MICROPY_ALLOC_PARSE_RESULT_INIT;
-    parser.result_stack_top = 0;
-    parser.result_stack = NULL;
-    while (parser.result_stack_alloc > 1) {
-        parser.result_stack = m_new_maybe(mp_parse_node_t, parser.result_stack_alloc);
-        if (parser.result_stack != NULL) {
+    parser->result_stack_alloc = MICROPY_ALLOC_PARSE_RESULT_INIT;
+    parser->result_stack_top = 0;
+    parser->result_stack = NULL;
+    while (parser->result_stack_alloc > 1) {
+        parser->result_stack = m_new_maybe(mp_parse_node_t, parser->result_stack_alloc);
+        if (parser->result_stack != NULL) {
             break;
         } else {
-            parser.result_stack_alloc /= 2;
+            parser->result_stack_alloc /= 2;
         }
     }
-    if (parser.rule_stack == NULL || parser.result_stack == NULL) {
+    if (parser->rule_stack == NULL || parser->result_stack == NULL) {
         mp_raise_msg(&mp_type_MemoryError, translate("Unable to init parser"));
     }
 
-    parser.lexer = lex;
+    parser->lexer = lex;
 
-    parser.tree.chunk = NULL;
-    parser.cur_chunk = NULL;
+    #if MICROPY_COMP_CONST
+    mp_map_init(&parser->consts, 0);
+    #endif
+}
 
+STATIC void parser_free(parser_t *parser) {
     #if MICROPY_COMP_CONST
-    mp_map_init(&parser.consts, 0);
+    mp_map_deinit(&parser->consts);
     #endif
 
-    // work out the top-level rule to use, and push it on the stack
-    size_t top_level_rule;
-    switch (input_kind) {
-        case MP_PARSE_SINGLE_INPUT: top_level_rule = RULE_single_input; break;
-        case MP_PARSE_EVAL_INPUT: top_level_rule = RULE_eval_input; break;
-        default: top_level_rule = RULE_file_input;
-    }
-    push_rule(&parser, lex->tok_line, top_level_rule, 0);
+    // free the memory that we don't need anymore
+    m_del(rule_stack_t, parser->rule_stack, parser->rule_stack_alloc);
+    m_del(mp_parse_node_t, parser->result_stack, parser->result_stack_alloc);
+
+    // we also free the lexer on behalf of the caller
+    mp_lexer_free(parser->lexer);
+}
+
+// Parse one instance of top_level_rule into parser->tree.  If to_end is set
+// then the rule must match all of the remaining input.
+STATIC void parser_parse(parser_t *parser, size_t top_level_rule, mp_parse_input_kind_t input_kind, bool to_end) {
+    mp_lexer_t *lex = parser->lexer;
+
+    parser->tree.chunk = NULL;
+    parser->cur_chunk = NULL;
+
+    push_rule(parser, lex->tok_line, top_level_rule, 0);
 
     // parse!
 
@@ -892,22 +901,22 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
 
     for (;;) {
         next_rule:
-        if (parser.rule_stack_top == 0) {
+        if (parser->rule_stack_top == 0) {
             break;
         }
 
         // Pop the next rule to process it
         size_t i; // state for the current rule
         size_t rule_src_line; // source line for the first token matched by the current rule
-        uint8_t rule_id = pop_rule(&parser, &i, &rule_src_line);
+        uint8_t rule_id = pop_rule(parser, &i, &rule_src_line);
         uint8_t rule_act = rule_act_table[rule_id];
         const uint16_t *rule_arg = get_rule_arg(rule_id);
         size_t n = rule_act & RULE_ACT_ARG_MASK;
 
         #if 0
         // debugging
-        printf("depth=" UINT_FMT " ", parser.rule_stack_top);
-        for (int j = 0; j < parser.rule_stack_top; ++j) {
+        printf("depth=" UINT_FMT " ", parser->rule_stack_top);
+        for (int j = 0; j < parser->rule_stack_top; ++j) {
             printf(" ");
         }
         printf("%s n=" UINT_FMT " i=" UINT_FMT " bt=%d\n", rule_name_table[rule_id], n, i, backtrack);
@@ -924,16 +933,16 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                     uint16_t kind = rule_arg[i] & RULE_ARG_KIND_MASK;
                     if (kind == RULE_ARG_TOK) {
                         if (lex->tok_kind == (rule_arg[i] & RULE_ARG_ARG_MASK)) {
-                            push_result_token(&parser, rule_id);
+                            push_result_token(parser, rule_id);
                             mp_lexer_to_next(lex);
                             goto next_rule;
                         }
                     } else {
                         assert(kind == RULE_ARG_RULE);
                         if (i + 1 < n) {
-                            push_rule(&parser, rule_src_line, rule_id, i + 1); // save this or-rule
+                            push_rule(parser, rule_src_line, rule_id, i + 1); // save this or-rule
                         }
-                        push_rule_from_arg(&parser, rule_arg[i]); // push child of or-rule
+                        push_rule_from_arg(parser, rule_arg[i]); // push child of or-rule
                         goto next_rule;
                     }
                 }
@@ -947,7 +956,7 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                     assert(i > 0);
                     if ((rule_arg[i - 1] & RULE_ARG_KIND_MASK) == RULE_ARG_OPT_RULE) {
                         // an optional rule that failed, so continue with next arg
-                        push_result_node(&parser, MP_PARSE_NODE_NULL);
+                        push_result_node(parser, MP_PARSE_NODE_NULL);
                         backtrack = false;
                     } else {
                         // a mandatory rule that failed, so propagate backtrack
@@ -968,7 +977,7 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                         if (lex->tok_kind == tok_kind) {
                             // matched token
                             if (tok_kind == MP_TOKEN_NAME) {
-                                push_result_token(&parser, rule_id);
+                                push_result_token(parser, rule_id);
                             }
                             mp_lexer_to_next(lex);
                         } else {
@@ -983,8 +992,8 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                             }
                         }
                     } else {
-                        push_rule(&parser, rule_src_line, rule_id, i + 1); // save this and-rule
-                        push_rule_from_arg(&parser, rule_arg[i]); // push child of and-rule
+                        push_rule(parser, rule_src_line, rule_id, i + 1); // save this and-rule
+                        push_rule_from_arg(parser, rule_arg[i]); // push child of and-rule
                         goto next_rule;
                     }
                 }
@@ -995,16 +1004,16 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
 
                 #if !MICROPY_ENABLE_DOC_STRING
                 // this code discards lonely statements, such as doc strings
-                if (input_kind != MP_PARSE_SINGLE_INPUT && rule_id == RULE_expr_stmt && peek_result(&parser, 0) == MP_PARSE_NODE_NULL) {
-                    mp_parse_node_t p = peek_result(&parser, 1);
+                if (input_kind != MP_PARSE_SINGLE_INPUT && rule_id == RULE_expr_stmt && peek_result(parser, 0) == MP_PARSE_NODE_NULL) {
+                    mp_parse_node_t p = peek_result(parser, 1);
                     if ((MP_PARSE_NODE_IS_LEAF(p) && !MP_PARSE_NODE_IS_ID(p))
                         || MP_PARSE_NODE_IS_STRUCT_KIND(p, RULE_const_object)) {
-                        pop_result(&parser); // MP_PARSE_NODE_NULL
-                        pop_result(&parser); // const expression (leaf or RULE_const_object)
+                        pop_result(parser); // MP_PARSE_NODE_NULL
+                        pop_result(parser); // const expression (leaf or RULE_const_object)
                         // Pushing the "pass" rule here will overwrite any RULE_const_object
                         // entry that was on the result stack, allowing the GC to reclaim
                         // the memory from the const object when needed.
-                        push_result_rule(&parser, rule_src_line, RULE_pass_stmt, 0);
+                        push_result_rule(parser, rule_src_line, RULE_pass_stmt, 0);
                         break;
                     }
                 }
@@ -1024,7 +1033,7 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                         }
                     } else {
                         // rules are always pushed
-                        if (peek_result(&parser, i) != MP_PARSE_NODE_NULL) {
+                        if (peek_result(parser, i) != MP_PARSE_NODE_NULL) {
                             num_not_nil += 1;
                         }
                         i += 1;
@@ -1035,22 +1044,22 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                     // this rule has only 1 argument and should not be emitted
                     mp_parse_node_t pn = MP_PARSE_NODE_NULL;
                     for (size_t x = 0; x < i; ++x) {
-                        mp_parse_node_t pn2 = pop_result(&parser);
+                        mp_parse_node_t pn2 = pop_result(parser);
                         if (pn2 != MP_PARSE_NODE_NULL) {
                             pn = pn2;
                         }
                     }
-                    push_result_node(&parser, pn);
+                    push_result_node(parser, pn);
                 } else {
                     // this rule must be emitted
 
                     if (rule_act & RULE_ACT_ADD_BLANK) {
                         // and add an extra blank node at the end (used by the compiler to store data)
-                        push_result_node(&parser, MP_PARSE_NODE_NULL);
+                        push_result_node(parser, MP_PARSE_NODE_NULL);
                         i += 1;
                     }
 
-                    push_result_rule(&parser, rule_src_line, rule_id, i);
+                    push_result_rule(parser, rule_src_line, rule_id, i);
                 }
                 break;
             }
@@ -1100,7 +1109,7 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                                 if (i & 1 & n) {
                                     // separators which are tokens are not pushed to result stack
                                 } else {
-                                    push_result_token(&parser, rule_id);
+                                    push_result_token(parser, rule_id);
                                 }
                                 mp_lexer_to_next(lex);
                                 // got element of list, so continue parsing list
@@ -1113,8 +1122,8 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                             }
                         } else {
                             assert((arg & RULE_ARG_KIND_MASK) == RULE_ARG_RULE);
-                            push_rule(&parser, rule_src_line, rule_id, i + 1); // save this list-rule
-                            push_rule_from_arg(&parser, arg); // push child of list-rule
+                            push_rule(parser, rule_src_line, rule_id, i + 1); // save this list-rule
+                            push_rule_from_arg(parser, arg); // push child of list-rule
                             goto next_rule;
                         }
                     }
@@ -1132,36 +1141,32 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
                     // list matched single item
                     if (had_trailing_sep) {
                         // if there was a trailing separator, make a list of a single item
-                        push_result_rule(&parser, rule_src_line, rule_id, i);
+                        push_result_rule(parser, rule_src_line, rule_id, i);
                     } else {
                         // just leave single item on stack (ie don't wrap in a list)
                     }
                 } else {
-                    push_result_rule(&parser, rule_src_line, rule_id, i);
+                    push_result_rule(parser, rule_src_line, rule_id, i);
                 }
                 break;
             }
         }
     }
 
-    #if MICROPY_COMP_CONST
-    mp_map_deinit(&parser.consts);
-    #endif
-
     // truncate final chunk and link into chain of chunks
-    if (parser.cur_chunk != NULL) {
-        (void)m_renew_maybe(byte, parser.cur_chunk,
-            sizeof(mp_parse_chunk_t) + parser.cur_chunk->alloc,
-            sizeof(mp_parse_chunk_t) + parser.cur_chunk->union_.used,
+    if (parser->cur_chunk != NULL) {
+        (void)m_renew_maybe(byte, parser->cur_chunk,
+            sizeof(mp_parse_chunk_t) + parser->cur_chunk->alloc,
+            sizeof(mp_parse_chunk_t) + parser->cur_chunk->union_.used,
             false);
-        parser.cur_chunk->alloc = parser.cur_chunk->union_.used;
-        parser.cur_chunk->union_.next = parser.tree.chunk;
-        parser.tree.chunk = parser.cur_chunk;
+        parser->cur_chunk->alloc = parser->cur_chunk->union_.used;
+        parser->cur_chunk->union_.next = parser->tree.chunk;
+        parser->tree.chunk = parser->cur_chunk;
     }
 
     if (
-        lex->tok_kind != MP_TOKEN_END // check we are at the end of the token stream
-        || parser.result_stack_top == 0 // check that we got a node (can fail on empty input)
+        (to_end && lex->tok_kind != MP_TOKEN_END) // check we are at the end of the token stream
+        || parser->result_stack_top == 0 // check that we got a node (can fail on empty input)
         ) {
     syntax_error:;
         mp_obj_t exc;
@@ -1182,19 +1187,73 @@ mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
     }
 
     // get the root parse node that we created
-    assert(parser.result_stack_top == 1);
-    parser.tree.root = parser.result_stack[0];
+    assert(parser->result_stack_top == 1);
+    parser->tree.root = parser->result_stack[0];
+    parser->result_stack_top = 0;
+}
 
-    // free the memory that we don't need anymore
-    m_del(rule_stack_t, parser.rule_stack, parser.rule_stack_alloc);
-    m_del(mp_parse_node_t, parser.result_stack, parser.result_stack_alloc);
+mp_parse_tree_t mp_parse(mp_lexer_t *lex, mp_parse_input_kind_t input_kind) {
+    parser_t parser;
+    parser_init(&parser, lex);
 
-    // we also free the lexer on behalf of the caller
-    mp_lexer_free(lex);
+    // work out the top-level rule to use
+    size_t top_level_rule;
+    switch (input_kind) {
+        case MP_PARSE_SINGLE_INPUT: top_level_rule = RULE_single_input; break;
+        case MP_PARSE_EVAL_INPUT: top_level_rule = RULE_eval_input; break;
+        default: top_level_rule = RULE_file_input;
+    }
+
+    parser_parse(&parser, top_level_rule, input_kind, true);
+    parser_free(&parser);
 
     return parser.tree;
 }
 
+#if MICROPY_COMP_INCREMENTAL
+mp_parse_stream_t *mp_parse_stream_new(mp_lexer_t *lex) {
+    parser_t *parser = m_new_obj(parser_t);
+    parser_init(parser, lex);
+    return parser;
+}
+
+// Skip the newlines between statements, as file_input does, and return
+// whether the end of the input has been reached.
+STATIC bool parser_at_end(parser_t *parser) {
+    mp_lexer_t *lex = parser->lexer;
+    while (lex->tok_kind == MP_TOKEN_NEWLINE) {
+        mp_lexer_to_next(lex);
+    }
+    return lex->tok_kind == MP_TOKEN_END;
+}
+
+bool mp_parse_stream_next(mp_parse_stream_t *parser, mp_parse_tree_t *tree) {
+    if (parser->lexer == NULL) {
+        return false;
+    }
+    if (parser_at_end(parser)) {
+        parser_free(parser);
+        parser->lexer = NULL;
+        return false;
+    }
+    parser_parse(parser, RULE_stmt, MP_PARSE_FILE_INPUT, false);
+    *tree = parser->tree;
+    if (parser_at_end(parser)) {
+        // close the input now rather than after the last statement has run
+        parser_free(parser);
+        parser->lexer = NULL;
+    }
+    return true;
+}
+
+void mp_parse_stream_free(mp_parse_stream_t *parser) {
+    if (parser->lexer != NULL) {
+        parser_free(parser);
+    }
+    m_del_obj(parser_t, parser);
+}
+#endif
+
 void mp_parse_tree_clear(mp_parse_tree_t *tree) {
     mp_parse_chunk_t *chunk = tree->chunk;
     while (chunk != NULL) {
@@ -104,4 +104,15 @@ typedef struct _mp_parse_t {
 mp_parse_tree_t mp_parse(struct _mp_lexer_t *lex, mp_parse_input_kind_t input_kind);
 void mp_parse_tree_clear(mp_parse_tree_t *tree);
 
+#if MICROPY_COMP_INCREMENTAL
+// Parse a file one top-level statement at a time, so that each statement can
+// be compiled and its parse tree freed before the next one is parsed.
+// mp_parse_stream_next returns false at the end of the input.  The lexer is
+// freed as soon as all of its input has been parsed.
+typedef struct _parser_t mp_parse_stream_t;
+mp_parse_stream_t *mp_parse_stream_new(struct _mp_lexer_t *lex);
+bool mp_parse_stream_next(mp_parse_stream_t *ps, mp_parse_tree_t *tree);
+void mp_parse_stream_free(mp_parse_stream_t *ps);
+#endif
+
 #endif // MICROPY_INCLUDED_PY_PARSE_H
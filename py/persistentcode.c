@@ -103,19 +103,23 @@ STATIC void extract_prelude(const byte **ip, const byte **ip2, bytecode_prelude_
 #include "py/parsenum.h"
 
 STATIC int read_byte(mp_reader_t *reader) {
-    return reader->readbyte(reader->data);
+    mp_uint_t b = reader->readbyte(reader->data);
+    if (b == MP_READER_EOF) {
+        mp_raise_ValueError(translate("truncated .mpy file"));
+    }
+    return b;
 }
 
 STATIC void read_bytes(mp_reader_t *reader, byte *buf, size_t len) {
     while (len-- > 0) {
-        *buf++ = reader->readbyte(reader->data);
+        *buf++ = read_byte(reader);
     }
 }
 
 STATIC size_t read_uint(mp_reader_t *reader) {
     size_t unum = 0;
     for (;;) {
-        byte b = reader->readbyte(reader->data);
+        byte b = read_byte(reader);
         unum = (unum << 7) | (b & 0x7f);
         if ((b & 0x80) == 0) {
             break;
@@ -165,11 +169,108 @@ STATIC void load_bytecode_qstrs(mp_reader_t *reader, byte *ip, byte *ip_top) {
     }
 }
 
+#if MICROPY_PERSISTENT_CODE_XIP
+
+// Reader over a .mpy file in memory-mapped storage.  While in_place is set
+// the bytecode of each function is executed where it lies.
+typedef struct _mp_reader_xip_t {
+    const byte *cur;
+    const byte *end;
+    void *owner; // heap object that keeps the storage alive, or NULL
+    bool in_place;
+} mp_reader_xip_t;
+
+STATIC mp_uint_t mp_reader_xip_readbyte(void *data) {
+    mp_reader_xip_t *xip = (mp_reader_xip_t*)data;
+    if (xip->cur < xip->end) {
+        return *xip->cur++;
+    } else {
+        return MP_READER_EOF;
+    }
+}
+
+STATIC void mp_reader_xip_close(void *data) {
+    (void)data;
+}
+
+// The qstr args in bytecode saved by mp_raw_code_save are indices into a
+// table of the distinct qstrs of the function, with simple_name and
+// source_file at index 0 and 1, so the bytecode can run unmodified if the VM
+// looks its qstrs up in that table.  Build the table from the qstrs that
+// follow the bytecode.  Returns NULL, having read nothing, if the bytecode
+// doesn't carry such indices (it was saved by an older version).
+// If the file has an owner the table is followed by a pointer to it, so that
+// the storage lives as long as any function that runs from it.
+STATIC uint16_t *load_qstr_table(mp_reader_t *reader, void *owner, const byte *ip, const byte *ip2, const byte *ip_top) {
+    if ((ip2[0] | ip2[1] << 8) != 0 || (ip2[2] | ip2[3] << 8) != 1) {
+        return NULL;
+    }
+    size_t n_qstr_args = 0;
+    size_t n_table = 2;
+    for (const byte *p = ip; p < ip_top;) {
+        size_t sz;
+        if (mp_opcode_format(p, &sz) == MP_OPCODE_QSTR) {
+            size_t idx = p[1] | (p[2] << 8);
+            n_qstr_args += 1;
+            if (idx >= n_table) {
+                n_table = idx + 1;
+            }
+        }
+        p += sz;
+    }
+    if (n_table > n_qstr_args + 2) {
+        return NULL;
+    }
+
+    uint16_t *table;
+    if (owner == NULL) {
+        table = m_new(uint16_t, n_table);
+    } else {
+        size_t table_size = (n_table * sizeof(uint16_t) + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+        table = m_new(uint16_t, (table_size + sizeof(void*)) / sizeof(uint16_t));
+        *(void**)((byte*)table + table_size) = owner;
+    }
+    table[0] = load_qstr(reader); // simple_name
+    table[1] = load_qstr(reader); // source_file
+    size_t n = 2;
+    while (ip < ip_top) {
+        size_t sz;
+        if (mp_opcode_format(ip, &sz) == MP_OPCODE_QSTR) {
+            qstr qst = load_qstr(reader);
+            size_t idx = ip[1] | (ip[2] << 8);
+            if (idx == n) {
+                table[n++] = qst;
+            } else if (idx > n || table[idx] != qst) {
+                mp_raise_ValueError(translate("Incompatible .mpy file. Please update all .mpy files. See http://adafru.it/mpy-update for more info."));
+            }
+        }
+        ip += sz;
+    }
+    return table;
+}
+
+#endif // MICROPY_PERSISTENT_CODE_XIP
+
 STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     // load bytecode
     size_t bc_len = read_uint(reader);
-    byte *bytecode = m_new(byte, bc_len);
-    read_bytes(reader, bytecode, bc_len);
+    byte *bytecode;
+    #if MICROPY_PERSISTENT_CODE_XIP
+    mp_reader_xip_t *xip = NULL;
+    if (reader->readbyte == mp_reader_xip_readbyte) {
+        xip = (mp_reader_xip_t*)reader->data;
+    }
+    uint16_t *qstr_table = NULL;
+    bool in_place = xip != NULL && xip->in_place && bc_len <= (size_t)(xip->end - xip->cur);
+    if (in_place) {
+        bytecode = (byte*)xip->cur;
+        xip->cur += bc_len;
+    } else
+    #endif
+    {
+        bytecode = m_new(byte, bc_len);
+        read_bytes(reader, bytecode, bc_len);
+    }
 
     // extract prelude
     const byte *ip = bytecode;
@@ -177,12 +278,30 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
     bytecode_prelude_t prelude;
     extract_prelude(&ip, &ip2, &prelude);
 
-    // load qstrs and link global qstr ids into bytecode
-    qstr simple_name = load_qstr(reader);
-    qstr source_file = load_qstr(reader);
-    ((byte*)ip2)[0] = simple_name; ((byte*)ip2)[1] = simple_name >> 8;
-    ((byte*)ip2)[2] = source_file; ((byte*)ip2)[3] = source_file >> 8;
-    load_bytecode_qstrs(reader, (byte*)ip, bytecode + bc_len);
+    #if MICROPY_PERSISTENT_CODE_XIP
+    if (in_place) {
+        qstr_table = load_qstr_table(reader, xip->owner, ip, ip2, bytecode + bc_len);
+        if (qstr_table == NULL) {
+            // Saved without qstr indices, so copy the bytecode of this and all
+            // following functions to the heap and link qstr ids into it.
+            xip->in_place = false;
+            byte *copy = m_new(byte, bc_len);
+            memcpy(copy, bytecode, bc_len);
+            ip = copy + (ip - bytecode);
+            ip2 = copy + (ip2 - bytecode);
+            bytecode = copy;
+        }
+    }
+    if (qstr_table == NULL)
+    #endif
+    {
+        // load qstrs and link global qstr ids into bytecode
+        qstr simple_name = load_qstr(reader);
+        qstr source_file = load_qstr(reader);
+        ((byte*)ip2)[0] = simple_name; ((byte*)ip2)[1] = simple_name >> 8;
+        ((byte*)ip2)[2] = source_file; ((byte*)ip2)[3] = source_file >> 8;
+        load_bytecode_qstrs(reader, (byte*)ip, bytecode + bc_len);
+    }
 
     // load constant table
     size_t n_obj = read_uint(reader);
@@ -210,12 +329,18 @@ STATIC mp_raw_code_t *load_raw_code(mp_reader_t *reader) {
         n_obj, n_raw_code,
         #endif
         prelude.scope_flags);
+    #if MICROPY_PERSISTENT_CODE_XIP
+    rc->data.u_byte.qstr_table = qstr_table;
+    #endif
     return rc;
 }
 
 mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader) {
+    // a short header is reported as incompatible rather than truncated
     byte header[4];
-    read_bytes(reader, header, sizeof(header));
+    for (size_t i = 0; i < sizeof(header); ++i) {
+        header[i] = reader->readbyte(reader->data);
+    }
     if (header[0] != 'M'
         || header[1] != MPY_VERSION
         || header[2] != MPY_FEATURE_FLAGS
@@ -233,7 +358,23 @@ mp_raw_code_t *mp_raw_code_load_mem(const byte *buf, size_t len) {
     return mp_raw_code_load(&reader);
 }
 
+#if MICROPY_PERSISTENT_CODE_XIP
+mp_raw_code_t *mp_raw_code_load_xip(const byte *buf, size_t len, void *owner) {
+    mp_reader_xip_t xip = { buf, buf + len, owner, true };
+    mp_reader_t reader = { &xip, mp_reader_xip_readbyte, mp_reader_xip_close };
+    return mp_raw_code_load(&reader);
+}
+#endif
+
 mp_raw_code_t *mp_raw_code_load_file(const char *filename) {
+    #if MICROPY_PERSISTENT_CODE_XIP
+    size_t len;
+    void *owner;
+    const byte *buf = mp_raw_code_map_file(filename, &len, &owner);
+    if (buf != NULL) {
+        return mp_raw_code_load_xip(buf, len, owner);
+    }
+    #endif
     mp_reader_t reader;
     mp_reader_new_file(&reader, filename);
     return mp_raw_code_load(&reader);
@@ -309,37 +450,92 @@ STATIC void save_obj(mp_print_t *print, mp_obj_t o) {
     }
 }
 
-STATIC void save_bytecode_qstrs(mp_print_t *print, const byte *ip, const byte *ip_top) {
+STATIC qstr bytecode_qstr(const mp_raw_code_t *rc, const byte *p) {
+    qstr qst = p[0] | (p[1] << 8);
+    #if MICROPY_PERSISTENT_CODE_XIP
+    if (rc->data.u_byte.qstr_table != NULL) {
+        qst = rc->data.u_byte.qstr_table[qst];
+    }
+    #endif
+    return qst;
+}
+
+STATIC void save_bytecode_qstrs(mp_print_t *print, const mp_raw_code_t *rc, const byte *ip, const byte *ip_top) {
     while (ip < ip_top) {
         size_t sz;
         uint f = mp_opcode_format(ip, &sz);
         if (f == MP_OPCODE_QSTR) {
-            qstr qst = ip[1] | (ip[2] << 8);
-            save_qstr(print, qst);
+            save_qstr(print, bytecode_qstr(rc, ip + 1));
         }
         ip += sz;
     }
 }
 
+// Save the bytecode with each qstr arg replaced by its index in a table of
+// the distinct qstrs of the function, simple_name and source_file being at
+// index 0 and 1.  Loaders that copy the bytecode overwrite these with qstr
+// ids anyway, but it lets MICROPY_PERSISTENT_CODE_XIP run it in place.
+STATIC void save_bytecode(mp_print_t *print, const mp_raw_code_t *rc, const byte *ip, const byte *ip2) {
+    const byte *bytecode = rc->data.u_byte.bytecode;
+    const byte *ip_top = bytecode + rc->data.u_byte.bc_len;
+
+    size_t n_alloc = 2;
+    for (const byte *p = ip; p < ip_top;) {
+        size_t sz;
+        if (mp_opcode_format(p, &sz) == MP_OPCODE_QSTR) {
+            n_alloc += 1;
+        }
+        p += sz;
+    }
+    qstr *table = m_new(qstr, n_alloc);
+    size_t n_table = 2;
+
+    byte idx[4] = {0, 0, 1, 0};
+    mp_print_bytes(print, bytecode, ip2 - bytecode);
+    mp_print_bytes(print, idx, 4);
+    const byte *run = ip2 + 4;
+    while (ip < ip_top) {
+        size_t sz;
+        if (mp_opcode_format(ip, &sz) == MP_OPCODE_QSTR) {
+            qstr qst = bytecode_qstr(rc, ip + 1);
+            size_t i = 2;
+            while (i < n_table && table[i] != qst) {
+                ++i;
+            }
+            if (i == n_table) {
+                table[n_table++] = qst;
+            }
+            mp_print_bytes(print, run, ip + 1 - run);
+            idx[0] = i;
+            idx[1] = i >> 8;
+            mp_print_bytes(print, idx, 2);
+            run = ip + 3;
+        }
+        ip += sz;
+    }
+    mp_print_bytes(print, run, ip_top - run);
+    m_del(qstr, table, n_alloc);
+}
+
 STATIC void save_raw_code(mp_print_t *print, mp_raw_code_t *rc) {
     if (rc->kind != MP_CODE_BYTECODE) {
         mp_raise_ValueError(translate("can only save bytecode"));
     }
 
-    // save bytecode
-    mp_print_uint(print, rc->data.u_byte.bc_len);
-    mp_print_bytes(print, rc->data.u_byte.bytecode, rc->data.u_byte.bc_len);
-
     // extract prelude
     const byte *ip = rc->data.u_byte.bytecode;
     const byte *ip2;
     bytecode_prelude_t prelude;
     extract_prelude(&ip, &ip2, &prelude);
 
+    // save bytecode
+    mp_print_uint(print, rc->data.u_byte.bc_len);
+    save_bytecode(print, rc, ip, ip2);
+
     // save qstrs
-    save_qstr(print, ip2[0] | (ip2[1] << 8)); // simple_name
-    save_qstr(print, ip2[2] | (ip2[3] << 8)); // source_file
-    save_bytecode_qstrs(print, ip, rc->data.u_byte.bytecode + rc->data.u_byte.bc_len);
+    save_qstr(print, bytecode_qstr(rc, ip2)); // simple_name
+    save_qstr(print, bytecode_qstr(rc, ip2 + 2)); // source_file
+    save_bytecode_qstrs(print, rc, ip, rc->data.u_byte.bytecode + rc->data.u_byte.bc_len);
 
     // save constant table
     mp_print_uint(print, rc->data.u_byte.n_obj);
@@ -397,6 +593,19 @@ void mp_raw_code_save_file(mp_raw_code_t *rc, const char *filename) {
     close(fd);
 }
 
+#elif MICROPY_VFS
+
+#include "py/stream.h"
+#include "extmod/vfs.h"
+
+void mp_raw_code_save_file(mp_raw_code_t *rc, const char *filename) {
+    mp_obj_t args[2] = {mp_obj_new_str(filename, strlen(filename)), MP_OBJ_NEW_QSTR(MP_QSTR_wb)};
+    mp_obj_t file = mp_vfs_open(MP_ARRAY_SIZE(args), args, (mp_map_t*)&mp_const_empty_map);
+    mp_print_t print = {MP_OBJ_TO_PTR(file), mp_stream_write_adaptor};
+    mp_raw_code_save(rc, &print);
+    mp_stream_close(file);
+}
+
 #else
 #error mp_raw_code_save_file not implemented for this platform
 #endif
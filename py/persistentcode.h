@@ -34,6 +34,19 @@ mp_raw_code_t *mp_raw_code_load(mp_reader_t *reader);
 mp_raw_code_t *mp_raw_code_load_mem(const byte *buf, size_t len);
 mp_raw_code_t *mp_raw_code_load_file(const char *filename);
 
+#if MICROPY_PERSISTENT_CODE_XIP
+// Load a .mpy file at buf, executing its bytecode from there.  If owner is
+// not NULL it is a GC heap object which the functions loaded from buf keep
+// alive, so that the port can release buf from the owner's finaliser.
+// Otherwise buf must stay put for the life of the program.
+mp_raw_code_t *mp_raw_code_load_xip(const byte *buf, size_t len, void *owner);
+
+// Provided by the port: if the named file can be executed in place, return
+// its contents and set *len and *owner as for mp_raw_code_load_xip, else
+// return NULL.
+const byte *mp_raw_code_map_file(const char *filename, size_t *len, void **owner);
+#endif
+
 void mp_raw_code_save(mp_raw_code_t *rc, mp_print_t *print);
 void mp_raw_code_save_file(mp_raw_code_t *rc, const char *filename);
 
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013, 2014 Damien P. George
+ * Copyright (c) 2014 Paul Sokolovsky
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/profile.h"
+
+#if MICROPY_PY_MICROPYTHON_PROFILE
+
+void mp_prof_start(size_t n_samples) {
+    mp_prof_t *prof = m_new_obj_var(mp_prof_t, mp_prof_sample_t, n_samples);
+    memset(prof, 0, sizeof(mp_prof_t) + n_samples * sizeof(mp_prof_sample_t));
+    prof->alloc = n_samples;
+    #if MICROPY_PY_MICROPYTHON_PROFILE_SAMPLE_PERIOD
+    prof->countdown = MICROPY_PY_MICROPYTHON_PROFILE_SAMPLE_PERIOD;
+    #endif
+    MP_STATE_VM(prof) = prof;
+    MP_STATE_VM(prof_tick) = false;
+    MP_STATE_VM(prof_active) = true;
+}
+
+void mp_prof_stop(void) {
+    MP_STATE_VM(prof_active) = false;
+}
+
+// Add one hit for the line at ip to the open-addressed sample table.
+STATIC void prof_record(mp_prof_t *prof, const mp_obj_fun_bc_t *fun, const byte *ip) {
+    qstr block_name, source_file;
+    size_t line = mp_bytecode_get_source_line(fun, ip, &block_name, &source_file);
+    size_t i = ((source_file * 31) + block_name) * 31 + line;
+    for (size_t n = prof->alloc; n > 0; n--) {
+        i %= prof->alloc;
+        mp_prof_sample_t *s = &prof->samples[i++];
+        if (s->count == 0) {
+            s->source_file = source_file;
+            s->block_name = block_name;
+            s->line = line;
+            s->count = 1;
+            return;
+        }
+        if (s->line == line && s->block_name == block_name && s->source_file == source_file) {
+            s->count += 1;
+            return;
+        }
+    }
+    prof->dropped += 1;
+}
+
+// Called by the VM before it executes the opcode at ip.
+void mp_prof_opcode(const mp_code_state_t *code_state, const byte *ip) {
+    mp_prof_t *prof = MP_STATE_VM(prof);
+    prof->opcode_count[*ip] += 1;
+    #if MICROPY_PY_MICROPYTHON_PROFILE_SAMPLE_PERIOD
+    if (--prof->countdown == 0) {
+        prof->countdown = MICROPY_PY_MICROPYTHON_PROFILE_SAMPLE_PERIOD;
+        MP_STATE_VM(prof_tick) = true;
+    }
+    #endif
+    if (MP_STATE_VM(prof_tick)) {
+        MP_STATE_VM(prof_tick) = false;
+        prof_record(prof, code_state->fun_bc, ip);
+    }
+}
+
+#endif // MICROPY_PY_MICROPYTHON_PROFILE
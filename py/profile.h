@@ -0,0 +1,63 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013, 2014 Damien P. George
+ * Copyright (c) 2014 Paul Sokolovsky
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MICROPY_INCLUDED_PY_PROFILE_H
+#define MICROPY_INCLUDED_PY_PROFILE_H
+
+#include "py/mpstate.h"
+#include "py/bc.h"
+
+#if MICROPY_PY_MICROPYTHON_PROFILE
+
+typedef struct _mp_prof_sample_t {
+    qstr source_file;
+    qstr block_name;
+    uint32_t line;
+    uint32_t count; // 0 if this slot is unused
+} mp_prof_sample_t;
+
+typedef struct _mp_prof_t {
+    uint32_t opcode_count[256];
+    uint32_t dropped; // samples lost because the table was full
+    #if MICROPY_PY_MICROPYTHON_PROFILE_SAMPLE_PERIOD
+    uint32_t countdown;
+    #endif
+    size_t alloc;
+    mp_prof_sample_t samples[];
+} mp_prof_t;
+
+void mp_prof_start(size_t n_samples);
+void mp_prof_stop(void);
+void mp_prof_opcode(const mp_code_state_t *code_state, const byte *ip);
+
+// Ask the VM to sample the line it is running at the next opcode.  This is
+// safe to call from an interrupt.
+#define mp_prof_tick() (MP_STATE_VM(prof_tick) = true)
+
+#endif // MICROPY_PY_MICROPYTHON_PROFILE
+
+#endif // MICROPY_INCLUDED_PY_PROFILE_H
@@ -217,6 +217,7 @@ PY_CORE_O_BASENAME = $(addprefix py/,\
 	modthread.o \
 	vm.o \
 	bc.o \
+	profile.o \
 	showbc.o \
 	repl.o \
 	smallint.o \
@@ -229,7 +230,10 @@ PY_EXTMOD_O_BASENAME = \
 	extmod/modure.o \
 	extmod/moduzlib.o \
 	extmod/moduheapq.o \
+	extmod/moduarrayops.o \
+	extmod/modummap.o \
 	extmod/modutimeq.o \
+	extmod/moduevloop.o \
 	extmod/moduhashlib.o \
 	extmod/modubinascii.o \
 	extmod/virtpin.o \
@@ -125,6 +125,10 @@ void mp_init(void) {
     MP_STATE_VM(dupterm_arr_obj) = MP_OBJ_NULL;
     #endif
 
+    #if MICROPY_PY_URE && MICROPY_PY_URE_CACHE_SIZE
+    memset(MP_STATE_VM(ure_cache), 0, sizeof(MP_STATE_VM(ure_cache)));
+    #endif
+
     #ifdef MICROPY_FSUSERMOUNT
     // zero out the pointers to the user-mounted devices
     memset(MP_STATE_VM(fs_user_mount) + MICROPY_FATFS_NUM_PERSISTENT, 0,
@@ -154,6 +158,20 @@ void mp_init(void) {
     MP_STATE_VM(vfs_cur) = NULL;
     MP_STATE_VM(vfs_mount_table) = NULL;
     #endif
+    #if MICROPY_VFS_IMPORT_CACHE
+    MP_STATE_VM(vfs_import_cache) = NULL;
+    #endif
+    #endif
+
+    #if MICROPY_GC_ALLOC_SITES
+    MP_STATE_THREAD(current_code_state) = NULL;
+    MP_STATE_THREAD(gc_alloc_caller) = NULL;
+    #endif
+
+    #if MICROPY_PY_MICROPYTHON_PROFILE
+    MP_STATE_VM(prof) = NULL;
+    MP_STATE_VM(prof_active) = false;
+    MP_STATE_VM(prof_tick) = false;
     #endif
 
     #if MICROPY_PY_THREAD_GIL
@@ -41,6 +41,7 @@
 #define MP_STREAM_SET_OPTS      (7)  // Set stream options
 #define MP_STREAM_GET_DATA_OPTS (8)  // Get data/message options
 #define MP_STREAM_SET_DATA_OPTS (9)  // Set data/message options
+#define MP_STREAM_MMAP          (10) // Get the address of the stream's data in memory
 
 // These poll ioctl values are compatible with Linux
 #define MP_STREAM_POLL_RD  (0x0001)
@@ -57,6 +58,15 @@ struct mp_stream_seek_t {
     int whence;
 };
 
+// Argument structure for MP_STREAM_MMAP.  The region must stay valid for as
+// long as the underlying storage does, even after the stream is closed.
+struct mp_stream_mmap_t {
+    mp_off_t offset; // in: start of the region
+    size_t len; // in: length of the region, 0 for the rest of the stream; out: length
+    bool write; // in: whether the region will be written to
+    void *addr; // out: address of the region
+};
+
 // seek ioctl "whence" values
 #define MP_SEEK_SET (0)
 #define MP_SEEK_CUR (1)
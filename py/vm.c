@@ -34,6 +34,7 @@
 #include "py/runtime.h"
 #include "py/bc0.h"
 #include "py/bc.h"
+#include "py/profile.h"
 
 #if 0
 #define TRACE(ip) printf("sp=%d ", (int)(sp - &code_state->state[0] + 1)); mp_bytecode_print2(ip, 1, code_state->fun_bc->const_table);
@@ -58,9 +59,26 @@
 
 #if MICROPY_PERSISTENT_CODE
 
+#if MICROPY_PERSISTENT_CODE_XIP
+// Bytecode executed in place holds indices into the function's qstr table,
+// and must not be written to, so map lookups are not cached in it.
 #define DECODE_QSTR \
     qstr qst = ip[0] | ip[1] << 8; \
+    if (code_state->fun_bc->qstr_table != NULL) { \
+        qst = code_state->fun_bc->qstr_table[qst]; \
+    } \
     ip += 2;
+#define CACHE_MAP_INDEX(idx) do { \
+    if (code_state->fun_bc->qstr_table == NULL) { \
+        *(byte*)ip = (idx); \
+    } \
+} while (0)
+#else
+#define DECODE_QSTR \
+    qstr qst = ip[0] | ip[1] << 8; \
+    ip += 2;
+#define CACHE_MAP_INDEX(idx) *(byte*)ip = (idx)
+#endif
 #define DECODE_PTR \
     DECODE_UINT; \
     void *ptr = (void*)(uintptr_t)code_state->fun_bc->const_table[unum]
@@ -90,6 +108,12 @@
 #define TOP() (*sp)
 #define SET_TOP(val) *sp = (val)
 
+#if MICROPY_PY_MICROPYTHON_PROFILE
+#define PROFILE_OPCODE() if (MP_STATE_VM(prof_active)) { mp_prof_opcode(code_state, ip); }
+#else
+#define PROFILE_OPCODE()
+#endif
+
 #if MICROPY_PY_SYS_EXC_INFO
 #define CLEAR_SYS_EXC_INFO() MP_STATE_VM(cur_exception) = NULL;
 #else
@@ -130,6 +154,7 @@ mp_vm_return_kind_t mp_execute_bytecode(mp_code_state_t *code_state, volatile mp
     #define DISPATCH() do { \
         TRACE(ip); \
         MARK_EXC_IP_GLOBAL(); \
+        PROFILE_OPCODE(); \
         goto *entry_table[*ip++]; \
     } while (0)
     #define DISPATCH_WITH_PEND_EXC_CHECK() goto pending_exception_check
@@ -148,9 +173,18 @@ mp_vm_return_kind_t mp_execute_bytecode(mp_code_state_t *code_state, volatile mp
     // loop and the exception handler, leading to very obscure bugs.
     #define RAISE(o) do { nlr_pop(); nlr.ret_val = MP_OBJ_TO_PTR(o); goto exception_handler; } while (0)
 
+    #if MICROPY_GC_ALLOC_SITES
+    // Let the GC tag allocations with the line that is running.
+    mp_code_state_t *prev_code_state = MP_STATE_THREAD(current_code_state);
+    #define SET_CURRENT_CODE_STATE(cs) MP_STATE_THREAD(current_code_state) = (cs)
+    #else
+    #define SET_CURRENT_CODE_STATE(cs)
+    #endif
+
 #if MICROPY_STACKLESS
 run_code_state: ;
 #endif
+    SET_CURRENT_CODE_STATE(code_state);
     // Pointers which are constant for particular invocation of mp_execute_bytecode()
     mp_obj_t * /*const*/ fastn;
     mp_exc_stack_t * /*const*/ exc_stack;
@@ -201,6 +235,7 @@ dispatch_loop:
 #else
                 TRACE(ip);
                 MARK_EXC_IP_GLOBAL();
+                PROFILE_OPCODE();
                 switch (*ip++) {
 #endif
 
@@ -284,7 +319,7 @@ dispatch_loop:
                     } else {
                         mp_map_elem_t *elem = mp_map_lookup(&mp_locals_get()->map, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP);
                         if (elem != NULL) {
-                            *(byte*)ip = (elem - &mp_locals_get()->map.table[0]) & 0xff;
+                            CACHE_MAP_INDEX((elem - &mp_locals_get()->map.table[0]) & 0xff);
                             PUSH(elem->value);
                         } else {
                             PUSH(mp_load_name(MP_OBJ_QSTR_VALUE(key)));
@@ -313,7 +348,7 @@ dispatch_loop:
                     } else {
                         mp_map_elem_t *elem = mp_map_lookup(&mp_globals_get()->map, MP_OBJ_NEW_QSTR(qst), MP_MAP_LOOKUP);
                         if (elem != NULL) {
-                            *(byte*)ip = (elem - &mp_globals_get()->map.table[0]) & 0xff;
+                            CACHE_MAP_INDEX((elem - &mp_globals_get()->map.table[0]) & 0xff);
                             PUSH(elem->value);
                         } else {
                             PUSH(mp_load_global(MP_OBJ_QSTR_VALUE(key)));
@@ -346,7 +381,7 @@ dispatch_loop:
                         } else {
                             elem = mp_map_lookup(&self->members, key, MP_MAP_LOOKUP);
                             if (elem != NULL) {
-                                *(byte*)ip = elem - &self->members.table[0];
+                                CACHE_MAP_INDEX(elem - &self->members.table[0]);
                             } else {
                                 goto load_attr_cache_fail;
                             }
@@ -444,7 +479,7 @@ dispatch_loop:
                         } else {
                             elem = mp_map_lookup(&self->members, key, MP_MAP_LOOKUP);
                             if (elem != NULL) {
-                                *(byte*)ip = elem - &self->members.table[0];
+                                CACHE_MAP_INDEX(elem - &self->members.table[0]);
                             } else {
                                 goto store_attr_cache_fail;
                             }
@@ -1118,6 +1153,7 @@ unwind_return:
                         goto run_code_state;
                     }
                     #endif
+                    SET_CURRENT_CODE_STATE(prev_code_state);
                     return MP_VM_RETURN_NORMAL;
 
                 ENTRY(MP_BC_RAISE_VARARGS): {
@@ -1155,6 +1191,7 @@ yield:
                     code_state->ip = ip;
                     code_state->sp = sp;
                     code_state->exc_sp = MP_TAGPTR_MAKE(exc_sp, currently_in_except_block);
+                    SET_CURRENT_CODE_STATE(prev_code_state);
                     return MP_VM_RETURN_YIELD;
 
                 ENTRY(MP_BC_YIELD_FROM): {
@@ -1284,6 +1321,7 @@ yield:
                     mp_obj_t obj = mp_obj_new_exception_msg(&mp_type_NotImplementedError, translate("byte code not implemented"));
                     nlr_pop();
                     fastn[0] = obj;
+                    SET_CURRENT_CODE_STATE(prev_code_state);
                     return MP_VM_RETURN_EXCEPTION;
                 }
 
@@ -1381,50 +1419,8 @@ unwind_loop:
             // TODO: don't set traceback for exceptions re-raised by END_FINALLY.
             // But consider how to handle nested exceptions.
             if (nlr.ret_val != &mp_const_GeneratorExit_obj) {
-                const byte *ip = code_state->fun_bc->bytecode;
-                ip = mp_decode_uint_skip(ip); // skip n_state
-                ip = mp_decode_uint_skip(ip); // skip n_exc_stack
-                ip++; // skip scope_params
-                ip++; // skip n_pos_args
-                ip++; // skip n_kwonly_args
-                ip++; // skip n_def_pos_args
-                size_t bc = code_state->ip - ip;
-                size_t code_info_size = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip); // skip code_info_size
-                bc -= code_info_size;
-                #if MICROPY_PERSISTENT_CODE
-                qstr block_name = ip[0] | (ip[1] << 8);
-                qstr source_file = ip[2] | (ip[3] << 8);
-                ip += 4;
-                #else
-                qstr block_name = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip);
-                qstr source_file = mp_decode_uint_value(ip);
-                ip = mp_decode_uint_skip(ip);
-                #endif
-                size_t source_line = 1;
-                size_t c;
-                while ((c = *ip)) {
-                    size_t b, l;
-                    if ((c & 0x80) == 0) {
-                        // 0b0LLBBBBB encoding
-                        b = c & 0x1f;
-                        l = c >> 5;
-                        ip += 1;
-                    } else {
-                        // 0b1LLLBBBB 0bLLLLLLLL encoding (l's LSB in second byte)
-                        b = c & 0xf;
-                        l = ((c << 4) & 0x700) | ip[1];
-                        ip += 2;
-                    }
-                    if (bc >= b) {
-                        bc -= b;
-                        source_line += l;
-                    } else {
-                        // found source line corresponding to bytecode offset
-                        break;
-                    }
-                }
+                qstr block_name, source_file;
+                size_t source_line = mp_bytecode_get_source_line(code_state->fun_bc, code_state->ip, &block_name, &source_file);
                 mp_obj_exception_add_traceback(MP_OBJ_FROM_PTR(nlr.ret_val), source_file, source_line, block_name);
             }
 
@@ -1478,6 +1474,7 @@ unwind_loop:
                 // propagate exception to higher level
                 // TODO what to do about ip and sp? they don't really make sense at this point
                 fastn[0] = MP_OBJ_FROM_PTR(nlr.ret_val); // must put exception here because sp is invalid
+                SET_CURRENT_CODE_STATE(prev_code_state);
                 return MP_VM_RETURN_EXCEPTION;
             }
         }
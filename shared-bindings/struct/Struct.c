@@ -0,0 +1,226 @@
+
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2013, 2014 Damien P. George
+ * Copyright (c) 2014 Paul Sokolovsky
+ * Copyright (c) 2017 Michael McWethy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+
+#include "py/objproperty.h"
+#include "py/objtuple.h"
+#include "py/runtime.h"
+#include "shared-bindings/struct/Struct.h"
+#include "supervisor/shared/translate.h"
+
+#if MICROPY_CPYTHON_COMPAT
+
+//| .. currentmodule:: struct
+//|
+//| :class:`Struct` -- a precompiled format
+//| ========================================
+//|
+//| A format string that has been parsed once, so that packing and unpacking
+//| many records of the same format doesn't parse it again for each one.
+//|
+//| .. class:: Struct(fmt)
+//|
+//|   Create a Struct for the format string fmt.
+//|
+STATIC mp_obj_t struct_struct_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    return MP_OBJ_FROM_PTR(shared_modules_struct_struct_compile(args[0]));
+}
+
+// Return the address of the record at offset in a buffer, checking that the
+// record fits.  A negative offset is relative to the end of the buffer.
+STATIC byte *struct_struct_get_record(struct_struct_obj_t *self, const mp_buffer_info_t *bufinfo, mp_int_t offset) {
+    if (offset < 0) {
+        offset += bufinfo->len;
+    }
+    if (offset < 0 || (size_t)offset > bufinfo->len || bufinfo->len - offset < self->size) {
+        mp_raise_RuntimeError(translate("buffer too small"));
+    }
+    return (byte*)bufinfo->buf + offset;
+}
+
+//|   .. method:: pack(v1, v2, ...)
+//|
+//|     Pack the values v1, v2, ... and return the bytes object encoding them.
+//|     There must be exactly one value for each field of the format.
+//|
+STATIC mp_obj_t struct_struct_pack(size_t n_args, const mp_obj_t *args) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    vstr_t vstr;
+    vstr_init_len(&vstr, self->size);
+    memset(vstr.buf, 0, self->size);
+    shared_modules_struct_struct_pack_record(self, (byte*)vstr.buf, n_args - 1, args + 1);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_pack_obj, 1, MP_OBJ_FUN_ARGS_MAX, struct_struct_pack);
+
+//|   .. method:: pack_into(buffer, offset, v1, v2, ...)
+//|
+//|     Pack the values v1, v2, ... into buffer starting at offset. offset may
+//|     be negative to count from the end of buffer.
+//|
+STATIC mp_obj_t struct_struct_pack_into(size_t n_args, const mp_obj_t *args) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    byte *p = struct_struct_get_record(self, &bufinfo, mp_obj_get_int(args[2]));
+    shared_modules_struct_struct_pack_record(self, p, n_args - 3, args + 3);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_pack_into_obj, 3, MP_OBJ_FUN_ARGS_MAX, struct_struct_pack_into);
+
+//|   .. method:: pack_many_into(buffer, offset, records, stride=size)
+//|
+//|     Pack each sequence of values in records into buffer, the first at
+//|     offset and each following one stride bytes after the one before.
+//|     Return the number of records packed.
+//|
+STATIC mp_obj_t struct_struct_pack_many_into(size_t n_args, const mp_obj_t *args) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_WRITE);
+    mp_int_t offset = mp_obj_get_int(args[2]);
+    mp_int_t stride = n_args > 4 ? mp_obj_get_int(args[4]) : (mp_int_t)self->size;
+    if (stride <= 0) {
+        mp_raise_RuntimeError(translate("stride must be > 0"));
+    }
+    mp_obj_iter_buf_t iter_buf;
+    mp_obj_t iterable = mp_getiter(args[3], &iter_buf);
+    mp_obj_t record;
+    size_t n = 0;
+    while ((record = mp_iternext(iterable)) != MP_OBJ_STOP_ITERATION) {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(record, &len, &items);
+        shared_modules_struct_struct_pack_record(self, struct_struct_get_record(self, &bufinfo, offset), len, items);
+        offset += stride;
+        n += 1;
+    }
+    return MP_OBJ_NEW_SMALL_INT(n);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_pack_many_into_obj, 4, 5, struct_struct_pack_many_into);
+
+//|   .. method:: unpack(data)
+//|
+//|   .. method:: unpack_from(data, offset=0)
+//|
+//|     Unpack a record from data starting at offset. offset may be negative to
+//|     count from the end of data. The return value is a tuple of the unpacked
+//|     values.
+//|
+STATIC mp_obj_t struct_struct_unpack_from(size_t n_args, const mp_obj_t *args) {
+    // as for the module function, unpack only needs the buffer to be big enough
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+    mp_int_t offset = n_args > 2 ? mp_obj_get_int(args[2]) : 0;
+    return shared_modules_struct_struct_unpack_record(self, struct_struct_get_record(self, &bufinfo, offset));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_unpack_from_obj, 2, 3, struct_struct_unpack_from);
+
+mp_obj_t struct_struct_iter_unpack_helper(struct_struct_obj_t *self, size_t n_args, const mp_obj_t *args) {
+    // check that the object has a buffer
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    mp_int_t offset = n_args > 1 ? mp_obj_get_int(args[1]) : 0;
+    mp_int_t stride = n_args > 2 ? mp_obj_get_int(args[2]) : (mp_int_t)self->size;
+    if (offset < 0) {
+        mp_raise_RuntimeError(translate("offset must be >= 0"));
+    }
+    if (stride <= 0) {
+        mp_raise_RuntimeError(translate("stride must be > 0"));
+    }
+    return shared_modules_struct_struct_iter_unpack(self, args[0], offset, stride);
+}
+
+//|   .. method:: iter_unpack(data, offset=0, stride=size)
+//|
+//|     Return an iterator that unpacks one record at a time from data, the
+//|     first at offset and each following one stride bytes after the one
+//|     before, until there is no complete record left.
+//|
+STATIC mp_obj_t struct_struct_iter_unpack(size_t n_args, const mp_obj_t *args) {
+    return struct_struct_iter_unpack_helper(MP_OBJ_TO_PTR(args[0]), n_args - 1, args + 1);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_struct_iter_unpack_obj, 2, 4, struct_struct_iter_unpack);
+
+//|   .. attribute:: format
+//|
+//|     The format string the Struct was created with.
+//|
+STATIC mp_obj_t struct_struct_obj_get_format(mp_obj_t self_in) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return self->format;
+}
+MP_DEFINE_CONST_FUN_OBJ_1(struct_struct_get_format_obj, struct_struct_obj_get_format);
+
+const mp_obj_property_t struct_struct_format_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&struct_struct_get_format_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+//|   .. attribute:: size
+//|
+//|     The number of bytes in a record.
+//|
+STATIC mp_obj_t struct_struct_obj_get_size(mp_obj_t self_in) {
+    struct_struct_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return MP_OBJ_NEW_SMALL_INT(self->size);
+}
+MP_DEFINE_CONST_FUN_OBJ_1(struct_struct_get_size_obj, struct_struct_obj_get_size);
+
+const mp_obj_property_t struct_struct_size_obj = {
+    .base.type = &mp_type_property,
+    .proxy = {(mp_obj_t)&struct_struct_get_size_obj,
+              (mp_obj_t)&mp_const_none_obj,
+              (mp_obj_t)&mp_const_none_obj},
+};
+
+STATIC const mp_rom_map_elem_t struct_struct_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_pack), MP_ROM_PTR(&struct_struct_pack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pack_into), MP_ROM_PTR(&struct_struct_pack_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pack_many_into), MP_ROM_PTR(&struct_struct_pack_many_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack), MP_ROM_PTR(&struct_struct_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unpack_from), MP_ROM_PTR(&struct_struct_unpack_from_obj) },
+    { MP_ROM_QSTR(MP_QSTR_iter_unpack), MP_ROM_PTR(&struct_struct_iter_unpack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_format), MP_ROM_PTR(&struct_struct_format_obj) },
+    { MP_ROM_QSTR(MP_QSTR_size), MP_ROM_PTR(&struct_struct_size_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(struct_struct_locals_dict, struct_struct_locals_dict_table);
+
+const mp_obj_type_t struct_struct_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Struct,
+    .make_new = struct_struct_make_new,
+    .locals_dict = (mp_obj_dict_t*)&struct_struct_locals_dict,
+};
+
+#endif // MICROPY_CPYTHON_COMPAT
@@ -35,6 +35,7 @@
 #include "py/binary.h"
 #include "py/parsenum.h"
 #include "shared-bindings/struct/__init__.h"
+#include "shared-bindings/struct/Struct.h"
 #include "shared-module/struct/__init__.h"
 #include "supervisor/shared/translate.h"
 
@@ -54,6 +55,11 @@
 //| Supported format codes: *b*, *B*, *h*, *H*, *i*, *I*, *l*, *L*, *q*, *Q*,
 //| *s*, *P*, *f*, *d* (the latter 2 depending on the floating-point support).
 //|
+//| .. toctree::
+//|     :maxdepth: 3
+//|
+//|     Struct
+//|
 
 
 //| .. function:: calcsize(fmt)
@@ -152,6 +158,19 @@ STATIC mp_obj_t struct_unpack_from(size_t n_args, const mp_obj_t *args) {
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_unpack_from_obj, 2, 3, struct_unpack_from);
 
+#if MICROPY_CPYTHON_COMPAT
+//| .. function:: iter_unpack(fmt, data, offset=0, stride=calcsize(fmt))
+//|
+//|   Return an iterator that unpacks one record at a time from the data
+//|   according to the format string fmt, as :meth:`Struct.iter_unpack` does.
+//|
+
+STATIC mp_obj_t struct_iter_unpack(size_t n_args, const mp_obj_t *args) {
+    return struct_struct_iter_unpack_helper(shared_modules_struct_struct_compile(args[0]), n_args - 1, args + 1);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(struct_iter_unpack_obj, 2, 4, struct_iter_unpack);
+#endif
+
 STATIC const mp_rom_map_elem_t mp_module_struct_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_struct) },
     { MP_ROM_QSTR(MP_QSTR_calcsize), MP_ROM_PTR(&struct_calcsize_obj) },
@@ -159,6 +178,10 @@ STATIC const mp_rom_map_elem_t mp_module_struct_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_pack_into), MP_ROM_PTR(&struct_pack_into_obj) },
     { MP_ROM_QSTR(MP_QSTR_unpack), MP_ROM_PTR(&struct_unpack_from_obj) },
     { MP_ROM_QSTR(MP_QSTR_unpack_from), MP_ROM_PTR(&struct_unpack_from_obj) },
+    #if MICROPY_CPYTHON_COMPAT
+    { MP_ROM_QSTR(MP_QSTR_iter_unpack), MP_ROM_PTR(&struct_iter_unpack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_Struct), MP_ROM_PTR(&struct_struct_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_struct_globals, mp_module_struct_globals_table);
@@ -49,6 +49,8 @@ void common_hal_audioio_wavefile_construct(audioio_wavefile_obj_t* self,
                                            pyb_file_obj_t* file) {
     // Load the wave
     self->file = file;
+    // Looping seeks back to the start of the data.
+    fat_file_create_linkmap(file);
     uint8_t chunk_header[16];
     f_rewind(&self->file->fp);
     UINT bytes_read;
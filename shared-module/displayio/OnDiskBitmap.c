@@ -38,6 +38,8 @@ static uint32_t read_word(uint16_t* bmp_header, uint16_t index) {
 void common_hal_displayio_ondiskbitmap_construct(displayio_ondiskbitmap_t *self, pyb_file_obj_t* file) {
     // Load the wave
     self->file = file;
+    // Every pixel is a seek, so avoid walking the FAT each time.
+    fat_file_create_linkmap(file);
     uint16_t bmp_header[24];
     f_rewind(&self->file->fp);
     UINT bytes_read;
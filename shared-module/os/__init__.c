@@ -84,6 +84,7 @@ STATIC mp_obj_t mp_vfs_proxy_call(mp_vfs_mount_t *vfs, qstr meth_name, size_t n_
 void common_hal_os_chdir(const char* path) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_dir_path(path, &path_out);
+    mp_vfs_import_cache_invalidate();
     MP_STATE_VM(vfs_cur) = vfs;
     if (vfs == MP_VFS_ROOT) {
         // If we change to the root dir and a VFS is mounted at the root then
@@ -138,12 +139,14 @@ void common_hal_os_mkdir(const char* path) {
     if (vfs == MP_VFS_ROOT || (vfs != MP_VFS_NONE && !strcmp(mp_obj_str_get_str(path_out), "/"))) {
         mp_raise_OSError(MP_EEXIST);
     }
+    mp_vfs_import_cache_invalidate();
     mp_vfs_proxy_call(vfs, MP_QSTR_mkdir, 1, &path_out);
 }
 
 void common_hal_os_remove(const char* path) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_path(path, &path_out);
+    mp_vfs_import_cache_invalidate();
     mp_vfs_proxy_call(vfs, MP_QSTR_remove, 1, &path_out);
 }
 
@@ -155,12 +158,14 @@ void common_hal_os_rename(const char* old_path, const char* new_path) {
         // can't rename across filesystems
         mp_raise_OSError(MP_EPERM);
     }
+    mp_vfs_import_cache_invalidate();
     mp_vfs_proxy_call(old_vfs, MP_QSTR_rename, 2, args);
 }
 
 void common_hal_os_rmdir(const char* path) {
     mp_obj_t path_out;
     mp_vfs_mount_t *vfs = lookup_dir_path(path, &path_out);
+    mp_vfs_import_cache_invalidate();
     mp_vfs_proxy_call(vfs, MP_QSTR_rmdir, 1, &path_out);
 }
 
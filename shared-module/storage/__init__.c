@@ -97,6 +97,7 @@ void common_hal_storage_mount(mp_obj_t vfs_obj, const char* mount_path, bool rea
 
     // Insert the vfs into the mount table by pushing it onto the front of the
     // mount table.
+    mp_vfs_import_cache_invalidate();
     mp_vfs_mount_t **vfsp = &MP_STATE_VM(vfs_mount_table);
     vfs->next = *vfsp;
     *vfsp = vfs;
@@ -116,6 +117,7 @@ void common_hal_storage_umount_object(mp_obj_t vfs_obj) {
     if (vfs == NULL) {
         mp_raise_OSError(MP_EINVAL);
     }
+    mp_vfs_import_cache_invalidate();
 
     // if we unmounted the current device then set current to root
     if (MP_STATE_VM(vfs_cur) == vfs) {
@@ -0,0 +1,143 @@
+
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2016 Paul Sokolovsky
+ * Copyright (c) 2017 Scott Shawcroft for Adafruit Industries
+ * Copyright (c) 2017 Michael McWethy
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/binary.h"
+#include "py/objtuple.h"
+#include "shared-bindings/struct/__init__.h"
+#include "shared-bindings/struct/Struct.h"
+#include "shared-module/struct/__init__.h"
+#include "supervisor/shared/translate.h"
+
+#if MICROPY_CPYTHON_COMPAT
+
+struct_struct_obj_t *shared_modules_struct_struct_compile(mp_obj_t fmt_in) {
+    mp_uint_t size = shared_modules_struct_calcsize(fmt_in);
+    const char *fmt = mp_obj_str_get_str(fmt_in);
+    char fmt_type = get_fmt_type(&fmt);
+    size_t n_fields = calcsize_items(fmt);
+    struct_struct_obj_t *self = m_new_obj_var(struct_struct_obj_t, struct_field_t, n_fields);
+    self->base.type = &struct_struct_type;
+    self->format = fmt_in;
+    self->fmt_type = fmt_type;
+    self->size = size;
+    self->n_fields = n_fields;
+    mp_uint_t offset = 0;
+    for (size_t i = 0; i < n_fields; fmt++) {
+        mp_uint_t cnt = 1;
+        if (unichar_isdigit(*fmt)) {
+            cnt = get_fmt_num(&fmt);
+        }
+        if (*fmt == 's') {
+            self->fields[i].type = 's';
+            self->fields[i].offset = offset;
+            self->fields[i++].len = cnt;
+            offset += cnt;
+        } else {
+            mp_uint_t align;
+            size_t sz = mp_binary_get_size(fmt_type, *fmt, &align);
+            while (cnt--) {
+                offset = (offset + align - 1) & ~(align - 1);
+                self->fields[i].type = *fmt;
+                self->fields[i++].offset = offset;
+                offset += sz;
+            }
+        }
+    }
+    return self;
+}
+
+mp_obj_t shared_modules_struct_struct_unpack_record(struct_struct_obj_t *self, const byte *p) {
+    mp_obj_tuple_t *res = MP_OBJ_TO_PTR(mp_obj_new_tuple(self->n_fields, NULL));
+    for (size_t i = 0; i < self->n_fields; i++) {
+        const struct_field_t *f = &self->fields[i];
+        byte *q = (byte*)p + f->offset;
+        if (f->type == 's') {
+            res->items[i] = mp_obj_new_bytes(q, f->len);
+        } else {
+            res->items[i] = mp_binary_get_val(self->fmt_type, f->type, &q);
+        }
+    }
+    return MP_OBJ_FROM_PTR(res);
+}
+
+void shared_modules_struct_struct_pack_record(struct_struct_obj_t *self, byte *p, size_t n_args, const mp_obj_t *args) {
+    if (n_args != self->n_fields) {
+        mp_raise_RuntimeError(translate("wrong number of arguments"));
+    }
+    for (size_t i = 0; i < n_args; i++) {
+        const struct_field_t *f = &self->fields[i];
+        byte *q = p + f->offset;
+        if (f->type == 's') {
+            mp_buffer_info_t bufinfo;
+            mp_get_buffer_raise(args[i], &bufinfo, MP_BUFFER_READ);
+            mp_uint_t to_copy = MIN(bufinfo.len, f->len);
+            memcpy(q, bufinfo.buf, to_copy);
+            memset(q + to_copy, 0, f->len - to_copy);
+        } else {
+            mp_binary_set_val(self->fmt_type, f->type, args[i], &q);
+        }
+    }
+}
+
+typedef struct {
+    mp_obj_base_t base;
+    mp_fun_1_t iternext;
+    struct_struct_obj_t *st;
+    mp_obj_t buffer;
+    size_t offset;
+    size_t stride;
+} struct_iter_t;
+
+STATIC mp_obj_t struct_iter_unpack_iternext(mp_obj_t self_in) {
+    struct_iter_t *self = MP_OBJ_TO_PTR(self_in);
+    // get the buffer each time in case it was resized
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(self->buffer, &bufinfo, MP_BUFFER_READ);
+    if (self->offset > bufinfo.len || bufinfo.len - self->offset < self->st->size) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    mp_obj_t res = shared_modules_struct_struct_unpack_record(self->st, (byte*)bufinfo.buf + self->offset);
+    self->offset += self->stride;
+    return res;
+}
+
+mp_obj_t shared_modules_struct_struct_iter_unpack(struct_struct_obj_t *self, mp_obj_t buffer, size_t offset, size_t stride) {
+    struct_iter_t *o = m_new_obj(struct_iter_t);
+    o->base.type = &mp_type_polymorph_iter;
+    o->iternext = struct_iter_unpack_iternext;
+    o->st = self;
+    o->buffer = buffer;
+    o->offset = offset;
+    o->stride = stride;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+#endif // MICROPY_CPYTHON_COMPAT
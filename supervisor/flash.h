@@ -41,6 +41,9 @@ void supervisor_flash_set_usb_writable(bool usb_writable);
 void supervisor_flash_init(void);
 uint32_t supervisor_flash_get_block_size(void);
 uint32_t supervisor_flash_get_block_count(void);
+// The address at which block 0 can be read in place, or NULL if the flash
+// isn't mapped into memory.
+const uint8_t *supervisor_flash_get_mmap_base(void);
 void supervisor_flash_flush(void);
 
 // these return 0 on success, non-zero on error
@@ -269,6 +269,11 @@ uint32_t supervisor_flash_get_block_count(void) {
     return (flash_device->total_size - SPI_FLASH_ERASE_SIZE) / FILESYSTEM_BLOCK_SIZE;
 }
 
+// External flash is only reached through commands, not mapped into memory.
+const uint8_t *supervisor_flash_get_mmap_base(void) {
+    return NULL;
+}
+
 // Flush the cache that was written to the scratch portion of flash. Only used
 // when ram is tight.
 static bool flush_scratch_flash(void) {
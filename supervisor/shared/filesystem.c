@@ -31,6 +31,7 @@
 #include "py/mpstate.h"
 
 #include "supervisor/flash.h"
+#include "supervisor/usb.h"
 
 static mp_vfs_mount_t _mp_vfs;
 static fs_user_mount_t _internal_vfs;
@@ -89,6 +90,9 @@ void filesystem_init(bool create_allowed, bool force_create) {
 }
 
 void filesystem_flush(void) {
+    #ifdef USB_AVAILABLE
+    usb_msc_flush();
+    #endif
     supervisor_flash_flush();
 }
 
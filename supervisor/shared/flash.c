@@ -166,6 +166,16 @@ STATIC mp_obj_t supervisor_flash_obj_ioctl(mp_obj_t self, mp_obj_t cmd_in, mp_ob
         case BP_IOCTL_SYNC: supervisor_flash_flush(); return MP_OBJ_NEW_SMALL_INT(0);
         case BP_IOCTL_SEC_COUNT: return MP_OBJ_NEW_SMALL_INT(flash_get_block_count());
         case BP_IOCTL_SEC_SIZE: return MP_OBJ_NEW_SMALL_INT(supervisor_flash_get_block_size());
+        case BP_IOCTL_MMAP_ADDR: {
+            const uint8_t *base = supervisor_flash_get_mmap_base();
+            if (base == NULL) {
+                return mp_const_none;
+            }
+            // mapped data must match the blocks, so write out any cached ones
+            supervisor_flash_flush();
+            // block 0 of the device is the MBR made up by flash_read_blocks
+            return mp_obj_new_int_from_uint((uintptr_t)base - PART1_START_BLOCK * FILESYSTEM_BLOCK_SIZE);
+        }
         default: return mp_const_none;
     }
 }
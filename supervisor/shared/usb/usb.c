@@ -77,6 +77,7 @@ void usb_background(void) {
     if (usb_enabled()) {
         tusb_task();
         tud_cdc_write_flush();
+        usb_msc_background();
     }
 }
 
@@ -38,8 +38,41 @@
 
 #define MSC_FLASH_BLOCK_SIZE    512
 
+// Number of blocks written by the host that are held in RAM and then written
+// to the device in order of block number, so that writes to the same erase
+// sector are grouped.  0 writes each block as it arrives.
+#ifndef CIRCUITPY_USB_MSC_QUEUE_BLOCKS
+#define CIRCUITPY_USB_MSC_QUEUE_BLOCKS (0)
+#endif
+
+// How long the host must stop writing before queued blocks are written and
+// the flash is flushed.
+#ifndef CIRCUITPY_USB_MSC_FLUSH_DELAY_MS
+#define CIRCUITPY_USB_MSC_FLUSH_DELAY_MS (100)
+#endif
+
+// SYNCHRONIZE CACHE (10) isn't handled by TinyUSB itself.
+#ifndef SCSI_CMD_SYNCHRONIZE_CACHE_10
+#define SCSI_CMD_SYNCHRONIZE_CACHE_10 0x35
+#endif
+
 static bool ejected[1];
 
+static bool flush_pending;
+static uint32_t last_write_ms;
+
+#if CIRCUITPY_USB_MSC_QUEUE_BLOCKS
+typedef struct {
+    uint32_t lba;
+    uint8_t data[MSC_FLASH_BLOCK_SIZE];
+} queued_block_t;
+
+static queued_block_t write_queue[CIRCUITPY_USB_MSC_QUEUE_BLOCKS];
+// Indices into write_queue in order of block number.
+static uint8_t write_queue_order[CIRCUITPY_USB_MSC_QUEUE_BLOCKS];
+static uint8_t write_queue_len;
+#endif
+
 // The root FS is always at the end of the list.
 static fs_user_mount_t* get_vfs(int lun) {
     // TODO(tannewt): Return the mount which matches the lun where 0 is the end
@@ -57,6 +90,56 @@ static fs_user_mount_t* get_vfs(int lun) {
     return current_mount->obj;
 }
 
+static void write_blocks(fs_user_mount_t *vfs, const uint8_t *data, uint32_t lba, uint32_t count) {
+    if (vfs == NULL) {
+        return;
+    }
+    disk_write(vfs, data, lba, count);
+    // Since by getting here we assume the mount is read-only to
+    // MicroPython let's update the cached FatFs sector if it's the one
+    // we just wrote.
+    #if _MAX_SS != _MIN_SS
+    if (vfs->fatfs.ssize == MSC_FLASH_BLOCK_SIZE) {
+    #else
+    // The compiler can optimize this away.
+    if (_MAX_SS == FILESYSTEM_BLOCK_SIZE) {
+    #endif
+        if (vfs->fatfs.winsect - lba < count && vfs->fatfs.winsect > 0) {
+            memcpy(vfs->fatfs.win,
+                   data + MSC_FLASH_BLOCK_SIZE * (vfs->fatfs.winsect - lba),
+                   MSC_FLASH_BLOCK_SIZE);
+        }
+    }
+    // The host may have changed any directory, so import can't trust what
+    // it listed before.
+    mp_vfs_import_cache_invalidate();
+}
+
+void usb_msc_flush(void) {
+    #if CIRCUITPY_USB_MSC_QUEUE_BLOCKS
+    fs_user_mount_t *vfs = get_vfs(0);
+    for (size_t i = 0; i < write_queue_len; i++) {
+        queued_block_t *block = &write_queue[write_queue_order[i]];
+        write_blocks(vfs, block->data, block->lba, 1);
+    }
+    write_queue_len = 0;
+    #endif
+}
+
+// Write everything the host has sent and flush the device.
+static bool sync_lun(uint8_t lun) {
+    usb_msc_flush();
+    flush_pending = false;
+    fs_user_mount_t* vfs = get_vfs(lun);
+    return vfs != NULL && disk_ioctl(vfs, CTRL_SYNC, NULL) == RES_OK;
+}
+
+void usb_msc_background(void) {
+    if (flush_pending && tusb_hal_millis() - last_write_ms >= CIRCUITPY_USB_MSC_FLUSH_DELAY_MS) {
+        sync_lun(0);
+    }
+}
+
 // Callback invoked when received an SCSI command not in built-in list below
 // - READ_CAPACITY10, READ_FORMAT_CAPACITY, INQUIRY, MODE_SENSE6, REQUEST_SENSE
 // - READ10 and WRITE10 have their own callbacks
@@ -97,11 +180,7 @@ int32_t tud_msc_scsi_cb (uint8_t lun, const uint8_t scsi_cmd[16], void* buffer,
                 if (lun > 1) {
                     resplen = -1;
                 } else {
-                    fs_user_mount_t* current_mount = get_vfs(lun);
-                    if (current_mount == NULL) {
-                        resplen = -1;
-                    }
-                    if (disk_ioctl(current_mount, CTRL_SYNC, NULL) != RES_OK) {
+                    if (!sync_lun(lun)) {
                         resplen = -1;
                     } else {
                         ejected[lun] = true;
@@ -111,6 +190,13 @@ int32_t tud_msc_scsi_cb (uint8_t lun, const uint8_t scsi_cmd[16], void* buffer,
         }
         break;
 
+        case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+            resplen = 0;
+            if (lun > 1 || !sync_lun(lun)) {
+                resplen = -1;
+            }
+        break;
+
         default:
           // Set Sense = Invalid Command Operation
           tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);
@@ -166,6 +252,16 @@ int32_t tud_msc_read10_cb (uint8_t lun, uint32_t lba, uint32_t offset, void* buf
     fs_user_mount_t * vfs = get_vfs(lun);
     disk_read(vfs, buffer, lba, block_count);
 
+    #if CIRCUITPY_USB_MSC_QUEUE_BLOCKS
+    // The host must read back what it wrote even if it's still queued.
+    for (size_t i = 0; i < write_queue_len; i++) {
+        if (write_queue[i].lba - lba < block_count) {
+            memcpy((uint8_t*)buffer + (write_queue[i].lba - lba) * MSC_FLASH_BLOCK_SIZE,
+                   write_queue[i].data, MSC_FLASH_BLOCK_SIZE);
+        }
+    }
+    #endif
+
     return block_count * MSC_FLASH_BLOCK_SIZE;
 }
 
@@ -177,23 +273,34 @@ int32_t tud_msc_write10_cb (uint8_t lun, uint32_t lba, uint32_t offset, uint8_t*
 
     const uint32_t block_count = bufsize / MSC_FLASH_BLOCK_SIZE;
 
-    fs_user_mount_t * vfs = get_vfs(lun);
-    disk_write(vfs, buffer, lba, block_count);
-    // Since by getting here we assume the mount is read-only to
-    // MicroPython let's update the cached FatFs sector if it's the one
-    // we just wrote.
-    #if _MAX_SS != _MIN_SS
-    if (vfs->ssize == MSC_FLASH_BLOCK_SIZE) {
-    #else
-    // The compiler can optimize this away.
-    if (_MAX_SS == FILESYSTEM_BLOCK_SIZE) {
-    #endif
-        if (lba == vfs->fatfs.winsect && lba > 0) {
-            memcpy(vfs->fatfs.win,
-                   buffer + MSC_FLASH_BLOCK_SIZE * (vfs->fatfs.winsect - lba),
-                   MSC_FLASH_BLOCK_SIZE);
+    #if CIRCUITPY_USB_MSC_QUEUE_BLOCKS
+    for (uint32_t i = 0; i < block_count; i++) {
+        // Find where the block goes in the queue; a block that is already
+        // queued is replaced.
+        size_t pos = 0;
+        while (pos < write_queue_len && write_queue[write_queue_order[pos]].lba < lba + i) {
+            pos++;
         }
+        queued_block_t *block;
+        if (pos < write_queue_len && write_queue[write_queue_order[pos]].lba == lba + i) {
+            block = &write_queue[write_queue_order[pos]];
+        } else {
+            if (write_queue_len == CIRCUITPY_USB_MSC_QUEUE_BLOCKS) {
+                usb_msc_flush();
+                pos = 0;
+            }
+            memmove(&write_queue_order[pos + 1], &write_queue_order[pos], write_queue_len - pos);
+            write_queue_order[pos] = write_queue_len;
+            block = &write_queue[write_queue_len++];
+            block->lba = lba + i;
+        }
+        memcpy(block->data, buffer + i * MSC_FLASH_BLOCK_SIZE, MSC_FLASH_BLOCK_SIZE);
     }
+    #else
+    write_blocks(get_vfs(lun), buffer, lba, block_count);
+    #endif
+    flush_pending = true;
+    last_write_ms = tusb_hal_millis();
 
     return block_count * MSC_FLASH_BLOCK_SIZE;
 }
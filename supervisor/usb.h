@@ -41,4 +41,9 @@ void init_usb_hardware(void);
 bool usb_enabled(void);
 void usb_init(void);
 
+// Writes blocks the host has written to CIRCUITPY and are still queued in RAM.
+void usb_msc_flush(void);
+// Flushes host writes once the host has been idle for a while.
+void usb_msc_background(void);
+
 #endif // MICROPY_INCLUDED_SUPERVISOR_USB_H
@@ -0,0 +1,35 @@
+# test that the GC keeps wide and deep structures alive, which need more
+# than the default mark stack to trace
+
+try:
+    import gc
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    # many objects reachable from one
+    wide = [[i, (i,)] for i in range(2000)]
+    # objects that each hold many others
+    nested = [[[j] for j in range(50)] for i in range(40)]
+    # a long chain
+    deep = None
+    for i in range(2000):
+        deep = [i, deep]
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+for i in range(3):
+    gc.collect()
+    junk = [[j] for j in range(1000)]
+
+print(all(wide[i][0] == i and wide[i][1] == (i,) for i in range(2000)))
+print(all(nested[i][j] == [j] for i in range(40) for j in range(50)))
+n = 0
+while deep is not None:
+    if deep[0] != 1999 - n:
+        break
+    n += 1
+    deep = deep[1]
+print(n)
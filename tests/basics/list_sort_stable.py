@@ -0,0 +1,45 @@
+# test that list.sort and sorted are stable, and call key once per item
+
+# equal keys keep their order, also when reversed
+l = [(i % 5, i) for i in range(50)]
+print(sorted(l, key=lambda x: x[0]))
+print(sorted(l, key=lambda x: x[0], reverse=True))
+
+# runs that ascend, descend and are equal, long enough to be merged
+l = list(range(100)) + list(range(100, 0, -1)) + [7] * 50 + list(range(50))
+print(sorted(l) == sorted(l, key=lambda x: x))
+l2 = [(x, i) for i, x in enumerate(l)]
+l2.sort(key=lambda x: x[0])
+print(all(l2[i] < l2[i + 1] for i in range(len(l2) - 1)))
+l2.sort(key=lambda x: x[0], reverse=True)
+print(all(l2[i][0] > l2[i + 1][0] or (l2[i][0] == l2[i + 1][0] and l2[i][1] < l2[i + 1][1]) for i in range(len(l2) - 1)))
+
+# key is called once for each item
+n = 0
+def key(x):
+    global n
+    n += 1
+    return -x
+l = [(i * 7919) % 1000 for i in range(1000)]
+l.sort(key=key)
+print(n, l[:5], l[-5:])
+
+# homogeneous lists of floats and strs, and a mixed list
+print(sorted([2.5, -1.0, 3.25, 0.0, -7.5]))
+print(sorted(['pear', 'apple', 'fig', 'apples', '', 'Pear']))
+print(sorted([3, 1.5, True, -2, 2.0]))
+
+# an exception from a comparison leaves all the items in the list
+class A:
+    def __init__(self, x):
+        self.x = x
+    def __lt__(self, other):
+        if self.x == 13 or other.x == 13:
+            raise ValueError
+        return self.x < other.x
+l = [A((i * 37) % 100) for i in range(100)]
+try:
+    l.sort()
+except ValueError:
+    print('ValueError')
+print(sorted(a.x for a in l) == list(range(100)))
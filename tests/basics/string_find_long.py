@@ -0,0 +1,31 @@
+# test searching long str/bytes, exercising the word-at-a-time and skip-table
+# search paths at every alignment and needle length
+
+hay = "".join(chr(ord("a") + (i * 7) % 26) for i in range(200))
+
+for n in (1, 2, 3, 4, 5, 9, 17, 40):
+    for off in (0, 1, 3, 7, 8, 13, 63, 64, 150, 200 - n):
+        needle = hay[off:off + n]
+        print(n, off, hay.find(needle), hay.rfind(needle), hay.count(needle), needle in hay)
+        print(hay.find(needle, off), hay.rfind(needle, 0, off + n), hay.find(needle + "!"))
+
+# needle only at the very end or very start
+s = "x" * 100 + "yz"
+print(s.find("yz"), s.rfind("yz"), s.find("xy"), s.rfind("xxxxy"), s.find("xxxxxy"))
+print(s.find("x" * 101), s.find("x" * 100 + "y"), s.count("xx"), s.count("xxxx"))
+
+# separators at boundaries and adjacent
+line = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"
+print(line.split(","))
+print(line.split(",", 3))
+print(line.rsplit(",", 3))
+print(line.split(",M,"))
+print(line.replace(",", ";"))
+print(line.replace(",M,", "--", 1))
+print(",,a,,".split(","), ",,a,,".split(",,"), ",,a,,".rsplit(",", 2))
+
+# long needles and haystacks with bytes, including zero bytes
+b = bytes(range(256)) * 2
+print(b.find(bytes(range(250, 256)) + bytes(range(4))), b.rfind(bytes(range(10))))
+print(b.find(b"\x00\x01\x02\x03\x04"), b.count(b"\x00"), b.split(b"\x80\x81\x82\x83")[1][:4])
+print(b.find(b"\xff\xfe"), b.rfind(b"\xff"), b.count(b"\xfe\xff\x00"))
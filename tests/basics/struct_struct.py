@@ -0,0 +1,74 @@
+# test precompiled Struct objects and iter_unpack
+
+try:
+    import ustruct as struct
+except:
+    try:
+        import struct
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+try:
+    struct.Struct
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+s = struct.Struct('<HbI')
+print(s.size, s.format)
+b = s.pack(1, -2, 3)
+print(b)
+print(s.unpack(b))
+print(s.unpack_from(b'\xff' + b, 1))
+print(s.unpack_from(b'\xff' + b, -7))
+
+# native alignment and byte strings
+s = struct.Struct('b2sI')
+print(s.size == struct.calcsize('b2sI'))
+print(s.unpack(s.pack(1, b'abc', 2)))
+print(s.unpack(s.pack(1, b'a', 2)))
+s = struct.Struct('>3H')
+print(s.pack(1, 2, 3), s.unpack(b'\x00\x01\x00\x02\x00\x03'))
+
+# pack_into
+s = struct.Struct('<hh')
+buf = bytearray(8)
+s.pack_into(buf, 2, -1, 0x102)
+print(buf)
+s.pack_into(buf, -4, 5, 6)
+print(buf)
+
+# iter_unpack, as a method and a module function
+buf = bytes(range(12))
+print(list(s.iter_unpack(buf)))
+print(list(struct.iter_unpack('>I', buf)))
+print(list(struct.iter_unpack('<H', b'')))
+
+# the iterator can be resumed
+it = s.iter_unpack(buf)
+print(next(it))
+print(list(it))
+
+# errors
+try:
+    s.pack(1)
+except Exception as e:
+    print("Error")
+try:
+    s.pack(1, 2, 3)
+except Exception as e:
+    print("Error")
+for offset in (6, -3, -9, 10):
+    try:
+        s.unpack_from(bytes(8), offset)
+    except Exception as e:
+        print("Error")
+try:
+    s.pack_into(bytearray(3), 0, 1, 2)
+except Exception as e:
+    print("Error")
+try:
+    s.iter_unpack(1)
+except TypeError:
+    print('TypeError')
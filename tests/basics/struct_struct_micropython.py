@@ -0,0 +1,63 @@
+# test MicroPython-specific features of Struct objects
+
+try:
+    import ustruct as struct
+except ImportError:
+    try:
+        import struct
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+try:
+    struct.Struct
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+# ustruct raises ValueError and the struct module of CircuitPython raises
+# RuntimeError, with the same messages
+
+s = struct.Struct('<hB')
+
+# iter_unpack with an offset and stride, and a trailing partial record
+buf = bytes(range(16))
+print(list(s.iter_unpack(buf, 1, 5)))
+print(list(struct.iter_unpack('<H', buf, 12)))
+print(list(struct.iter_unpack('<H', b'\x01\x00\x02')))
+
+# the buffer is fetched again on each step
+buf = bytearray(s.pack(1, 2))
+it = s.iter_unpack(buf)
+buf.extend(s.pack(3, 4))
+print(list(it))
+
+# pack_many_into packs a sequence of records
+buf = bytearray(12)
+print(s.pack_many_into(buf, 0, [(1, 2), (-1, 255), [3, 4]]))
+print(buf)
+print(s.pack_many_into(buf, 1, ((i, i) for i in range(3)), 4))
+print(buf)
+print(s.pack_many_into(buf, 0, ()))
+try:
+    s.pack_many_into(buf, 8, [(1, 2), (3, 4)])
+except (ValueError, RuntimeError) as e:
+    print(e)
+print(buf)
+try:
+    s.pack_many_into(buf, 0, [(1, 2, 3)])
+except (ValueError, RuntimeError) as e:
+    print(e)
+for stride in (0, -1):
+    try:
+        s.pack_many_into(buf, 0, [(1, 2)], stride)
+    except (ValueError, RuntimeError) as e:
+        print(e)
+    try:
+        s.iter_unpack(buf, 0, stride)
+    except (ValueError, RuntimeError) as e:
+        print(e)
+try:
+    s.iter_unpack(buf, -1)
+except (ValueError, RuntimeError) as e:
+    print(e)
@@ -0,0 +1,18 @@
+# Array operation
+# Type: array('h'), inplace scale and offset of samples using for, with
+# saturation done in Python.
+import bench
+from array import array
+
+def test(num):
+    for i in iter(range(num//10000)):
+        arr = array('h', [1000] * 1000)
+        for i in range(len(arr)):
+            x = arr[i] * 3 // 2 - 100
+            if x > 32767:
+                x = 32767
+            elif x < -32768:
+                x = -32768
+            arr[i] = x
+
+bench.run(test)
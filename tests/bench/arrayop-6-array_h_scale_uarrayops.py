@@ -0,0 +1,13 @@
+# Array operation
+# Type: array('h'), inplace scale and offset of samples using uarrayops,
+# which saturates and doesn't box each element.
+import bench
+from array import array
+import uarrayops
+
+def test(num):
+    for i in iter(range(num//10000)):
+        arr = array('h', [1000] * 1000)
+        uarrayops.scale(arr, arr, 1.5, -100)
+
+bench.run(test)
@@ -0,0 +1,9 @@
+import bench
+
+def test(num):
+    for i in range(num // 2000):
+        d = {}
+        for j in range(100):
+            d[j] = j
+
+bench.run(test)
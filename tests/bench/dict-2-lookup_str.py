@@ -0,0 +1,12 @@
+import bench
+
+def test(num):
+    keys = ["key%d" % i for i in range(50)]
+    d = {}
+    for k in keys:
+        d[k] = k
+    for i in range(num // 200):
+        for k in keys:
+            d[k]
+
+bench.run(test)
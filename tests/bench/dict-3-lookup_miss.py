@@ -0,0 +1,11 @@
+import bench
+
+def test(num):
+    d = {}
+    for i in range(0, 200, 2):
+        d[i] = i
+    for i in range(num // 2000):
+        for j in range(1, 200, 2):
+            j in d
+
+bench.run(test)
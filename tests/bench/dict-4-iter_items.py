@@ -0,0 +1,11 @@
+import bench
+
+def test(num):
+    d = {}
+    for i in range(100):
+        d[i] = i
+    for i in range(num // 400):
+        for k, v in d.items():
+            pass
+
+bench.run(test)
@@ -0,0 +1,11 @@
+import bench
+
+def test(num):
+    d = {}
+    for i in range(50):
+        d[i] = i
+    for i in range(50, 50 + num // 20):
+        del d[i - 50]
+        d[i] = i
+
+bench.run(test)
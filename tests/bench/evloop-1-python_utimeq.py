@@ -0,0 +1,30 @@
+# 20 tasks switching with a scheduler written in Python on top of utimeq
+import bench
+import utime
+import utimeq
+
+def task(n):
+    for i in range(n):
+        yield 0
+
+def run(tasks):
+    q = utimeq.utimeq(len(tasks))
+    for t in tasks:
+        q.push(utime.ticks_ms(), t, None)
+    item = [0, 0, 0]
+    while q:
+        t = q.peektime()
+        delay = utime.ticks_diff(t, utime.ticks_ms())
+        if delay > 0:
+            utime.sleep_ms(delay)
+        q.pop(item)
+        try:
+            delay = next(item[1])
+        except StopIteration:
+            continue
+        q.push(utime.ticks_add(utime.ticks_ms(), delay), item[1], None)
+
+def test(num):
+    run([task(num // 2000) for i in range(20)])
+
+bench.run(test)
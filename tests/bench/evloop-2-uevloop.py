@@ -0,0 +1,15 @@
+# 20 tasks switching with the native event loop
+import bench
+import uevloop
+
+def task(n):
+    for i in range(n):
+        yield 0
+
+def test(num):
+    loop = uevloop.Loop()
+    for i in range(20):
+        loop.create_task(task(num // 2000))
+    loop.run_forever()
+
+bench.run(test)
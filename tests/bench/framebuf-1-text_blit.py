@@ -0,0 +1,21 @@
+# draw text, icons and fills on an RGB565 display-sized framebuffer
+import bench
+import framebuf
+
+def test(num):
+    fb = framebuf.FrameBuffer(bytearray(240 * 240 * 2), 240, 240, framebuf.RGB565)
+    icon = framebuf.FrameBuffer(bytearray(32 * 32 // 8), 32, 32, framebuf.MONO_HLSB)
+    icon.fill_rect(4, 4, 24, 24, 1)
+    pal = framebuf.FrameBuffer(bytearray(4), 2, 1, framebuf.RGB565)
+    pal.pixel(0, 0, 0x0000)
+    pal.pixel(1, 0, 0xffe0)
+    for i in range(num // 200000):
+        fb.fill(0x001f)
+        for row in range(0, 240, 10):
+            fb.text('Hello framebuf %d' % row, 0, row, 0xffff)
+        for x in range(0, 240, 32):
+            fb.blit(icon, x, 100, 0, pal)
+        fb.hline(0, 200, 240, 0xf800)
+        fb.scroll(0, -8)
+
+bench.run(test)
@@ -0,0 +1,10 @@
+# collect a heap holding a list of many small objects
+import bench
+import gc
+
+def test(num):
+    l = [(i, [i]) for i in range(10000)]
+    for i in range(num // 4000):
+        gc.collect()
+
+bench.run(test)
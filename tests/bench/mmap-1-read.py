@@ -0,0 +1,19 @@
+# look up records in a table read from a file into the heap
+import bench
+import uos
+import ustruct
+
+def test(num):
+    name = 'mmap_bench.tmp'
+    with open(name, 'wb') as f:
+        for i in range(4096):
+            f.write(ustruct.pack('<II', i, i * 3))
+    total = 0
+    for i in range(num // 20000):
+        with open(name, 'rb') as f:
+            table = f.read()
+        for j in range(0, 4096, 64):
+            total += ustruct.unpack_from('<II', table, j * 8)[1]
+    uos.unlink(name)
+
+bench.run(test)
@@ -0,0 +1,21 @@
+# look up records in a table mapped from a file
+import bench
+import uos
+import ustruct
+import ummap
+
+def test(num):
+    name = 'mmap_bench.tmp'
+    with open(name, 'wb') as f:
+        for i in range(4096):
+            f.write(ustruct.pack('<II', i, i * 3))
+    total = 0
+    for i in range(num // 20000):
+        with open(name, 'rb') as f:
+            table = ummap.mmap(f.fileno(), 0, access=ummap.ACCESS_READ)
+        for j in range(0, 4096, 64):
+            total += ustruct.unpack_from('<II', table, j * 8)[1]
+        table.close()
+    uos.unlink(name)
+
+bench.run(test)
@@ -0,0 +1,28 @@
+# poll a large set of sockets of which only one is ready
+import bench
+import usocket
+import uselect
+
+def test(num):
+    poller = uselect.poll()
+    socks = []
+    for i in range(200):
+        s = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+        s.bind(usocket.getaddrinfo('127.0.0.1', 0)[0][-1])
+        poller.register(s, uselect.POLLIN)
+        socks.append(s)
+    # a datagram that is never read keeps one socket ready
+    tx = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+    ready = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+    ready.bind(usocket.getaddrinfo('127.0.0.1', 8269)[0][-1])
+    tx.sendto(b'x', usocket.getaddrinfo('127.0.0.1', 8269)[0][-1])
+    poller.register(ready, uselect.POLLIN)
+    for i in range(num // 1000):
+        for s, ev in poller.ipoll(0):
+            pass
+    for s in socks:
+        s.close()
+    ready.close()
+    tx.close()
+
+bench.run(test)
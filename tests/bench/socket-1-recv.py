@@ -0,0 +1,18 @@
+# receive datagrams into a new bytes object each time
+import bench
+import usocket
+
+def test(num):
+    addr = usocket.getaddrinfo('127.0.0.1', 8269)[0][-1]
+    rx = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+    rx.bind(addr)
+    tx = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+    tx.connect(addr)
+    data = bytes(512)
+    for i in range(num // 2000):
+        tx.send(data)
+        rx.recv(512)
+    rx.close()
+    tx.close()
+
+bench.run(test)
@@ -0,0 +1,19 @@
+# receive datagrams into the same buffer each time
+import bench
+import usocket
+
+def test(num):
+    addr = usocket.getaddrinfo('127.0.0.1', 8269)[0][-1]
+    rx = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+    rx.bind(addr)
+    tx = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+    tx.connect(addr)
+    data = bytes(512)
+    buf = bytearray(512)
+    for i in range(num // 2000):
+        tx.send(data)
+        rx.recv_into(buf)
+    rx.close()
+    tx.close()
+
+bench.run(test)
@@ -0,0 +1,10 @@
+import bench
+
+def test(num):
+    # ascending with a descending tail, like appended time-series data
+    l0 = list(range(900)) + list(range(1000, 900, -1))
+    for i in range(num // 40000):
+        l = l0[:]
+        l.sort()
+
+bench.run(test)
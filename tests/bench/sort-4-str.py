@@ -0,0 +1,9 @@
+import bench
+
+def test(num):
+    l0 = [str((i * 7919) % 1000) for i in range(1000)]
+    for i in range(num // 20000):
+        l = l0[:]
+        l.sort()
+
+bench.run(test)
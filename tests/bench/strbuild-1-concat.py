@@ -0,0 +1,11 @@
+# Building a string from pieces
+# Naive repeated concatenation - copies the whole string on every step
+import bench
+
+def test(num):
+    for i in iter(range(num // 20000)):
+        s = ""
+        for j in range(100):
+            s += "value=%d;" % j
+
+bench.run(test)
@@ -0,0 +1,12 @@
+# Building a string from pieces
+# Collect pieces in a list, then join them in one allocation
+import bench
+
+def test(num):
+    for i in iter(range(num // 20000)):
+        l = []
+        for j in range(100):
+            l.append("value=%d;" % j)
+        s = "".join(l)
+
+bench.run(test)
@@ -0,0 +1,16 @@
+# Building a string from pieces
+# Write pieces to a growable StringIO buffer, getvalue() doesn't copy
+import bench
+try:
+    import uio as io
+except ImportError:
+    import io
+
+def test(num):
+    for i in iter(range(num // 20000)):
+        buf = io.StringIO()
+        for j in range(100):
+            buf.write("value=%d;" % j)
+        s = buf.getvalue()
+
+bench.run(test)
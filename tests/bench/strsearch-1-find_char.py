@@ -0,0 +1,10 @@
+# Searching/splitting protocol text
+# Locate the checksum separator of an NMEA sentence with str.find
+import bench
+
+def test(num):
+    line = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"
+    for i in iter(range(num // 1000)):
+        line.find("*")
+
+bench.run(test)
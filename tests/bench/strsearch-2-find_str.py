@@ -0,0 +1,10 @@
+# Searching/splitting protocol text
+# Locate the end of HTTP headers in a response with str.find
+import bench
+
+def test(num):
+    resp = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 12\r\nServer: test\r\n\r\nHello world!"
+    for i in iter(range(num // 1000)):
+        resp.find("\r\n\r\n")
+
+bench.run(test)
@@ -0,0 +1,14 @@
+import bench
+import gc
+import ustruct
+
+def test(num):
+    buf = bytes(range(256)) * 16
+    s = ustruct.Struct('<IhH')
+    for i in range(num // 100000):
+        for off in range(0, len(buf), 8):
+            s.unpack_from(buf, off)
+        # keep the heap from filling up so that the timing is per-record
+        gc.collect()
+
+bench.run(test)
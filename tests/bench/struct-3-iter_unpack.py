@@ -0,0 +1,13 @@
+import bench
+import gc
+import ustruct
+
+def test(num):
+    buf = bytes(range(256)) * 16
+    for i in range(num // 100000):
+        for rec in ustruct.iter_unpack('<IhH', buf):
+            pass
+        # keep the heap from filling up so that the timing is per-record
+        gc.collect()
+
+bench.run(test)
@@ -0,0 +1,21 @@
+# small allocations shared among 4 threads
+import bench
+import _thread
+import utime
+
+N_THREAD = 4
+
+def work(n, state):
+    for i in range(n):
+        l = [i, (i, i)]
+    with state[0]:
+        state[1] += 1
+
+def test(num):
+    state = [_thread.allocate_lock(), 0]
+    for i in range(N_THREAD):
+        _thread.start_new_thread(work, (num // 40 // N_THREAD, state))
+    while state[1] < N_THREAD:
+        utime.sleep_ms(1)
+
+bench.run(test)
@@ -0,0 +1,99 @@
+# test blit with a palette, and overlapping blit/scroll
+
+try:
+    import framebuf
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+def printbuf(fb, w, h):
+    print("--8<--")
+    for y in range(h):
+        print(" ".join("%04x" % fb.pixel(x, y) for x in range(w)))
+    print("-->8--")
+
+w = 8
+h = 4
+fbuf = framebuf.FrameBuffer(bytearray(w * h * 2), w, h, framebuf.RGB565)
+
+# 1-bit source mapped to two colours
+mono = framebuf.FrameBuffer(bytearray(8), 8, 2, framebuf.MONO_HLSB)
+mono.pixel(0, 0, 1)
+mono.pixel(2, 0, 1)
+mono.pixel(5, 1, 1)
+pal = framebuf.FrameBuffer(bytearray(4), 2, 1, framebuf.RGB565)
+pal.pixel(0, 0, 0x1234)
+pal.pixel(1, 0, 0xf800)
+fbuf.fill(0)
+fbuf.blit(mono, 0, 1, -1, pal)
+printbuf(fbuf, w, h)
+
+# key is compared against the palette colour
+fbuf.fill(0)
+fbuf.blit(mono, -1, 0, 0x1234, pal)
+printbuf(fbuf, w, h)
+
+# 4-bit source with a palette shorter than the source range
+gs4 = framebuf.FrameBuffer(bytearray(4), 4, 2, framebuf.GS4_HMSB)
+for i in range(8):
+    gs4.pixel(i % 4, i // 4, i * 2)
+pal = framebuf.FrameBuffer(bytearray(8), 4, 1, framebuf.RGB565)
+for i in range(4):
+    pal.pixel(i, 0, 0x1000 * (i + 1))
+fbuf.fill(0xffff)
+fbuf.blit(gs4, 2, 1, -1, pal)
+printbuf(fbuf, w, h)
+
+# overlapping blit of a framebuffer onto itself
+for y in range(h):
+    for x in range(w):
+        fbuf.pixel(x, y, y * 16 + x)
+fbuf.blit(fbuf, 1, 1)
+printbuf(fbuf, w, h)
+fbuf.blit(fbuf, -2, -1)
+printbuf(fbuf, w, h)
+
+# keyed blit of a framebuffer onto itself, checked against a blit from a copy
+fbuf.fill(0x55)
+fbuf.pixel(0, 0, 1)
+fbuf.pixel(0, 2, 2)
+fbuf.blit(fbuf, 1, 0, 0x55)
+printbuf(fbuf, w, h)
+for fmt, n_bits in (
+    (framebuf.MONO_VLSB, 1), (framebuf.MONO_HLSB, 1), (framebuf.GS2_HMSB, 2),
+    (framebuf.GS4_HMSB, 4), (framebuf.GS8, 8), (framebuf.RGB565, 16),
+):
+    ok = True
+    for dx, dy in ((1, 0), (-1, 0), (0, 1), (0, -1), (3, 2), (-2, 1), (1, -3)):
+        fb = framebuf.FrameBuffer(bytearray(200), 10, 10, fmt)
+        ref = framebuf.FrameBuffer(bytearray(200), 10, 10, fmt)
+        copy = framebuf.FrameBuffer(bytearray(200), 10, 10, fmt)
+        for y in range(10):
+            for x in range(10):
+                c = (x * 7 + y * 3 + x * y) % 11 % (1 << n_bits)
+                fb.pixel(x, y, c)
+                ref.pixel(x, y, c)
+                copy.pixel(x, y, c)
+        fb.blit(fb, dx, dy, 0)
+        ref.blit(copy, dx, dy, 0)
+        ok = ok and all(fb.pixel(x, y) == ref.pixel(x, y) for y in range(10) for x in range(10))
+    print(fmt, ok)
+
+# scroll by at least the framebuffer size leaves it unchanged
+fbuf.scroll(w, 0)
+fbuf.scroll(0, -h)
+printbuf(fbuf, w, h)
+
+# source and palette must be FrameBuffers, or instances of a subclass
+class FB(framebuf.FrameBuffer):
+    pass
+sub = FB(bytearray(4), 2, 1, framebuf.RGB565)
+sub.pixel(1, 0, 0xabcd)
+fbuf.fill(0)
+fbuf.blit(mono, 0, 0, -1, sub)
+printbuf(fbuf, w, h)
+for args in ((bytearray(8), 0, 0), (fbuf, 0, 0, -1, bytearray(8)), (fbuf, 0, 0, -1, 1)):
+    try:
+        fbuf.blit(*args)
+    except TypeError:
+        print("TypeError")
@@ -0,0 +1,112 @@
+# test uarrayops element-wise operations and reductions
+
+try:
+    import uarrayops as ao
+    from array import array
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+# saturating element-wise operations on arrays, with arrays and numbers
+a = array('h', [100, -200, 30000, -30000, 0])
+b = array('h', [1000, 1000, 10000, -10000, 5])
+d = array('h', [0] * 5)
+ao.add(d, a, b)
+print(d)
+ao.sub(d, a, b)
+print(d)
+ao.mul(d, a, b)
+print(d)
+ao.add(d, a, 5)
+print(d)
+ao.sub(d, a, 5)
+print(d)
+ao.mul(d, a, 2)
+print(d)
+ao.scale(d, a, 0.5)
+print(d)
+ao.scale(d, a, 1.5, -3)
+print(d)
+ao.scale(d, a, -1)
+print(d)
+ao.clip(d, a, -150, 150)
+print(d)
+
+# reductions
+print(ao.sum(a), ao.mean(a), ao.min(a), ao.max(a), ao.dot(a, b))
+
+# bytearray and float arrays
+u = bytearray([10, 200, 255, 0])
+ao.add(u, u, 100)
+print(u)
+ao.sub(u, u, 150)
+print(u)
+f = array('f', [1.5, -2.0, 4.25])
+ao.scale(f, f, 2, 1)
+print(f, ao.sum(f), ao.min(f), ao.max(f), ao.dot(f, f))
+
+# 32-bit unsigned saturation
+I = array('I', [4000000000, 5, 70000])
+J = array('I', [0] * 3)
+ao.mul(J, I, I)
+print(J)
+ao.add(J, I, I)
+print(J)
+ao.sub(J, I, 10)
+print(J)
+print(ao.sum(I), ao.mean(I))
+
+# bounds beyond a machine word, and dot products beyond 64 bits
+ao.clip(J, I, 10, 4100000000)
+print(J)
+ao.clip(J, I, 70000, 1 << 40)
+print(J)
+ao.clip(J, I, -1, 3000000000)
+print(J)
+K = array('I', [0xffffffff] * 3)
+print(ao.dot(K, K), ao.dot(K, K) == 3 * 0xffffffff ** 2)
+L = array('i', [-0x80000000] * 5)
+print(ao.dot(L, L), ao.dot(L, L) == 5 * 0x80000000 ** 2)
+print(ao.dot(L, array('i', [0x7fffffff, 0x7fffffff, 0x7fffffff, -1, 2])))
+
+# in place on a memoryview slice
+m = memoryview(a)[1:3]
+ao.add(m, m, 1)
+print(a)
+
+# float scale factors on ints are rounded
+d = array('b', [0] * 4)
+ao.scale(d, array('b', [1, 2, 3, -3]), 0.5)
+print(d)
+
+# empty buffers
+e = array('i')
+print(ao.sum(e), ao.dot(e, e))
+try:
+    ao.min(e)
+except ValueError:
+    print('ValueError')
+
+# mismatched buffers and unsupported typecodes
+try:
+    ao.add(array('h', [0, 0]), array('h', [1, 2]), array('h', [1]))
+except ValueError:
+    print('ValueError')
+try:
+    ao.add(array('h', [0]), array('b', [1]), 1)
+except ValueError:
+    print('ValueError')
+try:
+    ao.sum(array('q', [1]))
+except TypeError:
+    print('TypeError')
+try:
+    ao.scale(d, d, 100000.5)
+except ValueError:
+    print('ValueError')
+
+# dest must be writable
+try:
+    ao.add(b'abc', b'abc', 1)
+except TypeError:
+    print('TypeError')
@@ -27,6 +27,9 @@ print(binascii.a2b_base64(b'Zm\x009v\n'))
 print(binascii.a2b_base64(b'Zm9v=='))
 print(binascii.a2b_base64(b'Zm9v==='))
 print(binascii.a2b_base64(b'Zm9v===YmFy'))
+print(binascii.a2b_base64(b'Zm9vYmFy\nZm9vYmFy\n'))
+print(binascii.a2b_base64(b'Zm9vYmFyZg=='))
+print(binascii.a2b_base64(b'Zm9vYmFy\xffZm9v'))
 
 # Unicode strings can be decoded
 print(binascii.a2b_base64(u'Zm9v===YmFy'))
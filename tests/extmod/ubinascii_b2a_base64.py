@@ -20,6 +20,7 @@ print(binascii.b2a_base64(b'\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f'))
 print(binascii.b2a_base64(b'\x7f\x80\xff'))
 print(binascii.b2a_base64(b'1234ABCDabcd'))
 print(binascii.b2a_base64(b'\x00\x00>')) # convert into '+'
+print(binascii.b2a_base64(bytes(range(256))))
 try:
     print(binascii.b2a_base64(''))
 except TypeError:
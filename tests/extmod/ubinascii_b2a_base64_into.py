@@ -0,0 +1,41 @@
+try:
+    try:
+        import ubinascii as binascii
+    except ImportError:
+        import binascii
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    binascii.b2a_base64_into
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+# encodes into the given buffer, without a trailing newline
+buf = bytearray(16)
+for data in (b'', b'f', b'fo', b'foo', b'foob', b'fooba', b'foobar'):
+    n = binascii.b2a_base64_into(buf, data)
+    print(n, buf[:n])
+
+# matches b2a_base64 for a longer input
+data = bytes(range(256))
+buf = bytearray(400)
+n = binascii.b2a_base64_into(buf, data)
+print(n, buf[:n] + b'\n' == binascii.b2a_base64(data))
+
+# works with a memoryview as the destination
+buf = bytearray(8)
+print(binascii.b2a_base64_into(memoryview(buf)[4:], b'abc'), buf)
+
+# buffer too small
+try:
+    binascii.b2a_base64_into(bytearray(3), b'f')
+except ValueError:
+    print("ValueError")
+
+try:
+    binascii.b2a_base64_into(bytearray(4), '')
+except TypeError:
+    print("TypeError")
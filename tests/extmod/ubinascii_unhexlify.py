@@ -11,6 +11,8 @@ print(binascii.unhexlify(b'0001020304050607'))
 print(binascii.unhexlify(b'08090a0b0c0d0e0f'))
 print(binascii.unhexlify(b'7f80ff'))
 print(binascii.unhexlify(b'313233344142434461626364'))
+print(binascii.unhexlify(b'0A0b0C0d0E0f'))
+print(binascii.unhexlify(binascii.hexlify(bytes(range(256)))))
 
 # Unicode strings can be decoded
 print(binascii.unhexlify('313233344142434461626364'))
@@ -24,3 +26,13 @@ try:
     a = binascii.unhexlify(b'gg') # digit not hex
 except ValueError:
     print('ValueError')
+
+try:
+    a = binascii.unhexlify(b'000102030405060g') # non-hex digit at the end
+except ValueError:
+    print('ValueError')
+
+try:
+    a = binascii.unhexlify(b'00\xff1') # non-ASCII char
+except ValueError:
+    print('ValueError')
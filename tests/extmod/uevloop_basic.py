@@ -0,0 +1,121 @@
+# test uevloop tasks, sleeping and spawning
+
+try:
+    import uevloop
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+loop = uevloop.Loop()
+print(len(loop), bool(loop))
+
+# tasks take turns when they yield None
+def count(name, n):
+    for i in range(n):
+        print(name, i)
+        yield
+
+loop.create_task(count('a', 3))
+loop.create_task(count('b', 2))
+print(len(loop))
+loop.run_forever()
+print(len(loop))
+
+# yielding an int sleeps, and tasks wake in order of their deadline
+def sleeper(name, ms):
+    yield ms
+    print('woke', name)
+
+for name, ms in (('c', 30), ('a', 10), ('b', 20), ('a2', 10)):
+    loop.create_task(sleeper(name, ms))
+loop.run_forever()
+
+# call_later_ms delays the start of a task
+loop.call_later_ms(20, count('late', 1))
+loop.create_task(count('soon', 1))
+loop.run_forever()
+
+# yielding a generator spawns it as a new task
+def parent():
+    print('parent start')
+    yield count('child', 2)
+    print('parent continues')
+    yield
+    print('parent end')
+
+loop.run_until_complete(parent())
+
+# run_until_complete returns the value of the task, leaving others queued
+def compute(x):
+    yield 1
+    return x * 2
+
+def forever():
+    while True:
+        yield 5
+
+loop.create_task(forever())
+print(loop.run_until_complete(compute(21)))
+print(len(loop))
+
+# a task can suspend itself by yielding the loop, and is resumed with create_task
+loop = uevloop.Loop()
+waiter = None
+def wait_for_wake():
+    print('suspend')
+    yield loop
+    print('resumed')
+
+def waker():
+    yield 10
+    print('wake')
+    loop.create_task(waiter)
+
+waiter = wait_for_wake()
+loop.create_task(waiter)
+loop.create_task(waker())
+loop.run_forever()
+
+# stop ends run_forever
+def stopper():
+    yield
+    print('stop')
+    loop.stop()
+    yield
+
+loop.create_task(stopper())
+loop.create_task(forever())
+loop.run_forever()
+print(len(loop))
+
+# exceptions in tasks propagate out of the loop
+loop = uevloop.Loop()
+def bad():
+    yield
+    raise ValueError('bad task')
+
+loop.create_task(bad())
+try:
+    loop.run_forever()
+except ValueError as er:
+    print('ValueError', er)
+
+def bad_yield():
+    yield 'x'
+
+try:
+    loop.run_until_complete(bad_yield())
+except TypeError:
+    print('TypeError')
+
+# many tasks, to grow the ready queue and timer heap
+done = []
+def worker(i):
+    yield i % 3
+    yield
+    done.append(i)
+
+for i in range(40):
+    loop.create_task(worker(i))
+loop.run_forever()
+print(len(done), sorted(done) == list(range(40)))
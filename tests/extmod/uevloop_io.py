@@ -0,0 +1,44 @@
+# test uevloop waiting for I/O
+
+try:
+    import uevloop, usocket
+    uevloop.Loop.wait_read
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+loop = uevloop.Loop()
+
+addr = usocket.getaddrinfo('127.0.0.1', 8266)[0][-1]
+rx = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+try:
+    rx.bind(addr)
+except OSError:
+    # the port is in use
+    print("SKIP")
+    raise SystemExit
+tx = usocket.socket(usocket.AF_INET, usocket.SOCK_DGRAM)
+
+def receiver(n):
+    for i in range(n):
+        yield loop.wait_read(rx)
+        print('recv', rx.recv(16))
+
+def sender(n):
+    for i in range(n):
+        yield 10
+        yield loop.wait_write(tx)
+        tx.sendto(b'msg%d' % i, addr)
+
+loop.create_task(receiver(3))
+loop.create_task(sender(3))
+loop.run_forever()
+
+# wait_read must be called from a running task
+try:
+    loop.wait_read(rx)
+except RuntimeError:
+    print('RuntimeError')
+
+rx.close()
+tx.close()
@@ -0,0 +1,99 @@
+# test memory-mapped files
+
+try:
+    import ummap as mmap
+except ImportError:
+    try:
+        import mmap
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+try:
+    import ustruct as struct
+except ImportError:
+    import struct
+
+try:
+    import uos as os
+except ImportError:
+    import os
+
+import gc
+
+name = "ummap_test.tmp"
+data = bytes(range(256)) * 20
+
+with open(name, "wb") as f:
+    f.write(data)
+
+# read-only mapping of the whole file
+with open(name, "rb") as f:
+    m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+print(len(m), m[0], m[255], m[-1], m[10:14], m[-3:])
+print(bytes(m) == data)
+mv = memoryview(m)
+print(mv[300], bytes(mv[4095:4099]))
+print(struct.unpack_from("<HI", m, 1))
+try:
+    m[0] = 1
+except TypeError:
+    print("TypeError")
+try:
+    m[len(data)]
+except IndexError:
+    print("IndexError")
+mv = None
+m.close()
+try:
+    m[0]
+except ValueError:
+    print("ValueError")
+
+# a view of a mapping that is otherwise unreferenced stays usable
+with open(name, "rb") as f:
+    mv = memoryview(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ))
+gc.collect()
+print(mv[300], bytes(mv[-2:]))
+mv = None
+
+# part of the file, at an offset that isn't page aligned
+with open(name, "rb") as f:
+    with mmap.mmap(f.fileno(), 10, access=mmap.ACCESS_READ, offset=4096) as m:
+        print(len(m), m[:])
+
+# writable mapping
+with open(name, "r+b") as f:
+    m = mmap.mmap(f.fileno(), 0)
+    m[0] = 200
+    m[1:4] = b"xyz"
+    memoryview(m)[4:6] = b"MV"
+    m.flush()
+    m.close()
+with open(name, "rb") as f:
+    print(f.read(8))
+
+# copy-on-write mapping doesn't change the file
+with open(name, "r+b") as f:
+    m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_COPY)
+    m[0:3] = b"abc"
+    print(m[0:8])
+    m.close()
+with open(name, "rb") as f:
+    print(f.read(8))
+
+# errors
+with open(name, "rb") as f:
+    try:
+        mmap.mmap(f.fileno(), 2000, access=mmap.ACCESS_READ, offset=4096)
+    except ValueError:
+        print("ValueError")
+with open(name, "wb") as f:
+    pass
+with open(name, "rb") as f:
+    try:
+        mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    except ValueError:
+        print("ValueError")
+
+os.unlink(name)
@@ -0,0 +1,21 @@
+# test patterns that overflow a backtracking matcher but not the Pike VM
+
+try:
+    import ure as re
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    re.match("(a*)*", "aaa")
+except RuntimeError:
+    # backtracking matcher
+    print("SKIP")
+    raise SystemExit
+
+print(re.match("(a*)*", "aaa").group(0))
+print(re.match("(a*)+b", "a" * 2000 + "b").group(0) == "a" * 2000 + "b")
+print(re.match("(a*)+b", "a" * 2000))
+print(re.match("(a|b)*c", "ab" * 1000 + "c").group(0)[-3:])
+print(re.search("(x+x+)+y", "x" * 30))
+print(re.search("(x+x+)+y", "x" * 30 + "y").group(0) == "x" * 30 + "y")
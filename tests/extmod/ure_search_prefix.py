@@ -0,0 +1,58 @@
+# test searching with regexes that start with literal chars, and repeated use
+# of the module-level functions (which may use cached compiled regexes)
+try:
+    import ure as re
+except ImportError:
+    try:
+        import re
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+def print_groups(match):
+    print('----')
+    try:
+        i = 0
+        while True:
+            print(match.group(i))
+            i += 1
+    except IndexError:
+        pass
+
+lines = [
+    "2018-10-01 12:00:01 INFO temp=21.5 hum=40",
+    "2018-10-01 12:00:02 WARN temp=35.0 hum=41",
+    "no timestamp here temp=",
+    "temp=temp=19.0",
+    "",
+]
+for i in range(3):
+    for l in lines:
+        m = re.search("temp=([0-9]+)\\.([0-9])", l)
+        print(m and (m.group(0), m.group(1), m.group(2)))
+        m = re.match("2018-([0-9]+)-([0-9]+) ", l)
+        print(m and m.group(2))
+        print(re.search("WARN|INFO", l) and re.search("WARN|INFO", l).group(0))
+        print(re.search("hum=4[01]$", l) is not None)
+
+# prefix followed by repetition and alternation
+print_groups(re.search("ab+c", "aaabacabbbcab"))
+print_groups(re.search("ab*c", "aaabacabbbcab"))
+print_groups(re.search("ab(c|d)+", "xxabxabcdcdy"))
+print_groups(re.search("abc", "ababababc"))
+print_groups(re.search("aab", "aaaaaab"))
+print(re.search("abc", "ababab"))
+print(re.search("abcdefghijk", "abcdefghij"))
+
+# leftmost match and submatch priority
+print_groups(re.search("a(b*)(b*)", "xxabbb"))
+print_groups(re.search("a(b*?)(b*)", "xxabbb"))
+print_groups(re.search("(a|ab)(c|bcd)(d*)", "abcd"))
+print_groups(re.match("(a+)+b", "aaab"))
+print_groups(re.match("(a+|b)*", "ab"))
+print_groups(re.search("x*$", "abx"))
+print_groups(re.search("^$", ""))
+
+# many different patterns, more than would be cached
+for i in range(20):
+    print(re.match("k%d=([0-9]+)" % i, "k%d=%d" % (i, i * 7)).group(1))
@@ -11,3 +11,7 @@ try:
     re.match("(a*)*", "aaa")
 except RuntimeError:
     print("RuntimeError")
+else:
+    # the Pike VM (MICROPY_PY_URE_PIKEVM) doesn't recurse, so can't overflow
+    print("SKIP")
+    raise SystemExit
@@ -0,0 +1,78 @@
+# test uselect.poll on many sockets, and its edge-triggered mode
+
+try:
+    import usocket as socket, uselect as select, uerrno as errno
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    select.EPOLLET
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+socks = [socket.socket(socket.AF_INET, socket.SOCK_DGRAM) for i in range(20)]
+
+# only the sockets that receive data need an address
+addrs = {}
+for i in (3, 5, 11):
+    addrs[i] = socket.getaddrinfo('127.0.0.1', 8270 + len(addrs))[0][-1]
+    try:
+        socks[i].bind(addrs[i])
+    except OSError as er:
+        # another test run may hold the port
+        if er.args[0] != errno.EADDRINUSE:
+            raise
+        print("SKIP")
+        raise SystemExit
+
+poller = select.poll()
+for s in socks:
+    print(poller.register(s, select.POLLIN), end=' ')
+print()
+# registering again updates the eventmask
+print(poller.register(socks[0], select.POLLIN))
+
+# nothing ready
+print(poller.poll(0))
+print(list(poller.ipoll(0)))
+
+# only the ready sockets are returned
+tx.sendto(b'a', addrs[3])
+tx.sendto(b'b', addrs[11])
+res = poller.poll(100)
+print(sorted(socks.index(s) for s, ev in res), [ev for s, ev in res])
+print(sorted(socks.index(s) for s, ev in poller.ipoll(0)))
+
+# one-shot mode clears the eventmask of ready sockets
+print(len(list(poller.ipoll(0, 1))))
+print(poller.poll(0))
+poller.modify(socks[3], select.POLLIN)
+print([(socks.index(s), ev) for s, ev in poller.ipoll(0)])
+
+# unregister
+poller.unregister(socks[3])
+poller.modify(socks[11], select.POLLIN)
+print([(socks.index(s), ev) for s, ev in poller.poll(0)])
+socks[3].recv(1)
+socks[11].recv(1)
+print(poller.poll(0))
+
+# edge-triggered: reported once per arrival of data
+poller.modify(socks[5], select.POLLIN | select.EPOLLET)
+tx.sendto(b'c', addrs[5])
+print([(socks.index(s), ev) for s, ev in poller.poll(100)])
+print(poller.poll(0))
+tx.sendto(b'd', addrs[5])
+print([(socks.index(s), ev) for s, ev in poller.poll(100)])
+
+# a plain fd can be registered
+poller = select.poll()
+poller.register(tx.fileno(), select.POLLOUT)
+print([(fd == tx.fileno(), ev) for fd, ev in poller.poll(0)])
+
+for s in socks:
+    s.close()
+tx.close()
@@ -0,0 +1,88 @@
+# test socket methods that receive into and send from existing buffers
+
+try:
+    import usocket as socket, uerrno as errno
+except ImportError:
+    try:
+        import socket, errno
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+try:
+    socket.socket.recv_into
+    socket.socket.sendmsg
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+def bind(s, addr):
+    # another test run may hold the port
+    try:
+        s.bind(addr)
+    except OSError as er:
+        if er.args[0] != errno.EADDRINUSE:
+            raise
+        print("SKIP")
+        raise SystemExit
+
+
+# datagrams over loopback
+addr = socket.getaddrinfo('127.0.0.1', 8267)[0][-1]
+rx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+bind(rx, addr)
+tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+buf = bytearray(8)
+tx.sendto(b'abc', addr)
+print(rx.recv_into(buf), buf)
+tx.sendto(b'defghi', addr)
+print(rx.recv_into(memoryview(buf)[4:], 2), buf)
+tx.sendto(b'jk', addr)
+n, a = rx.recvfrom_into(buf)
+print(n, buf)
+
+# nbytes bigger than the buffer
+try:
+    rx.recv_into(bytearray(2), 3)
+except ValueError:
+    print('ValueError')
+
+# scatter/gather
+print(tx.sendmsg([b'12', memoryview(b'xx345')[2:], bytearray(b'6')], [], 0, addr))
+b1 = bytearray(4)
+b2 = bytearray(4)
+n, anc, flags, a = rx.recvmsg_into([b1, memoryview(b2)[1:]])
+print(n, anc, b1, b2)
+
+rx.close()
+tx.close()
+
+# a stream connection
+addr = socket.getaddrinfo('127.0.0.1', 8268)[0][-1]
+server = socket.socket()
+server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+bind(server, addr)
+server.listen(1)
+client = socket.socket()
+client.connect(addr)
+conn = server.accept()[0]
+
+data = bytes(range(256)) * 16
+print(client.sendall(memoryview(data)[100:]))
+buf = bytearray(len(data))
+mv = memoryview(buf)
+n = 0
+while n < len(data) - 100:
+    n += conn.recv_into(mv[n:])
+print(n, buf[:n] == data[100:])
+
+print(conn.sendmsg([b'hello ', b'world']))
+b1 = bytearray(6)
+b2 = bytearray(5)
+print(client.recvmsg_into([b1, b2])[0], b1, b2)
+
+conn.close()
+client.close()
+server.close()
@@ -0,0 +1,54 @@
+try:
+    import uzlib as zlib
+    import uio as io
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    zlib.compress
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+PATTERNS = [
+    b"",
+    b"0",
+    b"a" * 300,
+    bytes(range(256)),
+    b"".join(b"%d,temp=%d,hum=%d\n" % (i, 20 + i % 7, 40 + i % 13) for i in range(200)),
+]
+
+# zlib, gzip and raw deflate streams with various window sizes
+for data in PATTERNS:
+    for wbits in (0, 9, 15, 25, -10):
+        comp = zlib.compress(data, wbits)
+        if wbits >= 16:
+            out = zlib.DecompIO(io.BytesIO(comp), wbits).read()
+        else:
+            out = zlib.decompress(comp, wbits)
+        print(len(data), wbits, out == data, len(comp) <= len(data) * 9 // 8 + 24)
+
+# repetitive data must actually get smaller
+print(len(zlib.compress(PATTERNS[2])) < 20, len(zlib.compress(PATTERNS[4])) < len(PATTERNS[4]) // 2)
+
+# streaming compression in small pieces, with flushes along the way
+data = PATTERNS[4]
+buf = io.BytesIO()
+with zlib.CompIO(buf, 10) as c:
+    for i in range(0, len(data), 50):
+        c.write(data[i:i + 50])
+        if i % 1000 == 0:
+            c.flush()
+print(zlib.decompress(buf.getvalue()) == data)
+
+# writing after close is an error
+try:
+    c.write(b"x")
+except OSError:
+    print("OSError")
+
+try:
+    zlib.compress(b"x", 20)
+except ValueError:
+    print("ValueError")
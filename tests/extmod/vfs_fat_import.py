@@ -0,0 +1,99 @@
+# Test importing from a FAT filesystem, whose stat queries import may answer
+# from cached directory listings
+
+try:
+    import uos
+    import sys
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        buf[:] = self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(100)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, '/ramdisk')
+sys.path.insert(0, '/ramdisk')
+
+
+def write(name, data):
+    with open('/ramdisk/' + name, 'w') as f:
+        f.write(data)
+
+
+def try_import(name):
+    try:
+        __import__(name)
+        print(name, 'imported')
+    except ImportError:
+        print(name, 'ImportError')
+
+
+uos.mkdir('/ramdisk/pkg')
+uos.mkdir('/ramdisk/sub')
+write('mod1.py', 'print("mod1")')
+write('pkg/__init__.py', 'print("pkg")')
+write('pkg/mod2.py', 'print("pkg.mod2")')
+write('sub/mod3.py', 'print("mod3")')
+for i in range(80):
+    write('sub/filler%d.txt' % i, '')
+
+# the listings have more than 3 items per entry
+print(len(next(vfs.ilistdir('/'))))
+
+try_import('mod1')
+try_import('pkg.mod2')
+try_import('pkg.missing')
+try_import('missing')
+try_import('missing')
+
+# a directory with too many entries to cache on sys.path
+sys.path.insert(0, '/ramdisk/sub')
+try_import('mod3')
+try_import('missing')
+sys.path.pop(0)
+
+# FAT matches names regardless of case
+write('Mixed.py', 'print("Mixed")')
+try_import('mixed')
+
+# a module created after a failed import is found
+try_import('late')
+write('late.py', 'print("late")')
+try_import('late')
+
+sys.path.pop(0)
+uos.umount('/ramdisk')
@@ -0,0 +1,105 @@
+# Test memory-mapping files on a FAT filesystem whose block device is in memory
+
+try:
+    import uerrno
+    import uos
+    import ummap
+    import uctypes
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+        self.mapped = True
+
+    def readblocks(self, n, buf):
+        buf[:] = self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+        if op == 6 and self.mapped:  # BP_IOCTL_MMAP_ADDR
+            return uctypes.addressof(self.data)
+
+
+try:
+    bdev = RAMFS(200)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, '/ramdisk')
+uos.chdir('/ramdisk')
+
+def chunk(name, i):
+    return bytes((ord(name) + i + j) & 0xff for j in range(512))
+
+# a is in one piece, b and c are interleaved
+with open('a', 'wb') as f:
+    for i in range(4):
+        f.write(chunk('a', i))
+for i in range(3):
+    for name in 'bc':
+        with open(name, 'ab') as f:
+            f.write(chunk(name, i))
+
+with open('a', 'rb') as f:
+    f.seek(100)
+    m = ummap.mmap(f, 0, access=ummap.ACCESS_READ)
+    print(len(m), bytes(m) == b''.join(chunk('a', i) for i in range(4)))
+    # mapping doesn't move the file position
+    print(f.tell())
+    m = ummap.mmap(f, 600, access=ummap.ACCESS_READ, offset=1000)
+    print(len(m), m[:] == (chunk('a', 1) + chunk('a', 2) + chunk('a', 3))[488:1088])
+    print(memoryview(m)[0], chunk('a', 1)[488])
+
+with open('b', 'rb') as f:
+    # within one cluster
+    m = ummap.mmap(f, 100, access=ummap.ACCESS_READ, offset=520)
+    print(m[:] == chunk('b', 1)[8:108])
+    # across clusters that aren't next to each other
+    try:
+        ummap.mmap(f, 0, access=ummap.ACCESS_READ)
+    except OSError as e:
+        print(e.args[0] == uerrno.ENODEV)
+    # a writable mapping
+    try:
+        ummap.mmap(f, 0)
+    except OSError as e:
+        print(e.args[0] == uerrno.EACCES)
+    # past the end of the file
+    try:
+        ummap.mmap(f, 10, access=ummap.ACCESS_READ, offset=2000)
+    except ValueError:
+        print('ValueError')
+
+# a block device that isn't in memory
+bdev.mapped = False
+with open('a', 'rb') as f:
+    try:
+        ummap.mmap(f, 0, access=ummap.ACCESS_READ)
+    except OSError as e:
+        print(e.args[0] == uerrno.ENODEV)
+
+uos.umount('/ramdisk')
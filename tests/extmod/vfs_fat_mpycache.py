@@ -0,0 +1,142 @@
+# Test caching of compiled modules in __pycache__ on a FAT filesystem
+
+try:
+    import uos
+    import sys
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        buf[:] = self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(100)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, '/ramdisk')
+sys.path.insert(0, '/ramdisk')
+
+
+def write(name, data):
+    with open('/ramdisk/' + name, 'w') as f:
+        f.write(data)
+
+
+def read(name):
+    with open('/ramdisk/' + name, 'rb') as f:
+        return f.read()
+
+
+def imp(name):
+    sys.modules.pop(name, None)
+    return __import__(name)
+
+
+write('mod.py', 'x = 22\n')
+mod = imp('mod')
+if '__pycache__' not in uos.listdir('/ramdisk'):
+    sys.path.pop(0)
+    uos.umount('/ramdisk')
+    print("SKIP")
+    raise SystemExit
+
+# first import compiles the module and writes the cache
+print(mod.x, mod.__file__)
+print(uos.listdir('/ramdisk/__pycache__'))
+cached = read('__pycache__/mod.mpy')
+print(cached[16:17])
+
+# a second import loads the same cache
+print(imp('mod').x)
+print(read('__pycache__/mod.mpy') == cached)
+
+# the cache is used while the source's key matches, even if the code differs
+write('other.py', 'x = 44\n')
+imp('other')
+with open('/ramdisk/__pycache__/mod.mpy', 'wb') as f:
+    f.write(cached[:8] + read('__pycache__/other.mpy')[8:])
+print(imp('mod').x)
+
+# a change to the source recompiles the module
+write('mod.py', 'x = 333\n')
+print(imp('mod').x)
+print(read('__pycache__/mod.mpy') != cached)
+
+# even one that keeps its size, and is made within FAT's 2 second mtime
+# resolution
+write('mod.py', 'x = 334\n')
+print(imp('mod').x)
+write('mod.py', 'x = 333\n')
+print(imp('mod').x)
+
+# a module of several statements loads all of them from the cache
+write('multi.py', 'a = 1\ndef f():\n    return a + 1\nb = f()\n')
+print(imp('multi').b)
+print(imp('multi').b, imp('multi').f())
+
+# a cache with a matching key but bad data is replaced
+cached = read('__pycache__/mod.mpy')
+with open('/ramdisk/__pycache__/mod.mpy', 'wb') as f:
+    f.write(cached[:8] + b'\x03\x00\x00\x00\x01\x00\x00\x00XYZ')
+print(imp('mod').x)
+print(read('__pycache__/mod.mpy') == cached)
+
+# so is one that is shorter than its header says
+with open('/ramdisk/__pycache__/mod.mpy', 'wb') as f:
+    f.write(cached[:-4])
+print(imp('mod').x)
+print(read('__pycache__/mod.mpy') == cached)
+
+# and one whose data ends early, whatever the header says
+for n in (17, 18, len(cached) // 2, len(cached) - 1):
+    with open('/ramdisk/__pycache__/mod.mpy', 'wb') as f:
+        f.write(cached[:8] + bytes((n - 16, 0, 0, 0)) + cached[12:n])
+    print(imp('mod').x, read('__pycache__/mod.mpy') == cached)
+print(uos.listdir('/ramdisk/__pycache__'))
+
+# packages are cached in their own directory
+uos.mkdir('/ramdisk/pkg')
+write('pkg/__init__.py', 'y = 5\n')
+print(imp('pkg').y)
+print(uos.listdir('/ramdisk/pkg/__pycache__'))
+
+# a read-only filesystem still imports but doesn't update the cache
+write('mod.py', 'x = 4444\n')
+uos.umount('/ramdisk')
+uos.mount(vfs, '/ramdisk', readonly=True)
+print(imp('mod').x)
+print(read('__pycache__/mod.mpy') == cached)
+
+sys.path.pop(0)
+uos.umount('/ramdisk')
@@ -0,0 +1,100 @@
+# Test the FAT sector cache on a block device that is called natively
+
+try:
+    native_ramdisk
+    import uos
+    import ummap
+    import uctypes
+except (NameError, ImportError):
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        buf[:] = self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+        if op == 6:  # BP_IOCTL_MMAP_ADDR
+            return uctypes.addressof(self.data)
+
+
+try:
+    bdev = RAMFS(200)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+native_ramdisk(vfs, bdev.data)
+uos.mount(vfs, '/ramdisk')
+uos.chdir('/ramdisk')
+
+def blocks_read():
+    return native_ramdisk()[0]
+
+with open('a', 'wb') as f:
+    f.write(b'a' * 100)
+with open('b', 'wb') as f:
+    f.write(bytes(range(256)) * 8)
+print(native_ramdisk()[1] > 0)
+
+# the directory and the small file stay in the cache
+with open('a') as f:
+    print(f.read() == 'a' * 100)
+n = blocks_read()
+for i in range(3):
+    print(sorted(uos.listdir()))
+    with open('a') as f:
+        print(f.read(4))
+print(blocks_read() - n)
+
+# multi-block reads go straight to the caller
+n = blocks_read()
+with open('b', 'rb') as f:
+    print(f.read() == bytes(range(256)) * 8)
+print(blocks_read() - n > 0)
+
+# writes update the cached copies
+with open('a', 'r+b') as f:
+    f.write(b'xyz')
+with open('a') as f:
+    print(f.read(6))
+
+# the mapped device holds the data written, including the open file's
+with open('a', 'r+b') as f:
+    f.seek(3)
+    f.write(b'123')
+    m = ummap.mmap(f, 8, access=ummap.ACCESS_READ)
+    print(bytes(m))
+    f.seek(0)
+    print(f.read(8))
+
+# change the file behind the cache's back; mounting the device again drops
+# what was cached for it
+uos.umount('/ramdisk')
+i = bytes(bdev.data).find(b'xyz123')
+bdev.data[i:i + 6] = b'XYZ123'
+vfs = uos.VfsFat(bdev)
+native_ramdisk(vfs, bdev.data)
+uos.mount(vfs, '/ramdisk')
+with open('/ramdisk/a') as f:
+    print(f.read(6))
+
+uos.umount('/ramdisk')
@@ -0,0 +1,84 @@
+# Test seeking and reading in fragmented files on a FAT filesystem
+
+try:
+    import uos
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    uos.VfsFat
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+
+    def readblocks(self, n, buf):
+        buf[:] = self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)]
+        return 0
+
+    def writeblocks(self, n, buf):
+        self.data[n * self.SEC_SIZE:n * self.SEC_SIZE + len(buf)] = buf
+        return 0
+
+    def ioctl(self, op, arg):
+        if op == 4:  # BP_IOCTL_SEC_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # BP_IOCTL_SEC_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(200)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+vfs = uos.VfsFat(bdev)
+uos.mount(vfs, '/ramdisk')
+uos.chdir('/ramdisk')
+
+def chunk(name, i):
+    return bytes((ord(name) + i + j) & 0xff for j in range(512))
+
+# Grow the files a chunk at a time in turn, so that each cluster of one is
+# followed by a cluster of another.  c and d have more fragments than a link
+# map is made for.
+sizes = {'a': 3, 'b': 6, 'c': 60, 'd': 60}
+for i in range(60):
+    for name in sorted(sizes):
+        if i < sizes[name]:
+            with open(name, 'ab') as f:
+                f.write(chunk(name, i))
+
+for name in sorted(sizes):
+    with open(name, 'rb') as f:
+        print(name, f.seek(0, 2))
+        ok = True
+        for i in (sizes[name] - 1, 0, sizes[name] // 2, 1, sizes[name] - 1):
+            f.seek(i * 512 + 100)
+            ok = ok and f.read(16) == chunk(name, i)[100:116]
+            ok = ok and f.tell() == i * 512 + 116
+        # a read that crosses clusters
+        f.seek(400)
+        ok = ok and f.read(512) == chunk(name, 0)[400:] + chunk(name, 1)[:400]
+        f.seek(-10, 2)
+        ok = ok and f.read() == chunk(name, sizes[name] - 1)[-10:]
+        print(ok)
+
+# seeking in a file that is being written
+with open('b', 'r+b') as f:
+    f.seek(512 * 4 + 8)
+    f.write(b'xyz')
+    f.seek(512 * 4 + 7)
+    print(f.read(5))
+
+uos.umount('/ramdisk')
@@ -0,0 +1,8 @@
+# test importing a module with many kinds of top-level statements
+
+import import4b as m
+
+print(m.X, m.Y, m.Z, m.W, m.L)
+print(m.f(1), m.C.z, m.C().m())
+print(next(m.gen()), m.X)
+print(hasattr(m, "i"), hasattr(m, "sys"))
@@ -0,0 +1,51 @@
+# module with a mix of top-level statements, imported by import4a.py
+
+"""module docstring"""
+
+import sys
+
+X = 1
+Y = X + 1
+
+
+def f(a):
+    return a + X + Y
+
+
+class C:
+    z = f(1)
+
+    def m(self):
+        return self.z + g()
+
+
+def g():
+    return Y
+
+
+if X:
+    Z = "if"
+else:
+    Z = "else"
+
+try:
+    W = 1 // 0
+except ZeroDivisionError:
+    W = "except"
+
+for i in range(3):
+    X += i
+
+L = [x * Y for x in range(3)]
+
+
+def gen():
+    global X
+    X += 100
+    yield X
+
+
+while Y < 5:
+    Y += 1
+
+del i
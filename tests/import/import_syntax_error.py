@@ -0,0 +1,69 @@
+# test that a module with a syntax error doesn't run any of its statements
+
+import sys, uio
+
+try:
+    uio.IOBase
+    import uos
+    uos.mount
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class UserFile(uio.IOBase):
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+    def read(self):
+        return self.data
+    def readinto(self, buf):
+        n = 0
+        while n < len(buf) and self.pos < len(self.data):
+            buf[n] = self.data[self.pos]
+            n += 1
+            self.pos += 1
+        return n
+    def ioctl(self, req, arg):
+        return 0
+
+
+class UserFS:
+    def __init__(self, files):
+        self.files = files
+    def mount(self, readonly, mksfs):
+        pass
+    def umount(self):
+        pass
+    def stat(self, path):
+        if path in self.files:
+            return (32768, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+        raise OSError
+    def open(self, path, mode):
+        return UserFile(self.files[path])
+
+
+user_files = {
+    # error from the parser
+    '/mod0.py': b"print('mod0')\nx = (\n",
+    # error from the compiler
+    '/mod1.py': b"print('mod1')\ndef f():\n    pass\nreturn 1\n",
+    # bad indentation
+    '/mod2.py': b"print('mod2')\nx = 1\n  y = 2\n",
+    # error at run time, after the first statement has run
+    '/mod3.py': b"print('mod3')\n1 // 0\nprint('not reached')\n",
+}
+uos.mount(UserFS(user_files), '/userfs')
+sys.path.append('/userfs')
+
+for i in range(len(user_files)):
+    mod = 'mod%u' % i
+    try:
+        __import__(mod)
+    except SyntaxError as er:
+        print(mod, type(er).__name__)
+    except ZeroDivisionError:
+        print(mod, 'ZeroDivisionError')
+
+uos.umount('/userfs')
+sys.path.pop()
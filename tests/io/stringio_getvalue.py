@@ -0,0 +1,36 @@
+# test that values returned by getvalue() are unaffected by later writes
+try:
+    import uio as io
+except ImportError:
+    import io
+
+for cls, piece in ((io.StringIO, "ab"), (io.BytesIO, b"ab")):
+    a = cls()
+    for i in range(20):
+        a.write(piece)
+    v1 = a.getvalue()
+    v2 = a.getvalue()
+    a.write(piece * 3)
+    v3 = a.getvalue()
+    a.seek(0)
+    a.write(piece[:1] * 5)
+    v4 = a.getvalue()
+    print(v1, v2, v3, v4)
+    print(v1 == v2, len(v1), len(v3), len(v4))
+    a.seek(4)
+    print(a.read(6))
+    a.close()
+    print(v3)
+
+# initialised from a str, then read back unchanged and modified
+a = io.StringIO("hello")
+print(a.getvalue(), a.read())
+a.write("!")
+print(a.getvalue())
+
+# short values that may already exist as interned strings
+a = io.StringIO()
+a.write("print")
+v = a.getvalue()
+a.write("ed")
+print(v, a.getvalue())
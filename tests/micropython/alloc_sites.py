@@ -0,0 +1,29 @@
+# test the allocation site statistics from micropython.alloc_sites()
+import micropython
+
+try:
+    micropython.alloc_sites
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+def alloc():
+    for i in range(20):
+        bytearray(1000)
+
+def alloc_locked():
+    micropython.heap_lock()
+    try:
+        bytearray(1000)
+    except MemoryError:
+        pass
+    micropython.heap_unlock()
+
+# the first table has the allocations made at startup
+micropython.alloc_sites(True)
+print('--')
+alloc()
+alloc_locked()
+micropython.alloc_sites(True)
+print('--')
+micropython.alloc_sites()
@@ -0,0 +1,50 @@
+# test the micropython.profile_*() functions
+
+import micropython
+
+try:
+    micropython.profile_start
+except AttributeError:
+    print('SKIP')
+    raise SystemExit
+
+MP_BC_FOR_ITER = 0x43
+
+def f(n):
+    x = 0
+    r = range(n)
+    for i in r:
+        x += i
+    return x
+
+# nothing recorded before the first start
+print(micropython.profile_opcodes(), micropython.profile_samples())
+
+micropython.profile_start(16)
+f(10000)
+print(micropython.profile_stop())
+
+# opcode counts are exact
+ops = micropython.profile_opcodes()
+print(ops[MP_BC_FOR_ITER])
+
+# nothing is counted once stopped
+f(10)
+print(micropython.profile_opcodes()[MP_BC_FOR_ITER])
+
+# the loop in f should get most of the samples
+samples = micropython.profile_samples()
+total = sum(s[3] for s in samples)
+in_f = sum(s[3] for s in samples if s[1] == 'f' and 16 <= s[2] <= 17)
+print(total > 0, in_f * 2 > total)
+
+# samples that don't fit are dropped
+micropython.profile_start(1)
+f(10000)
+micropython.profile_stop()
+print(len(micropython.profile_samples()))
+
+try:
+    micropython.profile_start(0)
+except ValueError:
+    print('ValueError')
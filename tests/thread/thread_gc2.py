@@ -0,0 +1,38 @@
+# test that small objects allocated by several threads at once stay intact
+# while other threads allocate and collect
+
+import gc
+import _thread
+
+def thread_entry(n, tag):
+    # keep a list of small objects alive, replacing some of them as we go
+    keep = [(tag, i, [i] * 3) for i in range(n)]
+    for i in range(n * 20):
+        j = i % n
+        keep[j] = (tag, j, [j] * 3)
+        t = (i, i + 1)  # temporary that becomes garbage
+        if i % 97 == 0:
+            gc.collect()
+
+    # check that none of the objects was handed out twice or swept
+    ok = True
+    for j, (t, k, l) in enumerate(keep):
+        if t != tag or k != j or l != [j] * 3:
+            ok = False
+
+    with lock:
+        print(ok)
+        global n_finished
+        n_finished += 1
+
+lock = _thread.allocate_lock()
+n_thread = 4
+n_finished = 0
+
+# spawn threads
+for i in range(n_thread):
+    _thread.start_new_thread(thread_entry, (200, 'thread%d' % i))
+
+# busy wait for threads to finish
+while n_finished < n_thread:
+    pass
@@ -0,0 +1,69 @@
+# cmdline: -X heapsize=20M
+# test that a collection of a heap big enough to be marked in parallel keeps
+# everything that is reachable, while other threads allocate and collect
+
+import gc
+import _thread
+
+def make_tree(depth):
+    if depth == 0:
+        return [depth]
+    return [depth, make_tree(depth - 1), make_tree(depth - 1)]
+
+def check_tree(t, depth):
+    if t[0] != depth:
+        return False
+    if depth == 0:
+        return len(t) == 1
+    return check_tree(t[1], depth - 1) and check_tree(t[2], depth - 1)
+
+def make_chain(n):
+    head = None
+    for i in range(n):
+        head = (i, head)
+    return head
+
+def check_chain(head, n):
+    while head is not None:
+        n -= 1
+        if head[0] != n:
+            return False
+        head = head[1]
+    return n == 0
+
+def thread_entry(tag):
+    tree = make_tree(12)
+    chain = make_chain(20000)
+    ok = True
+    for i in range(5):
+        # garbage to be swept
+        make_tree(10)
+        gc.collect()
+        ok = ok and check_tree(tree, 12) and check_chain(chain, 20000)
+    with lock:
+        results.append(ok)
+        global n_finished
+        n_finished += 1
+
+# the heap must be at least MICROPY_GC_PARALLEL_MARK_MIN_BYTES
+try:
+    bytearray(16 * 1024 * 1024)
+except MemoryError:
+    print('SKIP')
+    raise SystemExit
+gc.collect()
+
+lock = _thread.allocate_lock()
+results = []
+n_thread = 2
+n_finished = 0
+
+for i in range(n_thread):
+    _thread.start_new_thread(thread_entry, (i,))
+thread_entry(n_thread)
+
+# busy wait for threads to finish
+while n_finished < n_thread + 1:
+    pass
+gc.collect()
+print(results)
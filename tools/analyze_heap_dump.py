@@ -524,6 +524,31 @@ def do_all_the_things(ram_filename, bin_filename, map_filename, print_block_cont
         print("Total free space:", BYTES_PER_BLOCK * total_free)
         print("Longest free space:", BYTES_PER_BLOCK * longest_free)
 
+        # Builds with MICROPY_GC_ALLOC_SITES keep allocation statistics per
+        # Python line or C caller.
+        if "gc_alloc_sites" in symbols:
+            def find_code_symbol(address):
+                address &= ~1 # Thumb bit
+                for offset in range(0, 4096, 2):
+                    if address - offset in symbol_lookup:
+                        name, symbol_offset = symbol_lookup[address - offset].rsplit("+", 1)
+                        return "{}+{}".format(name, int(symbol_offset) + offset)
+                return "0x{:08x}".format(address)
+
+            sites_start, sites_size = symbols["gc_alloc_sites"]
+            sites = load(sites_start, sites_size)
+            sites_len, other_count, other_bytes = struct.unpack_from("<III", sites)
+            print("Allocation sites:")
+            print("   bytes    count failed site")
+            for i in range(sites_len):
+                source_file, block_name, line, count, nbytes, failed = struct.unpack_from("<IIIIII", sites, offset=12 + i * 24)
+                if source_file == 0:
+                    site = "C " + find_code_symbol(line)
+                else:
+                    site = "{}:{} {}".format(find_qstr(source_file << 3 | 6), line, find_qstr(block_name << 3 | 6))
+                print("{:8} {:8} {:6} {}".format(nbytes, count, failed, site))
+            print("{:8} {:8}        other".format(other_bytes, other_count))
+
         # First render the graph of objects on the heap.
         if draw_heap_ownership:
             ownership_graph.layout(prog="dot")
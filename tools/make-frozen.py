@@ -36,6 +36,9 @@ for dirpath, dirnames, filenames in os.walk(root):
         st = os.stat(fullpath)
         modules.append((fullpath[root_len + 1:], st))
 
+# The names are sorted so that they can be binary searched at runtime
+modules.sort(key=lambda m: module_name(m[0]).encode("utf8"))
+
 print("#include <stdint.h>")
 print("const char mp_frozen_str_names[] = {")
 for f, st in modules:
@@ -43,6 +46,16 @@ for f, st in modules:
     print('"%s\\0"' % m)
 print('"\\0"};')
 
+print("const uint16_t mp_frozen_str_count = %d;" % len(modules))
+
+print("const uint16_t mp_frozen_str_index[] = {")
+offset = 0
+for f, st in modules:
+    print("%d," % offset)
+    offset += len(module_name(f).encode("utf8")) + 1
+print("};")
+assert offset < 0x10000, "frozen module names too long"
+
 print("const uint32_t mp_frozen_str_sizes[] = {")
 
 for f, st in modules:
@@ -50,6 +63,13 @@ for f, st in modules:
 
 print("};")
 
+print("const uint32_t mp_frozen_str_offsets[] = {")
+offset = 0
+for f, st in modules:
+    print("%d," % offset)
+    offset += st.st_size + 1
+print("};")
+
 print("const char mp_frozen_str_content[] = {")
 for f, st in modules:
     data = open(sys.argv[1] + "/" + f, "rb").read()
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+#
+# This file is part of the MicroPython project, http://micropython.org/
+#
+# The MIT License (MIT)
+#
+# Copyright (c) 2016 Damien P. George
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+"""Render the results of micropython.profile_*() as a flat profile.
+
+On a board built with MICROPY_PY_MICROPYTHON_PROFILE (for atmel-samd,
+build with `make BOARD=... PROFILE=1`), run:
+
+    import micropython
+    micropython.profile_start(128)
+    ... code to profile ...
+    print('mpprof', micropython.profile_stop())
+    print('mpprof', micropython.profile_opcodes())
+    print('mpprof', micropython.profile_samples())
+
+and pass the captured output to this script:
+
+    python3 tools/mpprof.py capture.txt
+
+A script can also be profiled directly with a unix build that has the
+profiler enabled (eg the coverage build):
+
+    python3 tools/mpprof.py --run script.py --micropython ports/unix/micropython_coverage
+"""
+
+from __future__ import print_function
+
+import argparse
+import ast
+import os
+import re
+import subprocess
+import sys
+
+BC0_H = os.path.join(os.path.dirname(__file__), '../py/bc0.h')
+
+RUN_WRAPPER = """\
+import sys, micropython
+sys.path[0] = {dir!r}
+micropython.profile_start({samples})
+try:
+    __import__({mod!r})
+finally:
+    print('mpprof', micropython.profile_stop())
+    print('mpprof', micropython.profile_opcodes())
+    print('mpprof', micropython.profile_samples())
+"""
+
+def load_opcode_names(filename):
+    names = {}
+    multi = []
+    with open(filename) as f:
+        for line in f:
+            m = re.match(r'#define MP_BC_(\w+) +\((0x[0-9a-f]+)\)', line)
+            if m is None:
+                continue
+            name, op = m.group(1), int(m.group(2), 16)
+            if name.endswith('_MULTI'):
+                multi.append((op, name[:-len('_MULTI')]))
+            else:
+                names[op] = name
+    # The *_MULTI opcodes encode their argument in the opcode itself and run
+    # up to the next defined opcode.  Small ints start at -16.
+    multi.sort()
+    for i, (op, name) in enumerate(multi):
+        end = multi[i + 1][0] if i + 1 < len(multi) else 256
+        base = -16 if name == 'LOAD_CONST_SMALL_INT' else 0
+        for n in range(op, end):
+            if n not in names:
+                names[n] = '%s_%d' % (name, base + n - op)
+    return names
+
+def parse_capture(lines):
+    values = []
+    for line in lines:
+        if line.startswith('mpprof '):
+            values.append(ast.literal_eval(line[len('mpprof '):].strip()))
+    if len(values) != 3:
+        raise ValueError('expected 3 "mpprof" lines in capture, got %d' % len(values))
+    return values
+
+def print_profile(dropped, opcodes, samples, opcode_names, limit):
+    total = sum(s[3] for s in samples)
+    print('%d samples (%d dropped)' % (total, dropped))
+    if total:
+        # Per function.
+        funcs = {}
+        for source_file, block_name, line, count in samples:
+            key = (source_file, block_name)
+            funcs[key] = funcs.get(key, 0) + count
+        print()
+        print('    %  samples  function')
+        for (source_file, block_name), count in sorted(funcs.items(), key=lambda x: -x[1])[:limit]:
+            print('%5.1f %8d  %s (%s)' % (100.0 * count / total, count, block_name, source_file))
+
+        # Per line.
+        print()
+        print('    %  samples  line')
+        for source_file, block_name, line, count in sorted(samples, key=lambda s: -s[3])[:limit]:
+            print('%5.1f %8d  %s:%d in %s' % (100.0 * count / total, count, source_file, line, block_name))
+
+    total = sum(opcodes.values())
+    print()
+    print('%d opcodes executed' % total)
+    if total:
+        print()
+        print('    %     count  opcode')
+        for op, count in sorted(opcodes.items(), key=lambda x: -x[1])[:limit]:
+            name = opcode_names.get(op, 'UNKNOWN')
+            print('%5.1f %9d  0x%02x %s' % (100.0 * count / total, count, op, name))
+
+def main():
+    cmd_parser = argparse.ArgumentParser(description='Render a MicroPython bytecode profile.')
+    cmd_parser.add_argument('capture', nargs='?', help='file with the output of the profiled code')
+    cmd_parser.add_argument('--run', metavar='SCRIPT', help='profile SCRIPT with a unix micropython')
+    cmd_parser.add_argument('--micropython', default='micropython', help='unix micropython executable to use with --run')
+    cmd_parser.add_argument('--samples', type=int, default=256, help='size of the sample table used with --run')
+    cmd_parser.add_argument('--limit', type=int, default=20, help='number of entries to show in each table')
+    cmd_parser.add_argument('--bc0', default=BC0_H, help='path to py/bc0.h for opcode names')
+    args = cmd_parser.parse_args()
+
+    if args.run:
+        script = os.path.abspath(args.run)
+        wrapper = RUN_WRAPPER.format(dir=os.path.dirname(script),
+            mod=os.path.splitext(os.path.basename(script))[0], samples=args.samples)
+        output = subprocess.check_output([args.micropython, '-c', wrapper])
+        lines = output.decode('utf-8', 'replace').splitlines()
+        for line in lines:
+            if not line.startswith('mpprof '):
+                print(line)
+    elif args.capture:
+        with open(args.capture) as f:
+            lines = f.read().splitlines()
+    else:
+        cmd_parser.error('need a capture file or --run')
+
+    try:
+        dropped, opcodes, samples = parse_capture(lines)
+    except ValueError as er:
+        print('error:', er)
+        sys.exit(1)
+    print_profile(dropped, opcodes, samples, load_opcode_names(args.bc0), args.limit)
+
+if __name__ == '__main__':
+    main()
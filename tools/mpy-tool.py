@@ -576,6 +576,9 @@ def freeze_mpy(base_qstrs, raw_codes):
     for rc in raw_codes:
         sizes[rc.source_file.str] = rc.freeze(rc.source_file.str.replace('/', '_')[:-3] + '_')
 
+    # the names are sorted so that they can be binary searched at runtime
+    raw_codes = sorted(raw_codes, key=lambda rc: bytes_cons(rc.source_file.str, 'utf8'))
+
     print()
     print('const char mp_frozen_mpy_names[] = {')
     qstr_size["filenames"] = 1
@@ -585,6 +588,17 @@ def freeze_mpy(base_qstrs, raw_codes):
         qstr_size["filenames"] += len(module_name) + 1
     print('"\\0"};')
 
+    print('const uint16_t mp_frozen_mpy_count = %u;' % len(raw_codes))
+    print('const uint16_t mp_frozen_mpy_index[] = {')
+    offset = 0
+    for rc in raw_codes:
+        print('    %u,' % offset)
+        offset += len(bytes_cons(rc.source_file.str, 'utf8')) + 1
+    print('};')
+    if offset >= 0x10000:
+        raise FreezeError(raw_codes[-1], 'frozen module names too long')
+    qstr_size["filenames"] += 2 * (len(raw_codes) + 1)
+
     print('const mp_raw_code_t *const mp_frozen_mpy_content[] = {')
     for rc in raw_codes:
         print('    &raw_code_%s,' % rc.escaped_name)